@@ -95,25 +95,41 @@
 
 #define ATF_PASS() atf::tests::tc::pass()
 
+namespace atf {
+namespace tests {
+namespace detail {
+
+template< class Expected, class Actual >
+void fail_eq(const int, const char*, const char*, const Expected&,
+             const Actual&)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+
+template< class Expected, class Actual >
+void
+fail_eq(const int line, const char* expected_expr, const char* actual_expr,
+        const Expected& expected, const Actual& actual)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": " << expected_expr << " != " << actual_expr
+       << " (" << expected << " != " << actual << ")";
+    atf::tests::tc::fail(ss.str());
+}
+
+} // namespace detail
+} // namespace tests
+} // namespace atf
+
 #define ATF_REQUIRE(expression) \
     do { \
-        if (!(expression)) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " << #expression \
-                    << " not met"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
-        } \
+        if (ATF_DEFS_UNLIKELY(!(expression))) \
+            atf::tests::detail::fail_require(__LINE__, #expression); \
     } while (false)
 
 #define ATF_REQUIRE_EQ(expected, actual) \
     do { \
-        if ((expected) != (actual)) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " \
-                    << #expected << " != " << #actual \
-                    << " (" << (expected) << " != " << (actual) << ")"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
-        } \
+        if (ATF_DEFS_UNLIKELY((expected) != (actual))) \
+            atf::tests::detail::fail_eq(__LINE__, #expected, #actual, \
+                                        (expected), (actual)); \
     } while (false)
 
 #define ATF_REQUIRE_IN(element, collection) \
@@ -124,35 +140,23 @@
 
 #define ATF_REQUIRE_MATCH(regexp, string) \
     do { \
-        if (!atf::tests::detail::match(regexp, string)) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": '" << string << "' does not " \
-                    << "match regexp '" << regexp << "'"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
-        } \
+        if (ATF_DEFS_UNLIKELY(!atf::tests::detail::match(regexp, string))) \
+            atf::tests::detail::fail_match(__LINE__, regexp, string); \
     } while (false)
 
 #define ATF_REQUIRE_THROW(expected_exception, statement) \
     do { \
         try { \
             statement; \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ \
-                    << ": " #statement " did not throw " #expected_exception \
-                       " as expected"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_not_thrown(__LINE__, #statement, \
+                                                #expected_exception); \
         } catch (const expected_exception&) { \
         } catch (const std::exception& atfu_e) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " #statement " threw an " \
-                       "unexpected error (not " #expected_exception "): " \
-                    << atfu_e.what(); \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_unexpected_throw( \
+                __LINE__, #statement, #expected_exception, atfu_e.what()); \
         } catch (...) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " #statement " threw an " \
-                       "unexpected error (not " #expected_exception ")"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_unexpected_throw( \
+                __LINE__, #statement, #expected_exception, NULL); \
         } \
     } while (false)
 
@@ -160,31 +164,19 @@
     do { \
         try { \
             statement; \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ \
-                    << ": " #statement " did not throw " #expected_exception \
-                       " as expected"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_not_thrown(__LINE__, #statement, \
+                                                #expected_exception); \
         } catch (const expected_exception& e) { \
-            if (!atf::tests::detail::match(regexp, e.what())) { \
-                std::ostringstream atfu_ss; \
-                atfu_ss << "Line " << __LINE__ \
-                        << ": " #statement " threw " #expected_exception "(" \
-                        << e.what() << "), but does not match '" << regexp \
-                        << "'"; \
-                atf::tests::tc::fail(atfu_ss.str()); \
-            } \
+            if (!atf::tests::detail::match(regexp, e.what())) \
+                atf::tests::detail::fail_throw_mismatch( \
+                    __LINE__, #statement, #expected_exception, e.what(), \
+                    regexp); \
         } catch (const std::exception& atfu_e) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " #statement " threw an " \
-                        "unexpected error (not " #expected_exception "): " \
-                    << atfu_e.what(); \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_unexpected_throw( \
+                __LINE__, #statement, #expected_exception, atfu_e.what()); \
         } catch (...) { \
-            std::ostringstream atfu_ss; \
-            atfu_ss << "Line " << __LINE__ << ": " #statement " threw an " \
-                        "unexpected error (not " #expected_exception ")"; \
-            atf::tests::tc::fail(atfu_ss.str()); \
+            atf::tests::detail::fail_unexpected_throw( \
+                __LINE__, #statement, #expected_exception, NULL); \
         } \
     } while (false)
 
@@ -52,6 +52,15 @@ extern "C" {
 #include <vector>
 
 extern "C" {
+#include "atf-c/detail/filter.h"
+#include "atf-c/detail/index.h"
+#include "atf-c/detail/report.h"
+#include "atf-c/detail/runner.h"
+#include "atf-c/detail/shard.h"
+#include "atf-c/detail/tc.h"
+#include "atf-c/detail/trace.h"
+#include "atf-c/detail/vars.h"
+#include "atf-c/detail/zygote.h"
 #include "atf-c/error.h"
 #include "atf-c/tc.h"
 #include "atf-c/utils.h"
@@ -137,6 +146,63 @@ detail::match(const std::string& regexp, const std::string& str)
     return atf::text::match(str, regexp);
 }
 
+void
+detail::fail_require(const int line, const char* expression)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": " << expression << " not met";
+    impl::tc::fail(ss.str());
+}
+
+void
+detail::fail_match(const int line, const std::string& regexp,
+                   const std::string& str)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": '" << str << "' does not match regexp '"
+       << regexp << "'";
+    impl::tc::fail(ss.str());
+}
+
+void
+detail::fail_not_thrown(const int line, const char* statement,
+                        const char* exception)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": " << statement << " did not throw "
+       << exception << " as expected";
+    impl::tc::fail(ss.str());
+}
+
+//!
+//! \brief Fails because a statement raised an exception of the wrong type.
+//!
+//! \param what The description of the raised exception, or NULL if it was
+//!     not derived from std::exception.
+//!
+void
+detail::fail_unexpected_throw(const int line, const char* statement,
+                              const char* exception, const char* what)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": " << statement << " threw an unexpected "
+       << "error (not " << exception << ")";
+    if (what != NULL)
+        ss << ": " << what;
+    impl::tc::fail(ss.str());
+}
+
+void
+detail::fail_throw_mismatch(const int line, const char* statement,
+                            const char* exception, const std::string& what,
+                            const std::string& regexp)
+{
+    std::ostringstream ss;
+    ss << "Line " << line << ": " << statement << " threw " << exception
+       << "(" << what << "), but does not match '" << regexp << "'";
+    impl::tc::fail(ss.str());
+}
+
 // ------------------------------------------------------------------------
 // The "tc" class.
 // ------------------------------------------------------------------------
@@ -144,6 +210,31 @@ detail::match(const std::string& regexp, const std::string& str)
 static std::map< atf_tc_t*, impl::tc* > wraps;
 static std::map< const atf_tc_t*, const impl::tc* > cwraps;
 
+//!
+//! \brief Builds the C representation of a set of configuration variables.
+//!
+//! The returned table must be released with atf_vars_unref.
+//!
+static atf_vars_t*
+new_atf_vars(const impl::vars_map& config)
+{
+    std::vector< const char * > array;
+    array.reserve((config.size() * 2) + 1);
+
+    for (impl::vars_map::const_iterator iter = config.begin();
+         iter != config.end(); iter++) {
+         array.push_back((*iter).first.c_str());
+         array.push_back((*iter).second.c_str());
+    }
+    array.push_back(nullptr);
+
+    atf_vars_t* vars;
+    atf_error_t err = atf_vars_new(&vars, array.data());
+    if (atf_is_error(err))
+        atf::throw_atf_error(err);
+    return vars;
+}
+
 struct impl::tc_impl {
 private:
     // Non-copyable.
@@ -161,6 +252,48 @@ public:
     {
     }
 
+    static const char*
+    ident(const impl::tc& self)
+    {
+        return self.pimpl->m_ident.c_str();
+    }
+
+    static const char*
+    lookup_md_var(const void* data, const char* name)
+    {
+        const impl::tc& self = *static_cast< const impl::tc* >(data);
+        const atf_tc_t* tc = &self.pimpl->m_tc;
+
+        return atf_tc_has_md_var(tc, name) ? atf_tc_get_md_var(tc, name) :
+            NULL;
+    }
+
+    // Runs the cleanup routine of a test case and, with the extended
+    // results format, appends its timing to the given results file.
+    static void
+    run_cleanup(const impl::tc& self, const std::string& resfile)
+    {
+        atf_error_t err = atf_tc_cleanup_resfile(&self.pimpl->m_tc,
+                                                 resfile.c_str());
+        if (atf_is_error(err))
+            throw_atf_error(err);
+    }
+
+    static void
+    init(impl::tc& self, atf_vars_t* config)
+    {
+        tc_impl& pimpl = *self.pimpl;
+
+        wraps[&pimpl.m_tc] = &self;
+        cwraps[&pimpl.m_tc] = &self;
+
+        atf_error_t err = atf_tc_init_vars(&pimpl.m_tc, pimpl.m_ident.c_str(),
+            wrap_head, wrap_body, pimpl.m_has_cleanup ? wrap_cleanup : NULL,
+            config);
+        if (atf_is_error(err))
+            throw_atf_error(err);
+    }
+
     static void
     wrap_head(atf_tc_t *tc)
     {
@@ -204,26 +337,14 @@ impl::tc::~tc(void)
 void
 impl::tc::init(const vars_map& config)
 {
-    atf_error_t err;
-
-    std::vector< const char * > array;
-    array.reserve((config.size() * 2) + 1);
-
-    for (vars_map::const_iterator iter = config.begin();
-         iter != config.end(); iter++) {
-         array.push_back((*iter).first.c_str());
-         array.push_back((*iter).second.c_str());
+    atf_vars_t* vars = new_atf_vars(config);
+    try {
+        tc_impl::init(*this, vars);
+    } catch (...) {
+        atf_vars_unref(vars);
+        throw;
     }
-    array.push_back(nullptr);
-
-    wraps[&pimpl->m_tc] = this;
-    cwraps[&pimpl->m_tc] = this;
-
-    err = atf_tc_init(&pimpl->m_tc, pimpl->m_ident.c_str(), pimpl->wrap_head,
-        pimpl->wrap_body, pimpl->m_has_cleanup ? pimpl->wrap_cleanup : NULL,
-        array.data());
-    if (atf_is_error(err))
-        throw_atf_error(err);
+    atf_vars_unref(vars);
 }
 
 bool
@@ -408,6 +529,67 @@ typedef std::vector< impl::tc * > tc_vector;
 
 enum tc_part { BODY, CLEANUP };
 
+// The test cases of the program, along with an index to look them up by
+// name in constant time.
+class tc_table {
+    // Non-copyable.
+    tc_table(const tc_table&);
+    tc_table& operator=(const tc_table&);
+
+    atf_index_t m_index;
+
+public:
+    tc_vector tcs;
+
+    tc_table(void)
+    {
+        atf_error_t err = atf_index_init(&m_index);
+        if (atf_is_error(err))
+            atf::throw_atf_error(err);
+    }
+
+    ~tc_table(void)
+    {
+        atf_index_fini(&m_index);
+    }
+
+    void
+    build_index(void)
+    {
+        for (tc_vector::iterator iter = tcs.begin(); iter != tcs.end();
+             iter++) {
+            impl::tc* tc = *iter;
+
+            // Keep the first registration of a duplicate name, as the
+            // linear lookup this index replaced did.
+            if (has(impl::tc_impl::ident(*tc)))
+                continue;
+
+            atf_error_t err = atf_index_insert(
+                &m_index, impl::tc_impl::ident(*tc), tc);
+            if (atf_is_error(err))
+                atf::throw_atf_error(err);
+        }
+    }
+
+    bool
+    has(const char* name)
+        const
+    {
+        return atf_index_get(&m_index, name) != NULL;
+    }
+
+    impl::tc*
+    find(const std::string& name)
+        const
+    {
+        void* tc = atf_index_get(&m_index, name.c_str());
+        if (tc == NULL)
+            throw usage_error("Unknown test case `%s'", name.c_str());
+        return static_cast< impl::tc* >(tc);
+    }
+};
+
 static void
 parse_vflag(const std::string& str, atf::tests::vars_map& vars)
 {
@@ -449,24 +631,113 @@ handle_srcdir(const char* argv0, const std::string& srcdir_arg)
 }
 
 static void
-init_tcs(void (*add_tcs)(tc_vector&), tc_vector& tcs,
+init_tcs(void (*add_tcs)(tc_vector&), tc_table& table,
          const atf::tests::vars_map& vars)
 {
+    atf_trace_span_t span;
+    atf_trace_begin(&span);
+
+    tc_vector& tcs = table.tcs;
     add_tcs(tcs);
-    for (tc_vector::iterator iter = tcs.begin(); iter != tcs.end(); iter++) {
-        impl::tc* tc = *iter;
 
-        tc->init(vars);
+    // All test cases share a single copy of the configuration.
+    atf_vars_t* config = new_atf_vars(vars);
+    try {
+        for (tc_vector::iterator iter = tcs.begin(); iter != tcs.end();
+             iter++) {
+            impl::tc* tc = *iter;
+
+            impl::tc_impl::init(*tc, config);
+        }
+    } catch (...) {
+        atf_vars_unref(config);
+        throw;
     }
+    atf_vars_unref(config);
+
+    table.build_index();
+    atf_trace_end(&span, "tp", "register", Program_Name.c_str());
 }
 
+// The test cases selected with the -F and -S flags.
+class tc_selection {
+    // Non-copyable.
+    tc_selection(const tc_selection&);
+    tc_selection& operator=(const tc_selection&);
+
+    atf_filter_t m_filter;
+    atf_shard_t m_shard;
+
+public:
+    tc_selection(void)
+    {
+        atf_shard_init(&m_shard);
+        atf_error_t err = atf_filter_init(&m_filter);
+        if (atf_is_error(err))
+            atf::throw_atf_error(err);
+    }
+
+    ~tc_selection(void)
+    {
+        atf_filter_fini(&m_filter);
+    }
+
+    void
+    add_filter(const std::string& str)
+    {
+        atf_error_t err = atf_filter_add(&m_filter, str.c_str());
+        if (atf_is_error(err)) {
+            if (atf_error_is(err, "libc")) {
+                const std::string msg = atf_libc_error_msg(err);
+                atf_error_free(err);
+                throw usage_error("%s", msg.c_str());
+            }
+            atf::throw_atf_error(err);
+        }
+    }
+
+    void
+    set_shard(const std::string& str)
+    {
+        atf_error_t err = atf_shard_init_str(&m_shard, str.c_str());
+        if (atf_is_error(err)) {
+            atf_error_free(err);
+            throw usage_error("-S requires an argument of the form "
+                              "index/count with index lower than count");
+        }
+    }
+
+    bool
+    selects_all(void)
+        const
+    {
+        return atf_shard_is_all(&m_shard) && atf_filter_is_empty(&m_filter);
+    }
+
+    // The shard only depends on the name of the test case, so it is
+    // checked first to avoid evaluating the heads of other shards.
+    bool
+    selects(const impl::tc& tc)
+        const
+    {
+        const char* ident = impl::tc_impl::ident(tc);
+
+        return atf_shard_contains(&m_shard, ident) &&
+            atf_filter_matches(&m_filter, ident, impl::tc_impl::lookup_md_var,
+                               &tc);
+    }
+};
+
 static int
-list_tcs(const tc_vector& tcs)
+list_tcs(const tc_vector& tcs, const tc_selection& selection)
 {
     detail::atf_tp_writer writer(std::cout);
 
     for (tc_vector::const_iterator iter = tcs.begin();
          iter != tcs.end(); iter++) {
+        if (!selection.selects(**iter))
+            continue;
+
         const impl::vars_map vars = (*iter)->get_md_vars();
 
         {
@@ -488,20 +759,6 @@ list_tcs(const tc_vector& tcs)
     return EXIT_SUCCESS;
 }
 
-static impl::tc*
-find_tc(tc_vector tcs, const std::string& name)
-{
-    std::vector< std::string > ids;
-    for (tc_vector::iterator iter = tcs.begin();
-         iter != tcs.end(); iter++) {
-        impl::tc* tc = *iter;
-
-        if (tc->get_md_var("ident") == name)
-            return tc;
-    }
-    throw usage_error("Unknown test case `%s'", name.c_str());
-}
-
 static std::pair< std::string, tc_part >
 process_tcarg(const std::string& tcarg)
 {
@@ -522,13 +779,21 @@ process_tcarg(const std::string& tcarg)
     }
 }
 
-static int
-run_tc(tc_vector& tcs, const std::string& tcarg, const atf::fs::path& resfile)
+// Replaces the first occurrence of %s in the results file, if any, with the
+// name of the test case.
+static atf::fs::path
+expand_resfile(const atf::fs::path& resfile, const std::string& tcname)
 {
-    const std::pair< std::string, tc_part > fields = process_tcarg(tcarg);
-
-    impl::tc* tc = find_tc(tcs, fields.first);
+    std::string str = resfile.str();
+    const std::string::size_type pos = str.find("%s");
+    if (pos == std::string::npos)
+        return resfile;
+    return atf::fs::path(str.replace(pos, 2, tcname));
+}
 
+static void
+warn_if_unsupervised(void)
+{
     if (!atf::env::has("__RUNNING_INSIDE_ATF_RUN") || atf::env::get(
         "__RUNNING_INSIDE_ATF_RUN") != "internal-yes-value")
     {
@@ -538,13 +803,75 @@ run_tc(tc_vector& tcs, const std::string& tcarg, const atf::fs::path& resfile)
             "control is being applied; you may get unexpected failures; see "
             "atf-test-case(4)\n";
     }
+}
+
+static void
+run_tc_part(void* data, const char* name, const bool cleanup,
+            const char* resfile)
+{
+    const tc_table& table = *static_cast< const tc_table* >(data);
+
+    // Only the work done in this child counts towards its initialization.
+    atf_tc_start_init_timing();
+
+    try {
+        impl::tc* tc = table.find(name);
+        if (cleanup && resfile != NULL)
+            impl::tc_impl::run_cleanup(*tc, resfile);
+        else if (cleanup)
+            tc->run_cleanup();
+        else
+            tc->run(resfile);
+    } catch (const std::exception& e) {
+        std::cerr << Program_Name << ": ERROR: " << e.what() << '\n';
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Runs the body of a test case in a subprocess honoring its timeout.
+static int
+run_body_with_timeout(tc_table& table, const impl::tc* tc,
+                      const atf::fs::path& resfile)
+{
+    unsigned int timeout = 0;
+    if (tc->has_md_var("timeout")) {
+        try {
+            timeout = atf::text::to_type< unsigned int >(
+                tc->get_md_var("timeout"));
+        } catch (const std::runtime_error&) {
+            // Invalid values are rejected when the property is set.
+        }
+    }
+
+    bool ok;
+    atf_error_t err = atf_runner_run_body(
+        run_tc_part, &table, tc->get_md_var("ident").c_str(), timeout,
+        resfile.c_str(), &ok);
+    if (atf_is_error(err))
+        atf::throw_atf_error(err);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int
+run_tc(tc_table& table, const std::string& tcarg, const atf::fs::path& resfile,
+       const bool tflag)
+{
+    const std::pair< std::string, tc_part > fields = process_tcarg(tcarg);
+
+    impl::tc* tc = table.find(fields.first);
+
+    warn_if_unsupervised();
 
     switch (fields.second) {
     case BODY:
-        tc->run(resfile.str());
+        if (tflag)
+            return run_body_with_timeout(table, tc, expand_resfile(
+                resfile, fields.first));
+        tc->run(expand_resfile(resfile, fields.first).str());
         break;
     case CLEANUP:
-        tc->run_cleanup();
+        impl::tc_impl::run_cleanup(*tc, expand_resfile(
+            resfile, fields.first).str());
         break;
     default:
         UNREACHABLE;
@@ -552,23 +879,178 @@ run_tc(tc_vector& tcs, const std::string& tcarg, const atf::fs::path& resfile)
     return EXIT_SUCCESS;
 }
 
+// The report to which a batch run adds the result of every test case, if
+// requested through the ATF_REPORT_FILE environment variable.
+class batch_report {
+    // Non-copyable.
+    batch_report(const batch_report&);
+    batch_report& operator=(const batch_report&);
+
+    atf_report_t m_report;
+    bool m_enabled;
+
+public:
+    batch_report(void)
+    {
+        atf_error_t err = atf_report_open_from_env(&m_report,
+                                                   Program_Name.c_str(),
+                                                   &m_enabled);
+        if (atf_is_error(err))
+            atf::throw_atf_error(err);
+    }
+
+    ~batch_report(void)
+    {
+        if (m_enabled) {
+            atf_error_t err = atf_report_close(&m_report);
+            if (atf_is_error(err))
+                atf_error_free(err);
+        }
+    }
+
+    void
+    add(const impl::tc& tc, const atf::fs::path& resfile)
+    {
+        if (!m_enabled)
+            return;
+        atf_error_t err = atf_runner_report_resfile(
+            &m_report, tc.get_md_var("ident").c_str(), resfile.c_str());
+        if (atf_is_error(err))
+            atf::throw_atf_error(err);
+    }
+
+    void
+    close(void)
+    {
+        if (!m_enabled)
+            return;
+        m_enabled = false;
+        atf_error_t err = atf_report_close(&m_report);
+        if (atf_is_error(err))
+            atf::throw_atf_error(err);
+    }
+};
+
+// Runs several test cases, one after the other, each in a forked child.
+static int
+run_batch(tc_table& table, const std::vector< std::string >& tcargs,
+          const atf::fs::path& resfile, const bool tflag,
+          const tc_selection& selection)
+{
+    std::vector< std::pair< impl::tc*, tc_part > > parts;
+    std::vector< atf::fs::path > resfiles;
+    for (std::vector< std::string >::const_iterator iter = tcargs.begin();
+         iter != tcargs.end(); iter++) {
+        const std::pair< std::string, tc_part > fields = process_tcarg(*iter);
+        impl::tc* tc = table.find(fields.first);
+        if (!selection.selects(*tc))
+            continue;
+        parts.push_back(std::make_pair(tc, fields.second));
+        resfiles.push_back(expand_resfile(resfile, fields.first));
+    }
+
+    warn_if_unsupervised();
+
+    batch_report report;
+    bool ok = true;
+    for (std::vector< std::pair< impl::tc*, tc_part > >::size_type i = 0;
+         i < parts.size(); i++) {
+        if (tflag && parts[i].second == BODY) {
+            if (run_body_with_timeout(table, parts[i].first, resfiles[i]) !=
+                EXIT_SUCCESS)
+                ok = false;
+            report.add(*parts[i].first, resfiles[i]);
+            continue;
+        }
+
+        std::cout.flush();
+        std::cerr.flush();
+
+        const pid_t pid = ::fork();
+        if (pid == -1)
+            throw atf::system_error(IMPL_NAME "::run_batch",
+                                    "Failed to fork", errno);
+        else if (pid == 0) {
+            try {
+                atf_tc_start_init_timing();
+                if (parts[i].second == CLEANUP)
+                    impl::tc_impl::run_cleanup(*parts[i].first,
+                                               resfiles[i].str());
+                else
+                    parts[i].first->run(resfiles[i].str());
+            } catch (const std::exception& e) {
+                std::cerr << Program_Name << ": ERROR: " << e.what() << '\n';
+                std::exit(EXIT_FAILURE);
+            }
+            std::exit(EXIT_SUCCESS);
+        }
+
+        int status;
+        while (::waitpid(pid, &status, 0) == -1) {
+            if (errno != EINTR)
+                throw atf::system_error(IMPL_NAME "::run_batch",
+                                        "Failed to wait for test case", errno);
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            ok = false;
+        if (parts[i].second == BODY)
+            report.add(*parts[i].first, resfiles[i]);
+    }
+    report.close();
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool
+zygote_has_tc(void* data, const char* name)
+{
+    const tc_table& table = *static_cast< const tc_table* >(data);
+
+    return table.has(name);
+}
+
+static int
+serve_tcs(tc_table& table, const std::string& endpoint)
+{
+    atf_error_t err = atf_zygote_serve(endpoint.c_str(), zygote_has_tc,
+                                       run_tc_part, &table);
+    if (atf_is_error(err))
+        atf::throw_atf_error(err);
+    return EXIT_SUCCESS;
+}
+
 static int
 safe_main(int argc, char** argv, void (*add_tcs)(tc_vector&))
 {
     const char* argv0 = argv[0];
 
     bool lflag = false;
+    bool tflag = false;
     atf::fs::path resfile("/dev/stdout");
     std::string srcdir_arg;
+    std::string zygote;
     atf::tests::vars_map vars;
+    tc_selection selection;
 
     int ch;
     int old_opterr;
 
     old_opterr = opterr;
     ::opterr = 0;
-    while ((ch = ::getopt(argc, argv, GETOPT_POSIX ":lr:s:v:")) != -1) {
+    while ((ch = ::getopt(argc, argv, GETOPT_POSIX ":F:S:Tlr:s:v:z:")) != -1) {
         switch (ch) {
+        case 'F':
+            selection.add_filter(::optarg);
+            break;
+
+        case 'S':
+            selection.set_shard(::optarg);
+            break;
+
+        case 'T':
+            tflag = true;
+            break;
+
         case 'l':
             lflag = true;
             break;
@@ -585,6 +1067,10 @@ safe_main(int argc, char** argv, void (*add_tcs)(tc_vector&))
             parse_vflag(::optarg, vars);
             break;
 
+        case 'z':
+            zygote = ::optarg;
+            break;
+
         case ':':
             throw usage_error("Option -%c requires an argument.", ::optopt);
             break;
@@ -608,24 +1094,45 @@ safe_main(int argc, char** argv, void (*add_tcs)(tc_vector&))
 
     int errcode;
 
-    tc_vector tcs;
-    if (lflag) {
+    tc_table table;
+    if (!zygote.empty()) {
+        if (lflag || tflag || !selection.selects_all())
+            throw usage_error("Cannot use -z with -l, -F, -S or -T");
+        if (argc > 0)
+            throw usage_error("Cannot provide test case names with -z");
+
+        init_tcs(add_tcs, table, vars);
+        errcode = serve_tcs(table, zygote);
+    } else if (lflag) {
         if (argc > 0)
             throw usage_error("Cannot provide test case names with -l");
 
-        init_tcs(add_tcs, tcs, vars);
-        errcode = list_tcs(tcs);
+        init_tcs(add_tcs, table, vars);
+        errcode = list_tcs(table.tcs, selection);
     } else {
         if (argc == 0)
             throw usage_error("Must provide a test case name");
-        else if (argc > 1)
-            throw usage_error("Cannot provide more than one test case name");
-        INV(argc == 1);
-
-        init_tcs(add_tcs, tcs, vars);
-        errcode = run_tc(tcs, argv[0], resfile);
+        else if (argc > 1 || !selection.selects_all()) {
+            // A filtered run may skip the test case, so it always goes
+            // through the batch mode and its results file template.
+            if (resfile.str().find("%s") == std::string::npos)
+                throw usage_error("Must provide a results file template "
+                                  "containing %%s when running more than one "
+                                  "test case or with -F or -S");
+
+            init_tcs(add_tcs, table, vars);
+            errcode = run_batch(table, std::vector< std::string >(argv,
+                                                               argv + argc),
+                                resfile, tflag, selection);
+        } else {
+            INV(argc == 1);
+
+            init_tcs(add_tcs, table, vars);
+            errcode = run_tc(table, argv[0], resfile, tflag);
+        }
     }
-    for (tc_vector::iterator iter = tcs.begin(); iter != tcs.end(); iter++) {
+    for (tc_vector::iterator iter = table.tcs.begin(); iter != table.tcs.end();
+         iter++) {
         impl::tc* tc = *iter;
 
         delete tc;
@@ -646,6 +1153,7 @@ int
 impl::run_tp(int argc, char** argv, void (*add_tcs)(tc_vector&))
 {
     try {
+        atf_tc_start_init_timing();
         set_program_name(argv[0]);
         return ::safe_main(argc, argv, add_tcs);
     } catch (const usage_error& e) {
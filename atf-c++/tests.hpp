@@ -54,6 +54,20 @@ public:
 
 bool match(const std::string&, const std::string&);
 
+// Out-of-line failure paths of the macros in macros.hpp.  These are kept
+// away from the call sites so that a passing check costs a single branch.
+void fail_require(const int, const char*)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+void fail_match(const int, const std::string&, const std::string&)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+void fail_not_thrown(const int, const char*, const char*)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+void fail_unexpected_throw(const int, const char*, const char*, const char*)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+void fail_throw_mismatch(const int, const char*, const char*,
+                         const std::string&, const std::string&)
+    ATF_DEFS_ATTRIBUTE_COLD ATF_DEFS_ATTRIBUTE_NORETURN;
+
 } // namespace
 
 // ------------------------------------------------------------------------
@@ -0,0 +1,84 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+/*
+ * Converts the report of one or more test program runs into a JUnit XML
+ * file.  See atf-junit(1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "atf-c/detail/report.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+static const char *progname = "atf-junit";
+
+static
+void
+print_error(const atf_error_t err)
+{
+    char buf[4096];
+
+    PRE(atf_is_error(err));
+
+    atf_error_format(err, buf, sizeof(buf));
+    fprintf(stderr, "%s: ERROR: %s\n", progname, buf);
+}
+
+static
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: %s report junit_file\n", progname);
+    fprintf(stderr, "See atf-junit(1) for usage details.\n");
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    atf_error_t err;
+    int ch;
+
+    while ((ch = getopt(argc, argv, "")) != -1)
+        usage();
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 2)
+        usage();
+
+    err = atf_report_to_junit(argv[0], argv[1]);
+    if (atf_is_error(err)) {
+        print_error(err);
+        atf_error_free(err);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
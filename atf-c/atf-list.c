@@ -0,0 +1,230 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+/*
+ * Prints the list of test cases of test programs without executing them
+ * when the list was precomputed with the -w flag.  See atf-list(1).
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atf-c/detail/dynstr.h"
+#include "atf-c/detail/embed.h"
+#include "atf-c/detail/env.h"
+#include "atf-c/detail/fs.h"
+#include "atf-c/detail/process.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+static const char *progname = "atf-list";
+
+static
+void
+print_error(const char *program, const atf_error_t err)
+{
+    char buf[4096];
+
+    PRE(atf_is_error(err));
+
+    atf_error_format(err, buf, sizeof(buf));
+    fprintf(stderr, "%s: ERROR: %s: %s\n", progname, program, buf);
+}
+
+static
+void
+usage(void)
+{
+    fprintf(stderr, "Usage: %s [-n | -w] test_program ...\n", progname);
+    fprintf(stderr, "See atf-list(1) for usage details.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+ * Runs a test program with -l and appends its output to list.
+ */
+static
+atf_error_t
+run_list(const char *program, atf_dynstr_t *list)
+{
+    atf_error_t err;
+    atf_fs_path_t prog, temp;
+    atf_process_stream_t outsb;
+    atf_process_status_t status;
+    char buf[4096];
+    ssize_t cnt;
+    int fd;
+
+    /* Do not let execvp(3) look up bare names in the PATH. */
+    err = atf_fs_path_init_fmt(&prog, "%s%s",
+                               strchr(program, '/') == NULL ? "./" : "",
+                               program);
+    if (atf_is_error(err))
+        goto out;
+
+    err = atf_fs_path_init_fmt(&temp, "%s/atf-list.XXXXXX",
+                               atf_env_get_with_default("TMPDIR", "/tmp"));
+    if (atf_is_error(err))
+        goto out_prog;
+
+    err = atf_fs_mkstemp(&temp, &fd);
+    if (atf_is_error(err))
+        goto out_temp;
+
+    err = atf_process_stream_init_redirect_fd(&outsb, fd);
+    if (atf_is_error(err))
+        goto out_fd;
+
+    {
+        const char *argv[] = { atf_fs_path_cstring(&prog), "-l", NULL };
+
+        err = atf_process_exec_array(&status, &prog, argv, &outsb, NULL,
+                                     NULL);
+    }
+    atf_process_stream_fini(&outsb);
+    if (atf_is_error(err))
+        goto out_fd;
+
+    if (!atf_process_status_exited(&status) ||
+        atf_process_status_exitstatus(&status) != EXIT_SUCCESS)
+        err = atf_libc_error(EINVAL, "Cannot list the test cases");
+    atf_process_status_fini(&status);
+
+    if (!atf_is_error(err) && lseek(fd, 0, SEEK_SET) == -1)
+        err = atf_libc_error(errno, "Cannot read the test case list");
+    while (!atf_is_error(err) && (cnt = read(fd, buf, sizeof(buf))) != 0) {
+        if (cnt == -1)
+            err = atf_libc_error(errno, "Cannot read the test case list");
+        else
+            err = atf_dynstr_append_mem(list, buf, cnt);
+    }
+
+out_fd:
+    close(fd);
+    (void)unlink(atf_fs_path_cstring(&temp));
+out_temp:
+    atf_fs_path_fini(&temp);
+out_prog:
+    atf_fs_path_fini(&prog);
+out:
+    return err;
+}
+
+static
+atf_error_t
+print_list(const char *program, const bool run, const bool header)
+{
+    atf_error_t err;
+    atf_dynstr_t list;
+    bool found;
+
+    err = atf_dynstr_init(&list);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_embed_read(program, &list, &found);
+    if (!atf_is_error(err) && !found) {
+        if (run)
+            err = run_list(program, &list);
+        else
+            err = atf_libc_error(ENOENT, "No precomputed test case list");
+    }
+
+    if (!atf_is_error(err)) {
+        if (header)
+            printf("program: %s\n", program);
+        fputs(atf_dynstr_cstring(&list), stdout);
+        fflush(stdout);
+    }
+
+    atf_dynstr_fini(&list);
+    return err;
+}
+
+static
+atf_error_t
+write_list(const char *program)
+{
+    atf_error_t err;
+    atf_dynstr_t list;
+
+    err = atf_dynstr_init(&list);
+    if (atf_is_error(err))
+        return err;
+
+    err = run_list(program, &list);
+    if (!atf_is_error(err))
+        err = atf_embed_write(program, atf_dynstr_cstring(&list));
+
+    atf_dynstr_fini(&list);
+    return err;
+}
+
+int
+main(int argc, char **argv)
+{
+    bool nflag = false, wflag = false;
+    int ch, i, ret = EXIT_SUCCESS;
+
+    while ((ch = getopt(argc, argv, ":nw")) != -1) {
+        switch (ch) {
+        case 'n':
+            nflag = true;
+            break;
+
+        case 'w':
+            wflag = true;
+            break;
+
+        default:
+            usage();
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc == 0 || (nflag && wflag))
+        usage();
+
+    for (i = 0; i < argc; i++) {
+        atf_error_t err;
+
+        if (wflag)
+            err = write_list(argv[i]);
+        else
+            err = print_list(argv[i], !nflag, argc > 1);
+        if (atf_is_error(err)) {
+            print_error(argv[i], err);
+            atf_error_free(err);
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    return ret;
+}
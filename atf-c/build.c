@@ -49,7 +49,7 @@ append_config_var(const char *var, const char *default_value, atf_list_t *argv)
     if (atf_is_error(err))
         goto out;
 
-    atf_list_append_list(argv, &words);
+    err = atf_list_append_list(argv, &words);
 
 out:
     return err;
@@ -110,34 +110,6 @@ out:
     return err;
 }
 
-static
-atf_error_t
-list_to_array(const atf_list_t *l, char ***ap)
-{
-    atf_error_t err;
-    char **a;
-
-    a = (char **)malloc((atf_list_size(l) + 1) * sizeof(char *));
-    if (a == NULL)
-        err = atf_no_memory_error();
-    else {
-        char **aiter;
-        atf_list_citer_t liter;
-
-        aiter = a;
-        atf_list_for_each_c(liter, l) {
-            *aiter = strdup((const char *)atf_list_citer_data(liter));
-            aiter++;
-        }
-        *aiter = NULL;
-
-        err = atf_no_error();
-    }
-    *ap = a; /* Shut up warnings in the caller about uninitialized *ap. */
-
-    return err;
-}
-
 /* ---------------------------------------------------------------------
  * Free functions.
  * --------------------------------------------------------------------- */
@@ -178,9 +150,9 @@ atf_build_c_o(const char *sfile,
     if (atf_is_error(err))
         goto out_list;
 
-    err = list_to_array(&argv_list, argv);
-    if (atf_is_error(err))
-        goto out_list;
+    *argv = atf_list_to_charpp(&argv_list);
+    if (*argv == NULL)
+        err = atf_no_memory_error();
 
 out_list:
     atf_list_fini(&argv_list);
@@ -224,9 +196,9 @@ atf_build_cpp(const char *sfile,
     if (atf_is_error(err))
         goto out_list;
 
-    err = list_to_array(&argv_list, argv);
-    if (atf_is_error(err))
-        goto out_list;
+    *argv = atf_list_to_charpp(&argv_list);
+    if (*argv == NULL)
+        err = atf_no_memory_error();
 
 out_list:
     atf_list_fini(&argv_list);
@@ -271,9 +243,9 @@ atf_build_cxx_o(const char *sfile,
     if (atf_is_error(err))
         goto out_list;
 
-    err = list_to_array(&argv_list, argv);
-    if (atf_is_error(err))
-        goto out_list;
+    *argv = atf_list_to_charpp(&argv_list);
+    if (*argv == NULL)
+        err = atf_no_memory_error();
 
 out_list:
     atf_list_fini(&argv_list);
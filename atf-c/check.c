@@ -43,6 +43,7 @@
 #include "atf-c/detail/list.h"
 #include "atf-c/detail/process.h"
 #include "atf-c/detail/sanity.h"
+#include "atf-c/detail/trace.h"
 #include "atf-c/error.h"
 #include "atf-c/utils.h"
 
@@ -174,15 +175,19 @@ fork_and_wait(const char *const *argv, const atf_fs_path_t *outfile,
     atf_process_stream_t outsb, errsb;
     struct exec_data ea = { argv };
 
+    atf_trace_span_t span;
+
     err = init_sbs(outfile, &outsb, errfile, &errsb);
     if (atf_is_error(err))
         goto out;
 
+    atf_trace_begin(&span);
     err = atf_process_fork(&child, exec_child, &outsb, &errsb, &ea);
     if (atf_is_error(err))
         goto out_sbs;
 
     err = atf_process_child_wait(&child, status);
+    atf_trace_end(&span, "check", "spawn", argv[0]);
 
 out_sbs:
     atf_process_stream_fini(&errsb);
@@ -337,10 +342,14 @@ out:
 void
 atf_check_result_fini(atf_check_result_t *r)
 {
+    atf_trace_span_t span;
+
     atf_process_status_fini(&r->pimpl->m_status);
 
+    atf_trace_begin(&span);
     cleanup_tmpdir(&r->pimpl->m_dir, &r->pimpl->m_stdout,
                    &r->pimpl->m_stderr);
+    atf_trace_end(&span, "check", "rmdir", NULL);
     atf_fs_path_fini(&r->pimpl->m_stdout);
     atf_fs_path_fini(&r->pimpl->m_stderr);
     atf_fs_path_fini(&r->pimpl->m_dir);
@@ -458,8 +467,11 @@ atf_check_exec_array(const char *const *argv, atf_check_result_t *r)
 {
     atf_error_t err;
     atf_fs_path_t dir;
+    atf_trace_span_t span;
 
+    atf_trace_begin(&span);
     err = create_tmpdir(&dir);
+    atf_trace_end(&span, "check", "mkdtemp", NULL);
     if (atf_is_error(err))
         goto out;
 
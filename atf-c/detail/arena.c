@@ -0,0 +1,161 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* Every allocation is aligned as strictly as any of these types. */
+union max_align {
+    long double m_ld;
+    long long m_ll;
+    void *m_ptr;
+    void (*m_func)(void);
+};
+
+#define ALIGNMENT sizeof(union max_align)
+
+/* Usable size of the chunks that hold the small allocations. */
+#define CHUNK_SIZE (16 * 1024)
+
+struct chunk {
+    struct chunk *m_next;
+    union max_align m_data[];
+};
+
+static
+struct chunk *
+new_chunk(const size_t size)
+{
+    if (size > SIZE_MAX - sizeof(struct chunk))
+        return NULL;
+
+    return malloc(sizeof(struct chunk) + size);
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_arena" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_arena_init(atf_arena_t *a)
+{
+    /* Chunks are allocated on demand. */
+    a->m_chunks = NULL;
+    a->m_next = NULL;
+    a->m_avail = 0;
+
+    return atf_no_error();
+}
+
+void
+atf_arena_fini(atf_arena_t *a)
+{
+    struct chunk *c = a->m_chunks;
+
+    while (c != NULL) {
+        struct chunk *next = c->m_next;
+        free(c);
+        c = next;
+    }
+}
+
+/*
+ * Modifiers.
+ */
+
+/*
+ * Returns size bytes of memory that remain valid until the arena is
+ * finalized, or NULL if there is no memory left.
+ */
+void *
+atf_arena_alloc(atf_arena_t *a, size_t size)
+{
+    struct chunk *c;
+    void *ptr;
+
+    if (size > SIZE_MAX - ALIGNMENT)
+        return NULL;
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    if (size <= a->m_avail) {
+        ptr = a->m_next;
+        a->m_next += size;
+        a->m_avail -= size;
+        return ptr;
+    }
+
+    if (size > CHUNK_SIZE / 4) {
+        /* Large objects get a chunk of their own, linked behind the
+         * current one so that its free space is not wasted. */
+        c = new_chunk(size);
+        if (c == NULL)
+            return NULL;
+
+        if (a->m_chunks == NULL) {
+            c->m_next = NULL;
+            a->m_chunks = c;
+        } else {
+            struct chunk *current = a->m_chunks;
+            c->m_next = current->m_next;
+            current->m_next = c;
+        }
+        return c->m_data;
+    }
+
+    c = new_chunk(CHUNK_SIZE);
+    if (c == NULL)
+        return NULL;
+    c->m_next = a->m_chunks;
+    a->m_chunks = c;
+
+    a->m_next = (char *)c->m_data + size;
+    a->m_avail = CHUNK_SIZE - size;
+    return c->m_data;
+}
+
+char *
+atf_arena_strdup(atf_arena_t *a, const char *str)
+{
+    const size_t size = strlen(str) + 1;
+    char *copy;
+
+    copy = atf_arena_alloc(a, size);
+    if (copy != NULL)
+        memcpy(copy, str, size);
+    return copy;
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_ARENA_H)
+#define ATF_C_DETAIL_ARENA_H
+
+#include <stddef.h>
+
+#include <atf-c/error_fwd.h>
+
+/* ---------------------------------------------------------------------
+ * The "atf_arena" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * A bump allocator for objects that live as long as their owner, such as
+ * the test cases registered in a test program.  Allocations cannot be
+ * released individually; all of them go away at once in atf_arena_fini.
+ */
+struct atf_arena {
+    void *m_chunks;
+    char *m_next;
+    size_t m_avail;
+};
+typedef struct atf_arena atf_arena_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_arena_init(atf_arena_t *);
+void atf_arena_fini(atf_arena_t *);
+
+/* Modifiers. */
+void *atf_arena_alloc(atf_arena_t *, size_t);
+char *atf_arena_strdup(atf_arena_t *, const char *);
+
+#endif /* !defined(ATF_C_DETAIL_ARENA_H) */
@@ -0,0 +1,119 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_arena" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(arena_empty);
+ATF_TC_BODY(arena_empty, tc)
+{
+    atf_arena_t arena;
+
+    RE(atf_arena_init(&arena));
+    atf_arena_fini(&arena);
+}
+
+ATF_TC_WITHOUT_HEAD(arena_alloc);
+ATF_TC_BODY(arena_alloc, tc)
+{
+    atf_arena_t arena;
+    unsigned char *ptrs[5000];
+    size_t i;
+
+    RE(atf_arena_init(&arena));
+
+    /* Enough small objects to span several chunks, interleaved with some
+     * large ones, none of which may overlap. */
+    for (i = 0; i < 5000; i++) {
+        const size_t size = i % 1000 == 999 ? 64 * 1024 : i % 40 + 1;
+
+        ptrs[i] = atf_arena_alloc(&arena, size);
+        ATF_REQUIRE(ptrs[i] != NULL);
+        ATF_REQUIRE_EQ((uintptr_t)ptrs[i] % sizeof(void *), 0);
+        memset(ptrs[i], i % 256, size);
+    }
+    for (i = 0; i < 5000; i++)
+        ATF_REQUIRE_EQ(ptrs[i][0], i % 256);
+
+    atf_arena_fini(&arena);
+}
+
+ATF_TC_WITHOUT_HEAD(arena_alloc_too_large);
+ATF_TC_BODY(arena_alloc_too_large, tc)
+{
+    atf_arena_t arena;
+
+    RE(atf_arena_init(&arena));
+    ATF_REQUIRE(atf_arena_alloc(&arena, SIZE_MAX) == NULL);
+    ATF_REQUIRE(atf_arena_alloc(&arena, SIZE_MAX - 8) == NULL);
+    atf_arena_fini(&arena);
+}
+
+ATF_TC_WITHOUT_HEAD(arena_strdup);
+ATF_TC_BODY(arena_strdup, tc)
+{
+    atf_arena_t arena;
+    char buf[] = "Some string";
+    char *copy;
+
+    RE(atf_arena_init(&arena));
+
+    copy = atf_arena_strdup(&arena, buf);
+    ATF_REQUIRE(copy != NULL);
+    ATF_REQUIRE(copy != buf);
+    strcpy(buf, "Other value");
+    ATF_REQUIRE_STREQ(copy, "Some string");
+
+    copy = atf_arena_strdup(&arena, "");
+    ATF_REQUIRE(copy != NULL);
+    ATF_REQUIRE_STREQ(copy, "");
+
+    atf_arena_fini(&arena);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, arena_empty);
+    ATF_TP_ADD_TC(tp, arena_alloc);
+    ATF_TP_ADD_TC(tp, arena_alloc_too_large);
+    ATF_TP_ADD_TC(tp, arena_strdup);
+
+    return atf_no_error();
+}
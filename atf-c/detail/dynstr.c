@@ -33,7 +33,6 @@
 #include <string.h>
 
 #include "atf-c/detail/sanity.h"
-#include "atf-c/detail/text.h"
 #include "atf-c/error.h"
 
 /* ---------------------------------------------------------------------
@@ -41,65 +40,133 @@
  * --------------------------------------------------------------------- */
 
 static
+char *
+buffer(atf_dynstr_t *ad)
+{
+    return ad->m_data != NULL ? ad->m_data : ad->m_inline;
+}
+
+static
+const char *
+buffer_c(const atf_dynstr_t *ad)
+{
+    return ad->m_data != NULL ? ad->m_data : ad->m_inline;
+}
+
+/** Ensures that the buffer can hold at least size bytes.
+ *
+ * The buffer grows geometrically so that a sequence of appends runs in
+ * amortized linear time. */
+static
 atf_error_t
-resize(atf_dynstr_t *ad, size_t newsize)
+reserve(atf_dynstr_t *ad, size_t size)
 {
+    size_t newsize;
     char *newdata;
-    atf_error_t err;
 
-    PRE(newsize > ad->m_datasize);
+    if (size <= ad->m_datasize)
+        return atf_no_error();
+
+    newsize = ad->m_datasize * 2;
+    if (newsize < size)
+        newsize = size;
 
-    newdata = (char *)malloc(newsize);
-    if (newdata == NULL) {
-        err = atf_no_memory_error();
+    if (ad->m_data != NULL) {
+        newdata = (char *)realloc(ad->m_data, newsize);
+        if (newdata == NULL)
+            return atf_no_memory_error();
     } else {
-        strcpy(newdata, ad->m_data);
-        free(ad->m_data);
-        ad->m_data = newdata;
-        ad->m_datasize = newsize;
-        err = atf_no_error();
+        newdata = (char *)malloc(newsize);
+        if (newdata == NULL)
+            return atf_no_memory_error();
+        memcpy(newdata, ad->m_inline, ad->m_length + 1);
     }
 
-    return err;
+    ad->m_data = newdata;
+    ad->m_datasize = newsize;
+    return atf_no_error();
 }
 
 static
 atf_error_t
-prepend_or_append(atf_dynstr_t *ad, const char *fmt, va_list ap,
-                  bool prepend)
+append_ap(atf_dynstr_t *ad, const char *fmt, va_list ap)
 {
-    char *aux;
     atf_error_t err;
-    size_t newlen;
+    size_t spare;
     va_list ap2;
+    int ret;
 
+    /* Try to format directly into the spare capacity first, and only
+     * grow and format again if the result did not fit. */
+    spare = ad->m_datasize - ad->m_length;
     va_copy(ap2, ap);
-    err = atf_text_format_ap(&aux, fmt, ap2);
+    ret = vsnprintf(buffer(ad) + ad->m_length, spare, fmt, ap2);
     va_end(ap2);
-    if (atf_is_error(err))
-        goto out;
-    newlen = ad->m_length + strlen(aux);
+    if (ret < 0)
+        goto err_format;
 
-    if (newlen + sizeof(char) > ad->m_datasize) {
-        err = resize(ad, newlen + sizeof(char));
+    if ((size_t)ret >= spare) {
+        if ((size_t)ret >= SIZE_MAX - ad->m_length) {
+            err = atf_no_memory_error();
+            goto err;
+        }
+
+        err = reserve(ad, ad->m_length + ret + 1);
         if (atf_is_error(err))
-            goto out_free;
+            goto err;
+
+        va_copy(ap2, ap);
+        ret = vsnprintf(ad->m_data + ad->m_length, ret + 1, fmt, ap2);
+        va_end(ap2);
+        if (ret < 0)
+            goto err_format;
     }
 
-    if (prepend) {
-        memmove(ad->m_data + strlen(aux), ad->m_data, ad->m_length + 1);
-        memcpy(ad->m_data, aux, strlen(aux));
-    } else
-        strcpy(ad->m_data + ad->m_length, aux);
-    ad->m_length = newlen;
-    err = atf_no_error();
-
-out_free:
-    free(aux);
-out:
+    ad->m_length += ret;
+    return atf_no_error();
+
+err_format:
+    err = atf_libc_error(errno, "Cannot format string");
+err:
+    buffer(ad)[ad->m_length] = '\0';
     return err;
 }
 
+static
+atf_error_t
+prepend_ap(atf_dynstr_t *ad, const char *fmt, va_list ap)
+{
+    atf_error_t err;
+    va_list ap2;
+    char *data, saved;
+    int ret;
+
+    va_copy(ap2, ap);
+    ret = vsnprintf(NULL, 0, fmt, ap2);
+    va_end(ap2);
+    if (ret < 0)
+        return atf_libc_error(errno, "Cannot format string");
+
+    if ((size_t)ret >= SIZE_MAX - ad->m_length)
+        return atf_no_memory_error();
+    err = reserve(ad, ad->m_length + ret + 1);
+    if (atf_is_error(err))
+        return err;
+
+    /* vsnprintf terminates its output, which would clobber the first
+     * character of the moved contents, so put it back afterwards. */
+    data = buffer(ad);
+    memmove(data + ret, data, ad->m_length + 1);
+    saved = data[ret];
+    va_copy(ap2, ap);
+    (void)vsnprintf(data, ret + 1, fmt, ap2);
+    va_end(ap2);
+    data[ret] = saved;
+    ad->m_length += ret;
+
+    return atf_no_error();
+}
+
 /* ---------------------------------------------------------------------
  * The "atf_dynstr" type.
  * --------------------------------------------------------------------- */
@@ -117,62 +184,29 @@ const size_t atf_dynstr_npos = SIZE_MAX;
 atf_error_t
 atf_dynstr_init(atf_dynstr_t *ad)
 {
-    atf_error_t err;
-
-    ad->m_data = (char *)malloc(sizeof(char));
-    if (ad->m_data == NULL) {
-        err = atf_no_memory_error();
-        goto out;
-    }
-
-    ad->m_data[0] = '\0';
-    ad->m_datasize = 1;
+    ad->m_data = NULL;
+    ad->m_datasize = sizeof(ad->m_inline);
     ad->m_length = 0;
-    err = atf_no_error();
+    ad->m_inline[0] = '\0';
 
-out:
-    return err;
+    return atf_no_error();
 }
 
 atf_error_t
 atf_dynstr_init_ap(atf_dynstr_t *ad, const char *fmt, va_list ap)
 {
     atf_error_t err;
+    va_list ap2;
 
-    ad->m_datasize = strlen(fmt) + 1;
-    ad->m_length = 0;
-
-    do {
-        va_list ap2;
-        int ret;
-
-        ad->m_datasize *= 2;
-        ad->m_data = (char *)malloc(ad->m_datasize);
-        if (ad->m_data == NULL) {
-            err = atf_no_memory_error();
-            goto out;
-        }
-
-        va_copy(ap2, ap);
-        ret = vsnprintf(ad->m_data, ad->m_datasize, fmt, ap2);
-        va_end(ap2);
-        if (ret < 0) {
-            free(ad->m_data);
-            err = atf_libc_error(errno, "Cannot format string");
-            goto out;
-        }
+    err = atf_dynstr_init(ad);
+    INV(!atf_is_error(err));
 
-        INV(ret >= 0);
-        if ((size_t)ret >= ad->m_datasize) {
-            free(ad->m_data);
-            ad->m_data = NULL;
-        }
-        ad->m_length = ret;
-    } while (ad->m_length >= ad->m_datasize);
+    va_copy(ap2, ap);
+    err = append_ap(ad, fmt, ap2);
+    va_end(ap2);
+    if (atf_is_error(err))
+        atf_dynstr_fini(ad);
 
-    err = atf_no_error();
-out:
-    POST(atf_is_error(err) || ad->m_data != NULL);
     return err;
 }
 
@@ -193,26 +227,23 @@ atf_error_t
 atf_dynstr_init_raw(atf_dynstr_t *ad, const void *mem, size_t memlen)
 {
     atf_error_t err;
+    const char *nul;
 
-    if (memlen >= SIZE_MAX - 1) {
-        err = atf_no_memory_error();
-        goto out;
-    }
+    if (memlen >= SIZE_MAX - 1)
+        return atf_no_memory_error();
 
-    ad->m_data = (char *)malloc(memlen + 1);
-    if (ad->m_data == NULL) {
-        err = atf_no_memory_error();
-        goto out;
-    }
+    /* The string ends at the first NUL character, if any. */
+    nul = memchr(mem, '\0', memlen);
+    if (nul != NULL)
+        memlen = nul - (const char *)mem;
 
-    ad->m_datasize = memlen + 1;
-    memcpy(ad->m_data, mem, memlen);
-    ad->m_data[memlen] = '\0';
-    ad->m_length = strlen(ad->m_data);
-    INV(ad->m_length <= memlen);
-    err = atf_no_error();
+    err = atf_dynstr_init(ad);
+    INV(!atf_is_error(err));
+
+    err = atf_dynstr_append_mem(ad, mem, memlen);
+    if (atf_is_error(err))
+        atf_dynstr_fini(ad);
 
-out:
     return err;
 }
 
@@ -221,25 +252,21 @@ atf_dynstr_init_rep(atf_dynstr_t *ad, size_t len, char ch)
 {
     atf_error_t err;
 
-    if (len == SIZE_MAX) {
-        err = atf_no_memory_error();
-        goto out;
-    }
+    if (len == SIZE_MAX)
+        return atf_no_memory_error();
 
-    ad->m_datasize = (len + 1) * sizeof(char);
-    ad->m_data = (char *)malloc(ad->m_datasize);
-    if (ad->m_data == NULL) {
-        err = atf_no_memory_error();
-        goto out;
-    }
+    err = atf_dynstr_init(ad);
+    INV(!atf_is_error(err));
+
+    err = reserve(ad, len + 1);
+    if (atf_is_error(err))
+        return err;
 
-    memset(ad->m_data, ch, len);
-    ad->m_data[len] = '\0';
+    memset(buffer(ad), ch, len);
+    buffer(ad)[len] = '\0';
     ad->m_length = len;
-    err = atf_no_error();
 
-out:
-    return err;
+    return atf_no_error();
 }
 
 atf_error_t
@@ -252,7 +279,7 @@ atf_dynstr_init_substr(atf_dynstr_t *ad, const atf_dynstr_t *src,
     if (end == atf_dynstr_npos || end > src->m_length)
         end = src->m_length;
 
-    return atf_dynstr_init_raw(ad, src->m_data + beg, end - beg);
+    return atf_dynstr_init_raw(ad, buffer_c(src) + beg, end - beg);
 }
 
 atf_error_t
@@ -260,15 +287,12 @@ atf_dynstr_copy(atf_dynstr_t *dest, const atf_dynstr_t *src)
 {
     atf_error_t err;
 
-    dest->m_data = (char *)malloc(src->m_datasize);
-    if (dest->m_data == NULL)
-        err = atf_no_memory_error();
-    else {
-        memcpy(dest->m_data, src->m_data, src->m_datasize);
-        dest->m_datasize = src->m_datasize;
-        dest->m_length = src->m_length;
-        err = atf_no_error();
-    }
+    err = atf_dynstr_init(dest);
+    INV(!atf_is_error(err));
+
+    err = atf_dynstr_append_mem(dest, buffer_c(src), src->m_length);
+    if (atf_is_error(err))
+        atf_dynstr_fini(dest);
 
     return err;
 }
@@ -276,15 +300,25 @@ atf_dynstr_copy(atf_dynstr_t *dest, const atf_dynstr_t *src)
 void
 atf_dynstr_fini(atf_dynstr_t *ad)
 {
-    INV(ad->m_data != NULL);
     free(ad->m_data);
 }
 
+/*
+ * Returns the contents as a string allocated with malloc(3), or NULL if
+ * they were stored inline and there is no memory left to copy them.
+ */
 char *
 atf_dynstr_fini_disown(atf_dynstr_t *ad)
 {
-    INV(ad->m_data != NULL);
-    return ad->m_data;
+    char *str;
+
+    if (ad->m_data != NULL)
+        return ad->m_data;
+
+    str = (char *)malloc(ad->m_length + 1);
+    if (str != NULL)
+        memcpy(str, ad->m_inline, ad->m_length + 1);
+    return str;
 }
 
 /*
@@ -294,7 +328,7 @@ atf_dynstr_fini_disown(atf_dynstr_t *ad)
 const char *
 atf_dynstr_cstring(const atf_dynstr_t *ad)
 {
-    return ad->m_data;
+    return buffer_c(ad);
 }
 
 size_t
@@ -306,9 +340,10 @@ atf_dynstr_length(const atf_dynstr_t *ad)
 size_t
 atf_dynstr_rfind_ch(const atf_dynstr_t *ad, char ch)
 {
+    const char *data = buffer_c(ad);
     size_t pos;
 
-    for (pos = ad->m_length; pos > 0 && ad->m_data[pos - 1] != ch; pos--)
+    for (pos = ad->m_length; pos > 0 && data[pos - 1] != ch; pos--)
         ;
 
     return pos == 0 ? atf_dynstr_npos : pos - 1;
@@ -325,7 +360,7 @@ atf_dynstr_append_ap(atf_dynstr_t *ad, const char *fmt, va_list ap)
     va_list ap2;
 
     va_copy(ap2, ap);
-    err = prepend_or_append(ad, fmt, ap2, false);
+    err = append_ap(ad, fmt, ap2);
     va_end(ap2);
 
     return err;
@@ -338,16 +373,41 @@ atf_dynstr_append_fmt(atf_dynstr_t *ad, const char *fmt, ...)
     atf_error_t err;
 
     va_start(ap, fmt);
-    err = prepend_or_append(ad, fmt, ap, false);
+    err = append_ap(ad, fmt, ap);
     va_end(ap);
 
     return err;
 }
 
+/*
+ * Appends len bytes of mem, which must not contain any NUL characters,
+ * without going through a format string.
+ */
+atf_error_t
+atf_dynstr_append_mem(atf_dynstr_t *ad, const void *mem, size_t len)
+{
+    atf_error_t err;
+    char *data;
+
+    if (len >= SIZE_MAX - ad->m_length)
+        return atf_no_memory_error();
+
+    err = reserve(ad, ad->m_length + len + 1);
+    if (atf_is_error(err))
+        return err;
+
+    data = buffer(ad);
+    memcpy(data + ad->m_length, mem, len);
+    ad->m_length += len;
+    data[ad->m_length] = '\0';
+
+    return atf_no_error();
+}
+
 void
 atf_dynstr_clear(atf_dynstr_t *ad)
 {
-    ad->m_data[0] = '\0';
+    buffer(ad)[0] = '\0';
     ad->m_length = 0;
 }
 
@@ -358,7 +418,7 @@ atf_dynstr_prepend_ap(atf_dynstr_t *ad, const char *fmt, va_list ap)
     va_list ap2;
 
     va_copy(ap2, ap);
-    err = prepend_or_append(ad, fmt, ap2, true);
+    err = prepend_ap(ad, fmt, ap2);
     va_end(ap2);
 
     return err;
@@ -371,7 +431,7 @@ atf_dynstr_prepend_fmt(atf_dynstr_t *ad, const char *fmt, ...)
     atf_error_t err;
 
     va_start(ap, fmt);
-    err = prepend_or_append(ad, fmt, ap, true);
+    err = prepend_ap(ad, fmt, ap);
     va_end(ap);
 
     return err;
@@ -384,11 +444,12 @@ atf_dynstr_prepend_fmt(atf_dynstr_t *ad, const char *fmt, ...)
 bool
 atf_equal_dynstr_cstring(const atf_dynstr_t *ad, const char *str)
 {
-    return strcmp(ad->m_data, str) == 0;
+    return strcmp(buffer_c(ad), str) == 0;
 }
 
 bool
 atf_equal_dynstr_dynstr(const atf_dynstr_t *s1, const atf_dynstr_t *s2)
 {
-    return strcmp(s1->m_data, s2->m_data) == 0;
+    return s1->m_length == s2->m_length &&
+           memcmp(buffer_c(s1), buffer_c(s2), s1->m_length) == 0;
 }
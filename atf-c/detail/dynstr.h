@@ -36,10 +36,16 @@
  * The "atf_dynstr" type.
  * --------------------------------------------------------------------- */
 
+/* Short strings live in m_inline and only move to the heap, pointed to by
+ * m_data, once they outgrow it.  m_data is NULL while the inline buffer is
+ * in use so that the structure can be copied around by value. */
+#define ATF_DYNSTR_INLINE_SIZE 40
+
 struct atf_dynstr {
     char *m_data;
     size_t m_datasize;
     size_t m_length;
+    char m_inline[ATF_DYNSTR_INLINE_SIZE];
 };
 typedef struct atf_dynstr atf_dynstr_t;
 
@@ -66,6 +72,7 @@ size_t atf_dynstr_rfind_ch(const atf_dynstr_t *, char);
 /* Modifiers */
 atf_error_t atf_dynstr_append_ap(atf_dynstr_t *, const char *, va_list);
 atf_error_t atf_dynstr_append_fmt(atf_dynstr_t *, const char *, ...);
+atf_error_t atf_dynstr_append_mem(atf_dynstr_t *, const void *, size_t);
 void atf_dynstr_clear(atf_dynstr_t *);
 atf_error_t atf_dynstr_prepend_ap(atf_dynstr_t *, const char *, va_list);
 atf_error_t atf_dynstr_prepend_fmt(atf_dynstr_t *, const char *, ...);
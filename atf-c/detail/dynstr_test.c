@@ -285,7 +285,15 @@ ATF_TC_BODY(fini_disown, tc)
     char *cstr2;
     atf_dynstr_t str;
 
+    /* Short strings are stored inline, so they have to be copied. */
     RE(atf_dynstr_init_fmt(&str, "Test string 1"));
+    cstr2 = atf_dynstr_fini_disown(&str);
+    ATF_REQUIRE(cstr2 != NULL);
+    ATF_REQUIRE_STREQ(cstr2, "Test string 1");
+    free(cstr2);
+
+    /* Long strings hand over their buffer. */
+    RE(atf_dynstr_init_rep(&str, ATF_DYNSTR_INLINE_SIZE * 2, 'a'));
     cstr = atf_dynstr_cstring(&str);
     cstr2 = atf_dynstr_fini_disown(&str);
 
@@ -441,6 +449,38 @@ ATF_TC_BODY(append_fmt, tc)
     check_append(atf_dynstr_append_fmt);
 }
 
+ATF_TC(append_mem);
+ATF_TC_HEAD(append_mem, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that appending raw memory to "
+                      "a string works");
+}
+ATF_TC_BODY(append_mem, tc)
+{
+    char buf[1024];
+    atf_dynstr_t str;
+    size_t i;
+
+    RE(atf_dynstr_init(&str));
+    buf[0] = '\0';
+    for (i = 0; i < sizeof(buf) - 1; i++) {
+        ATF_REQUIRE_STREQ(atf_dynstr_cstring(&str), buf);
+        ATF_REQUIRE_EQ(atf_dynstr_length(&str), i);
+
+        RE(atf_dynstr_append_mem(&str, "abc" + (i % 3), 1));
+        buf[i] = "abc"[i % 3];
+        buf[i + 1] = '\0';
+    }
+
+    /* Only the given bytes are appended, not up to a terminator. */
+    atf_dynstr_clear(&str);
+    RE(atf_dynstr_append_mem(&str, "foobar", 3));
+    ATF_REQUIRE_STREQ(atf_dynstr_cstring(&str), "foo");
+    ATF_REQUIRE_EQ(atf_dynstr_length(&str), 3);
+
+    atf_dynstr_fini(&str);
+}
+
 ATF_TC(clear);
 ATF_TC_HEAD(clear, tc)
 {
@@ -622,6 +662,7 @@ ATF_TP_ADD_TCS(tp)
     /* Modifiers. */
     ATF_TP_ADD_TC(tp, append_ap);
     ATF_TP_ADD_TC(tp, append_fmt);
+    ATF_TP_ADD_TC(tp, append_mem);
     ATF_TP_ADD_TC(tp, clear);
     ATF_TP_ADD_TC(tp, prepend_ap);
     ATF_TP_ADD_TC(tp, prepend_fmt);
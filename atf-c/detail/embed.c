@@ -0,0 +1,558 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/embed.h"
+
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atf-c/detail/env.h"
+#include "atf-c/detail/fs.h"
+#include "atf-c/detail/process.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* The note holding the list: its name is NOTE_NAME, including the
+ * terminating nul byte, and its descriptor is the list itself. */
+#define NOTE_NAME "ATF"
+#define NOTE_TYPE 1
+
+/* Sections larger than this cannot hold a sensible list and are ignored,
+ * which also protects us from reading huge amounts of data out of a
+ * corrupted file. */
+#define MAX_SECTION_SIZE (16 * 1024 * 1024)
+
+struct elf {
+    int m_fd;
+    const char *m_path;
+    bool m_is64;
+    bool m_big;
+};
+
+static
+uint64_t
+get_uint(const unsigned char *p, const size_t size, const bool big)
+{
+    uint64_t value = 0;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        value = (value << 8) | p[big ? i : size - 1 - i];
+    return value;
+}
+
+static
+void
+put_uint32(unsigned char *p, const uint32_t value, const bool big)
+{
+    size_t i;
+
+    for (i = 0; i < 4; i++)
+        p[big ? 3 - i : i] = (value >> (i * 8)) & 0xff;
+}
+
+static
+size_t
+align4(const size_t size)
+{
+    return (size + 3) & ~(size_t)3;
+}
+
+/*
+ * Reads len bytes at offset off.  Sets complete to false if the file is
+ * too short, which is not an error: the caller treats such a file as not
+ * carrying a list.
+ */
+static
+atf_error_t
+read_at(const struct elf *e, const uint64_t off, void *buf, const size_t len,
+        bool *complete)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        const ssize_t cnt = pread(e->m_fd, (char *)buf + done, len - done,
+                                  (off_t)(off + done));
+        if (cnt == -1) {
+            if (errno == EINTR)
+                continue;
+            return atf_libc_error(errno, "Cannot read %s", e->m_path);
+        } else if (cnt == 0) {
+            *complete = false;
+            return atf_no_error();
+        }
+        done += cnt;
+    }
+    *complete = true;
+    return atf_no_error();
+}
+
+/*
+ * Checks whether the file is an ELF object and, if so, records its class
+ * and byte order.
+ */
+static
+atf_error_t
+probe_elf(struct elf *e, bool *is_elf)
+{
+    atf_error_t err;
+    unsigned char ident[16];
+
+    err = read_at(e, 0, ident, sizeof(ident), is_elf);
+    if (atf_is_error(err) || !*is_elf)
+        return err;
+
+    *is_elf = memcmp(ident, "\177ELF", 4) == 0 &&
+        (ident[4] == 1 || ident[4] == 2) && (ident[5] == 1 || ident[5] == 2);
+    e->m_is64 = ident[4] == 2;
+    e->m_big = ident[5] == 2;
+    return atf_no_error();
+}
+
+/*
+ * Reads the contents of a whole section into a newly-allocated buffer.
+ * buf is left as NULL if the section does not fit in the file.
+ */
+static
+atf_error_t
+read_section(const struct elf *e, const uint64_t off, const uint64_t size,
+             unsigned char **buf)
+{
+    atf_error_t err;
+    bool complete;
+
+    *buf = NULL;
+    if (size > MAX_SECTION_SIZE)
+        return atf_no_error();
+
+    *buf = malloc(size + 1);
+    if (*buf == NULL)
+        return atf_no_memory_error();
+
+    err = read_at(e, off, *buf, size, &complete);
+    if (atf_is_error(err) || !complete) {
+        free(*buf);
+        *buf = NULL;
+    } else
+        (*buf)[size] = '\0';
+    return err;
+}
+
+/*
+ * Looks for a section by name using the section header table.  Leaves
+ * contents as NULL if there is no such section.
+ */
+static
+atf_error_t
+find_section(const struct elf *e, const char *name, unsigned char **contents,
+             size_t *size)
+{
+    atf_error_t err;
+    unsigned char hdr[64], *shdrs, *names;
+    uint64_t shoff, shentsize, shnum, shstrndx, names_size, i;
+    size_t min_entsize;
+    bool complete;
+
+    *contents = NULL;
+    *size = 0;
+
+    err = read_at(e, 0, hdr, e->m_is64 ? 64 : 52, &complete);
+    if (atf_is_error(err) || !complete)
+        return err;
+
+    if (e->m_is64) {
+        shoff = get_uint(hdr + 0x28, 8, e->m_big);
+        shentsize = get_uint(hdr + 0x3a, 2, e->m_big);
+        shnum = get_uint(hdr + 0x3c, 2, e->m_big);
+        shstrndx = get_uint(hdr + 0x3e, 2, e->m_big);
+        min_entsize = 64;
+    } else {
+        shoff = get_uint(hdr + 0x20, 4, e->m_big);
+        shentsize = get_uint(hdr + 0x2e, 2, e->m_big);
+        shnum = get_uint(hdr + 0x30, 2, e->m_big);
+        shstrndx = get_uint(hdr + 0x32, 2, e->m_big);
+        min_entsize = 40;
+    }
+    if (shoff == 0 || shnum == 0 || shentsize < min_entsize ||
+        shstrndx >= shnum)
+        return atf_no_error();
+
+    err = read_section(e, shoff, shnum * shentsize, &shdrs);
+    if (atf_is_error(err) || shdrs == NULL)
+        return err;
+
+#define SH_FIELD(i, off32, off64, size32, size64) \
+    get_uint(shdrs + (i) * shentsize + (e->m_is64 ? (off64) : (off32)), \
+             e->m_is64 ? (size64) : (size32), e->m_big)
+#define SH_NAME(i) SH_FIELD(i, 0x00, 0x00, 4, 4)
+#define SH_OFFSET(i) SH_FIELD(i, 0x10, 0x18, 4, 8)
+#define SH_SIZE(i) SH_FIELD(i, 0x14, 0x20, 4, 8)
+
+    names_size = SH_SIZE(shstrndx);
+    err = read_section(e, SH_OFFSET(shstrndx), names_size, &names);
+    if (atf_is_error(err) || names == NULL)
+        goto out_shdrs;
+
+    for (i = 0; i < shnum; i++) {
+        if (SH_NAME(i) >= names_size ||
+            strcmp((const char *)names + SH_NAME(i), name) != 0)
+            continue;
+
+        err = read_section(e, SH_OFFSET(i), SH_SIZE(i), contents);
+        if (!atf_is_error(err) && *contents != NULL)
+            *size = SH_SIZE(i);
+        break;
+    }
+
+#undef SH_SIZE
+#undef SH_OFFSET
+#undef SH_NAME
+#undef SH_FIELD
+
+    free(names);
+out_shdrs:
+    free(shdrs);
+    return err;
+}
+
+/*
+ * Extracts the list from the notes of a section.
+ */
+static
+atf_error_t
+parse_notes(const struct elf *e, const unsigned char *notes, const size_t size,
+            atf_dynstr_t *list, bool *found)
+{
+    size_t pos = 0;
+
+    while (size - pos >= 12) {
+        const size_t namesz = get_uint(notes + pos, 4, e->m_big);
+        const size_t descsz = get_uint(notes + pos + 4, 4, e->m_big);
+        const uint64_t type = get_uint(notes + pos + 8, 4, e->m_big);
+        const size_t desc = pos + 12 + align4(namesz);
+
+        if (namesz > size || descsz > size || desc > size ||
+            descsz > size - desc)
+            break;
+
+        if (type == NOTE_TYPE && namesz == sizeof(NOTE_NAME) &&
+            memcmp(notes + pos + 12, NOTE_NAME, namesz) == 0) {
+            *found = true;
+            return atf_dynstr_append_mem(list, notes + desc, descsz);
+        }
+        pos = desc + align4(descsz);
+    }
+    return atf_no_error();
+}
+
+static
+atf_error_t
+read_note(const char *program, atf_dynstr_t *list, bool *found)
+{
+    atf_error_t err;
+    struct elf e;
+    unsigned char *notes;
+    size_t size;
+    bool is_elf;
+
+    e.m_path = program;
+    e.m_fd = open(program, O_RDONLY | O_CLOEXEC);
+    if (e.m_fd == -1)
+        return atf_libc_error(errno, "Cannot open %s", program);
+
+    err = probe_elf(&e, &is_elf);
+    if (atf_is_error(err) || !is_elf)
+        goto out;
+
+    err = find_section(&e, ATF_EMBED_SECTION, &notes, &size);
+    if (atf_is_error(err) || notes == NULL)
+        goto out;
+
+    err = parse_notes(&e, notes, size, list, found);
+    free(notes);
+out:
+    close(e.m_fd);
+    return err;
+}
+
+/*
+ * Reads the sidecar file of a program, unless it is older than the
+ * program: the list would then most likely be stale.
+ */
+static
+atf_error_t
+read_sidecar(const char *program, atf_dynstr_t *list, bool *found)
+{
+    atf_error_t err;
+    struct stat program_sb, sidecar_sb;
+    atf_fs_path_t sidecar;
+    char buf[4096];
+    size_t cnt;
+    FILE *f;
+
+    err = atf_fs_path_init_fmt(&sidecar, "%s%s", program,
+                               ATF_EMBED_SIDECAR_SUFFIX);
+    if (atf_is_error(err))
+        goto out;
+
+    f = fopen(atf_fs_path_cstring(&sidecar), "r");
+    if (f == NULL) {
+        if (errno != ENOENT)
+            err = atf_libc_error(errno, "Cannot open %s",
+                                 atf_fs_path_cstring(&sidecar));
+        goto out_sidecar;
+    }
+
+    if (stat(program, &program_sb) == -1 ||
+        fstat(fileno(f), &sidecar_sb) == -1) {
+        err = atf_libc_error(errno, "Cannot stat %s", program);
+        goto out_f;
+    }
+    if (sidecar_sb.st_mtime < program_sb.st_mtime)
+        goto out_f;
+
+    while (!atf_is_error(err) && (cnt = fread(buf, 1, sizeof(buf), f)) > 0)
+        err = atf_dynstr_append_mem(list, buf, cnt);
+    if (!atf_is_error(err)) {
+        if (ferror(f))
+            err = atf_libc_error(errno, "Cannot read %s",
+                                 atf_fs_path_cstring(&sidecar));
+        else
+            *found = true;
+    }
+
+out_f:
+    fclose(f);
+out_sidecar:
+    atf_fs_path_fini(&sidecar);
+out:
+    return err;
+}
+
+/*
+ * Creates a temporary file next to path, named after it, and writes data
+ * to it.  The caller must remove or rename the file.
+ */
+static
+atf_error_t
+write_temp(const char *path, const void *data, const size_t len,
+           atf_fs_path_t *temp)
+{
+    atf_error_t err;
+    size_t done = 0;
+    int fd;
+
+    err = atf_fs_path_init_fmt(temp, "%s.XXXXXX", path);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_fs_mkstemp(temp, &fd);
+    if (atf_is_error(err)) {
+        atf_fs_path_fini(temp);
+        return err;
+    }
+    (void)fchmod(fd, 0644);
+
+    while (!atf_is_error(err) && done < len) {
+        const ssize_t cnt = write(fd, (const char *)data + done, len - done);
+        if (cnt == -1) {
+            if (errno != EINTR)
+                err = atf_libc_error(errno, "Cannot write to %s",
+                                     atf_fs_path_cstring(temp));
+        } else
+            done += cnt;
+    }
+    if (close(fd) == -1 && !atf_is_error(err))
+        err = atf_libc_error(errno, "Cannot write to %s",
+                             atf_fs_path_cstring(temp));
+
+    if (atf_is_error(err)) {
+        (void)unlink(atf_fs_path_cstring(temp));
+        atf_fs_path_fini(temp);
+    }
+    return err;
+}
+
+static
+atf_error_t
+write_sidecar(const char *program, const char *list)
+{
+    atf_error_t err;
+    atf_fs_path_t sidecar, temp;
+
+    err = atf_fs_path_init_fmt(&sidecar, "%s%s", program,
+                               ATF_EMBED_SIDECAR_SUFFIX);
+    if (atf_is_error(err))
+        return err;
+
+    err = write_temp(atf_fs_path_cstring(&sidecar), list, strlen(list),
+                     &temp);
+    if (atf_is_error(err))
+        goto out_sidecar;
+
+    if (rename(atf_fs_path_cstring(&temp), atf_fs_path_cstring(&sidecar))
+        == -1) {
+        err = atf_libc_error(errno, "Cannot replace %s",
+                             atf_fs_path_cstring(&sidecar));
+        (void)unlink(atf_fs_path_cstring(&temp));
+    }
+    atf_fs_path_fini(&temp);
+out_sidecar:
+    atf_fs_path_fini(&sidecar);
+    return err;
+}
+
+/*
+ * Replaces the note section of an ELF program with one holding the given
+ * list.  The section is added with objcopy(1), or with the program named
+ * by the OBJCOPY environment variable.
+ */
+static
+atf_error_t
+write_note(const char *program, const char *list, const bool big)
+{
+    atf_error_t err;
+    const size_t len = strlen(list);
+    const size_t size = 12 + align4(sizeof(NOTE_NAME)) + align4(len);
+    unsigned char *note;
+    atf_fs_path_t temp, objcopy;
+    atf_dynstr_t add;
+    atf_process_status_t status;
+
+    note = calloc(1, size);
+    if (note == NULL)
+        return atf_no_memory_error();
+    put_uint32(note, sizeof(NOTE_NAME), big);
+    put_uint32(note + 4, len, big);
+    put_uint32(note + 8, NOTE_TYPE, big);
+    memcpy(note + 12, NOTE_NAME, sizeof(NOTE_NAME));
+    memcpy(note + 12 + align4(sizeof(NOTE_NAME)), list, len);
+
+    err = write_temp(program, note, size, &temp);
+    free(note);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_dynstr_init_fmt(&add, "%s=%s", ATF_EMBED_SECTION,
+                              atf_fs_path_cstring(&temp));
+    if (atf_is_error(err))
+        goto out_temp;
+
+    err = atf_fs_path_init_fmt(&objcopy, "%s", atf_env_has("OBJCOPY") ?
+                               atf_env_get("OBJCOPY") : "objcopy");
+    if (atf_is_error(err))
+        goto out_add;
+
+    {
+        const char *argv[] = {
+            atf_fs_path_cstring(&objcopy),
+            "--remove-section=" ATF_EMBED_SECTION,
+            "--add-section", atf_dynstr_cstring(&add),
+            program,
+            NULL
+        };
+
+        err = atf_process_exec_array(&status, &objcopy, argv, NULL, NULL,
+                                     NULL);
+    }
+    if (atf_is_error(err))
+        goto out_objcopy;
+
+    if (!atf_process_status_exited(&status) ||
+        atf_process_status_exitstatus(&status) != EXIT_SUCCESS)
+        err = atf_libc_error(EIO, "%s failed to add the test case list "
+                             "to %s", atf_fs_path_cstring(&objcopy),
+                             program);
+    atf_process_status_fini(&status);
+
+out_objcopy:
+    atf_fs_path_fini(&objcopy);
+out_add:
+    atf_dynstr_fini(&add);
+out_temp:
+    (void)unlink(atf_fs_path_cstring(&temp));
+    atf_fs_path_fini(&temp);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Appends the precomputed list of test cases of a program to list.  found
+ * is set to false if the program carries no list, in which case the caller
+ * has to fall back to running the program with -l.
+ */
+atf_error_t
+atf_embed_read(const char *program, atf_dynstr_t *list, bool *found)
+{
+    atf_error_t err;
+
+    *found = false;
+
+    err = read_note(program, list, found);
+    if (!atf_is_error(err) && !*found)
+        err = read_sidecar(program, list, found);
+
+    return err;
+}
+
+/*
+ * Stores the list of test cases of a program so that atf_embed_read can
+ * later return it.  The list must be the verbatim output of -l.
+ */
+atf_error_t
+atf_embed_write(const char *program, const char *list)
+{
+    atf_error_t err;
+    struct elf e;
+    bool is_elf;
+
+    e.m_path = program;
+    e.m_fd = open(program, O_RDONLY | O_CLOEXEC);
+    if (e.m_fd == -1)
+        return atf_libc_error(errno, "Cannot open %s", program);
+    err = probe_elf(&e, &is_elf);
+    close(e.m_fd);
+    if (atf_is_error(err))
+        return err;
+
+    if (is_elf)
+        return write_note(program, list, e.m_big);
+    else
+        return write_sidecar(program, list);
+}
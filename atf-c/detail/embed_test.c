@@ -0,0 +1,281 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/embed.h"
+
+#include <sys/time.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+#define LIST "Content-Type: application/X-atf-tp; version=\"1\"\n\n" \
+    "ident: first\n\nident: second\ndescr: Second test case\n"
+
+static
+void
+put(unsigned char *p, const uint64_t value, const size_t size, const bool big)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        p[big ? size - 1 - i : i] = (value >> (i * 8)) & 0xff;
+}
+
+/*
+ * Creates a minimal ELF file whose only sections are the section name
+ * table and a section holding a single note.
+ */
+static
+void
+create_elf(const char *path, const bool is64, const bool big,
+           const char *section, const char *name, const uint32_t type,
+           const char *desc)
+{
+    unsigned char buf[4096];
+    const size_t ehsize = is64 ? 64 : 52, shentsize = is64 ? 64 : 40;
+    const size_t namesz = strlen(name) + 1, descsz = strlen(desc);
+    size_t note, notesz, names, namessz, shoff, i;
+    FILE *f;
+
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, "\177ELF", 4);
+    buf[4] = is64 ? 2 : 1;
+    buf[5] = big ? 2 : 1;
+    buf[6] = 1;
+
+    note = ehsize;
+    put(buf + note, namesz, 4, big);
+    put(buf + note + 4, descsz, 4, big);
+    put(buf + note + 8, type, 4, big);
+    memcpy(buf + note + 12, name, namesz);
+    memcpy(buf + note + 12 + ((namesz + 3) & ~3), desc, descsz);
+    notesz = 12 + ((namesz + 3) & ~3) + ((descsz + 3) & ~3);
+
+    names = note + notesz;
+    namessz = 1 + snprintf((char *)buf + names + 1, 256, "%s%c.shstrtab",
+                           section, '\0') + 1;
+    shoff = (names + namessz + 7) & ~7;
+    ATF_REQUIRE(shoff + 3 * shentsize <= sizeof(buf));
+
+    put(buf + (is64 ? 0x28 : 0x20), shoff, is64 ? 8 : 4, big);
+    put(buf + (is64 ? 0x3a : 0x2e), shentsize, 2, big);
+    put(buf + (is64 ? 0x3c : 0x30), 3, 2, big);
+    put(buf + (is64 ? 0x3e : 0x32), 2, 2, big);
+
+    for (i = 1; i < 3; i++) {
+        unsigned char *sh = buf + shoff + i * shentsize;
+        const size_t name_off = i == 1 ? 1 : 1 + strlen(section) + 1;
+        const size_t off = i == 1 ? note : names;
+        const size_t size = i == 1 ? notesz : namessz;
+
+        put(sh, name_off, 4, big);
+        put(sh + 4, i == 1 ? 7 : 3, 4, big);
+        put(sh + (is64 ? 0x18 : 0x10), off, is64 ? 8 : 4, big);
+        put(sh + (is64 ? 0x20 : 0x14), size, is64 ? 8 : 4, big);
+    }
+
+    ATF_REQUIRE((f = fopen(path, "wb")) != NULL);
+    ATF_REQUIRE_EQ(1, fwrite(buf, shoff + 3 * shentsize, 1, f));
+    ATF_REQUIRE(fclose(f) == 0);
+}
+
+static
+bool
+read_list(const char *program, atf_dynstr_t *list)
+{
+    bool found;
+
+    RE(atf_dynstr_init(list));
+    RE(atf_embed_read(program, list, &found));
+    if (!found)
+        atf_dynstr_fini(list);
+    return found;
+}
+
+static
+void
+check_elf(const bool is64, const bool big)
+{
+    atf_dynstr_t list;
+
+    create_elf("program", is64, big, ATF_EMBED_SECTION, "ATF", 1, LIST);
+    ATF_REQUIRE(read_list("program", &list));
+    ATF_CHECK_STREQ(LIST, atf_dynstr_cstring(&list));
+    atf_dynstr_fini(&list);
+}
+
+/* ---------------------------------------------------------------------
+ * Test cases.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(read_elf32_big);
+ATF_TC_BODY(read_elf32_big, tc)
+{
+    check_elf(false, true);
+}
+
+ATF_TC_WITHOUT_HEAD(read_elf32_little);
+ATF_TC_BODY(read_elf32_little, tc)
+{
+    check_elf(false, false);
+}
+
+ATF_TC_WITHOUT_HEAD(read_elf64_big);
+ATF_TC_BODY(read_elf64_big, tc)
+{
+    check_elf(true, true);
+}
+
+ATF_TC_WITHOUT_HEAD(read_elf64_little);
+ATF_TC_BODY(read_elf64_little, tc)
+{
+    check_elf(true, false);
+}
+
+ATF_TC_WITHOUT_HEAD(read_elf_other_notes);
+ATF_TC_BODY(read_elf_other_notes, tc)
+{
+    atf_dynstr_t list;
+
+    create_elf("program", true, false, ".note.other", "ATF", 1, LIST);
+    ATF_CHECK(!read_list("program", &list));
+
+    create_elf("program", true, false, ATF_EMBED_SECTION, "GNU", 1, LIST);
+    ATF_CHECK(!read_list("program", &list));
+
+    create_elf("program", true, false, ATF_EMBED_SECTION, "ATF", 2, LIST);
+    ATF_CHECK(!read_list("program", &list));
+}
+
+ATF_TC_WITHOUT_HEAD(read_elf_truncated);
+ATF_TC_BODY(read_elf_truncated, tc)
+{
+    atf_dynstr_t list;
+
+    create_elf("program", true, false, ATF_EMBED_SECTION, "ATF", 1, LIST);
+    ATF_REQUIRE(truncate("program", 100) != -1);
+    ATF_CHECK(!read_list("program", &list));
+}
+
+ATF_TC_WITHOUT_HEAD(read_missing);
+ATF_TC_BODY(read_missing, tc)
+{
+    atf_dynstr_t list;
+    atf_error_t err;
+    bool found;
+
+    RE(atf_dynstr_init(&list));
+    err = atf_embed_read("missing", &list, &found);
+    ATF_REQUIRE(atf_is_error(err));
+    atf_error_free(err);
+    atf_dynstr_fini(&list);
+}
+
+ATF_TC_WITHOUT_HEAD(read_none);
+ATF_TC_BODY(read_none, tc)
+{
+    atf_dynstr_t list;
+
+    atf_utils_create_file("program", "#! /bin/sh\n");
+    ATF_CHECK(!read_list("program", &list));
+}
+
+ATF_TC_WITHOUT_HEAD(sidecar);
+ATF_TC_BODY(sidecar, tc)
+{
+    atf_dynstr_t list;
+
+    atf_utils_create_file("program", "#! /bin/sh\n");
+    RE(atf_embed_write("program", LIST));
+    ATF_REQUIRE(atf_utils_compare_file("program" ATF_EMBED_SIDECAR_SUFFIX,
+                                       LIST));
+
+    ATF_REQUIRE(read_list("program", &list));
+    ATF_CHECK_STREQ(LIST, atf_dynstr_cstring(&list));
+    atf_dynstr_fini(&list);
+}
+
+ATF_TC_WITHOUT_HEAD(sidecar_stale);
+ATF_TC_BODY(sidecar_stale, tc)
+{
+    struct timeval times[2];
+    atf_dynstr_t list;
+
+    atf_utils_create_file("program", "#! /bin/sh\n");
+    RE(atf_embed_write("program", LIST));
+
+    ATF_REQUIRE(gettimeofday(&times[0], NULL) != -1);
+    times[0].tv_sec += 60;
+    times[1] = times[0];
+    ATF_REQUIRE(utimes("program", times) != -1);
+
+    ATF_CHECK(!read_list("program", &list));
+}
+
+ATF_TC_WITHOUT_HEAD(write_objcopy_error);
+ATF_TC_BODY(write_objcopy_error, tc)
+{
+    atf_error_t err;
+
+    create_elf("program", true, false, ".note.other", "ATF", 1, LIST);
+    ATF_REQUIRE(setenv("OBJCOPY", "false", 1) != -1);
+
+    err = atf_embed_write("program", LIST);
+    ATF_REQUIRE(atf_is_error(err));
+    ATF_CHECK(atf_error_is(err, "libc"));
+    atf_error_free(err);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, read_elf32_big);
+    ATF_TP_ADD_TC(tp, read_elf32_little);
+    ATF_TP_ADD_TC(tp, read_elf64_big);
+    ATF_TP_ADD_TC(tp, read_elf64_little);
+    ATF_TP_ADD_TC(tp, read_elf_other_notes);
+    ATF_TP_ADD_TC(tp, read_elf_truncated);
+    ATF_TP_ADD_TC(tp, read_missing);
+    ATF_TP_ADD_TC(tp, read_none);
+    ATF_TP_ADD_TC(tp, sidecar);
+    ATF_TP_ADD_TC(tp, sidecar_stale);
+    ATF_TP_ADD_TC(tp, write_objcopy_error);
+
+    return atf_no_error();
+}
@@ -0,0 +1,246 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/filter.h"
+
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <regex.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+enum pred_type {
+    PRED_NAME_GLOB,
+    PRED_NAME_REGEX,
+    PRED_PROPERTY,
+};
+
+struct pred {
+    enum pred_type m_type;
+    bool m_negated;
+    char *m_property;
+    char *m_pattern;
+    regex_t m_regex;
+};
+
+static
+void
+pred_free(struct pred *pred)
+{
+    if (pred->m_type == PRED_NAME_REGEX)
+        regfree(&pred->m_regex);
+    free(pred->m_property);
+    free(pred->m_pattern);
+}
+
+static
+atf_error_t
+pred_parse(const char *expr, struct pred *pred)
+{
+    const char *orig = expr;
+    const char *equal;
+    size_t len;
+
+    pred->m_negated = false;
+    pred->m_property = NULL;
+    pred->m_pattern = NULL;
+
+    if (expr[0] == '!') {
+        pred->m_negated = true;
+        expr++;
+    }
+
+    len = strlen(expr);
+    equal = strchr(expr, '=');
+    if (len == 0) {
+        return atf_libc_error(EINVAL, "Empty filter `%s'", orig);
+    } else if (len >= 2 && expr[0] == '/' && expr[len - 1] == '/') {
+        int ret;
+
+        pred->m_type = PRED_NAME_REGEX;
+        pred->m_pattern = strndup(expr + 1, len - 2);
+        if (pred->m_pattern == NULL)
+            return atf_no_memory_error();
+        ret = regcomp(&pred->m_regex, pred->m_pattern,
+                      REG_EXTENDED | REG_NOSUB);
+        if (ret != 0) {
+            free(pred->m_pattern);
+            return atf_libc_error(EINVAL, "Invalid regular expression in "
+                                  "filter `%s'", orig);
+        }
+    } else if (equal != NULL) {
+        if (equal == expr)
+            return atf_libc_error(EINVAL, "Missing property name in filter "
+                                  "`%s'", orig);
+
+        pred->m_type = PRED_PROPERTY;
+        pred->m_property = strndup(expr, equal - expr);
+        pred->m_pattern = strdup(equal + 1);
+        if (pred->m_property == NULL || pred->m_pattern == NULL) {
+            free(pred->m_property);
+            free(pred->m_pattern);
+            return atf_no_memory_error();
+        }
+    } else {
+        pred->m_type = PRED_NAME_GLOB;
+        pred->m_pattern = strdup(expr);
+        if (pred->m_pattern == NULL)
+            return atf_no_memory_error();
+    }
+
+    return atf_no_error();
+}
+
+static
+bool
+pred_matches(const struct pred *pred, const char *name,
+             atf_filter_lookup_t lookup, const void *data)
+{
+    bool matches;
+
+    switch (pred->m_type) {
+    case PRED_NAME_GLOB:
+        matches = fnmatch(pred->m_pattern, name, 0) == 0;
+        break;
+
+    case PRED_NAME_REGEX:
+        matches = regexec(&pred->m_regex, name, 0, NULL, 0) == 0;
+        break;
+
+    case PRED_PROPERTY: {
+        const char *value = lookup(data, pred->m_property);
+        matches = value != NULL && fnmatch(pred->m_pattern, value, 0) == 0;
+        break;
+    }
+
+    default:
+        UNREACHABLE;
+        matches = false;
+    }
+
+    return matches != pred->m_negated;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_filter" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_filter_init(atf_filter_t *filter)
+{
+    return atf_list_init(&filter->m_preds);
+}
+
+void
+atf_filter_fini(atf_filter_t *filter)
+{
+    atf_list_iter_t iter;
+
+    atf_list_for_each(iter, &filter->m_preds)
+        pred_free(atf_list_iter_data(iter));
+    atf_list_fini(&filter->m_preds);
+}
+
+/*
+ * Getters.
+ */
+
+bool
+atf_filter_is_empty(const atf_filter_t *filter)
+{
+    return atf_list_size(&filter->m_preds) == 0;
+}
+
+/*
+ * Returns true if the test case with the given name satisfies all the
+ * predicates of the filter.  lookup is only called to query the meta-data
+ * properties used by the filter, and only after all the predicates on the
+ * name of the test case have matched.
+ */
+bool
+atf_filter_matches(const atf_filter_t *filter, const char *name,
+                   atf_filter_lookup_t lookup, const void *data)
+{
+    atf_list_citer_t iter;
+
+    atf_list_for_each_c(iter, &filter->m_preds) {
+        const struct pred *pred = atf_list_citer_data(iter);
+
+        if (pred->m_type != PRED_PROPERTY &&
+            !pred_matches(pred, name, lookup, data))
+            return false;
+    }
+
+    atf_list_for_each_c(iter, &filter->m_preds) {
+        const struct pred *pred = atf_list_citer_data(iter);
+
+        if (pred->m_type == PRED_PROPERTY &&
+            !pred_matches(pred, name, lookup, data))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Modifiers.
+ */
+
+atf_error_t
+atf_filter_add(atf_filter_t *filter, const char *expr)
+{
+    atf_error_t err;
+    struct pred *pred;
+
+    pred = malloc(sizeof(*pred));
+    if (pred == NULL)
+        return atf_no_memory_error();
+
+    err = pred_parse(expr, pred);
+    if (atf_is_error(err)) {
+        free(pred);
+        return err;
+    }
+
+    err = atf_list_append(&filter->m_preds, pred, true);
+    if (atf_is_error(err)) {
+        pred_free(pred);
+        free(pred);
+    }
+    return err;
+}
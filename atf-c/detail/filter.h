@@ -0,0 +1,70 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_FILTER_H)
+#define ATF_C_DETAIL_FILTER_H
+
+#include <stdbool.h>
+
+#include <atf-c/detail/list.h>
+#include <atf-c/error_fwd.h>
+
+/* ---------------------------------------------------------------------
+ * The "atf_filter" type.
+ * --------------------------------------------------------------------- */
+
+/* Returns the value of a meta-data property of a test case, or NULL if the
+ * test case does not define it. */
+typedef const char *(*atf_filter_lookup_t)(const void *, const char *);
+
+/* A conjunction of predicates that select test cases.  Each predicate is
+ * one of:
+ *
+ *     glob             The name of the test case matches the glob.
+ *     /regex/          The name of the test case matches the extended
+ *                      regular expression.
+ *     property=glob    The value of the meta-data property matches the glob.
+ *
+ * and is negated if prefixed by '!'.  The predicates on the name are
+ * evaluated first so that those on the meta-data, which may require
+ * evaluating the head of the test case, only run when needed. */
+struct atf_filter {
+    atf_list_t m_preds;
+};
+typedef struct atf_filter atf_filter_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_filter_init(atf_filter_t *);
+void atf_filter_fini(atf_filter_t *);
+
+/* Getters. */
+bool atf_filter_is_empty(const atf_filter_t *);
+bool atf_filter_matches(const atf_filter_t *, const char *,
+                        atf_filter_lookup_t, const void *);
+
+/* Modifiers. */
+atf_error_t atf_filter_add(atf_filter_t *, const char *);
+
+#endif /* !defined(ATF_C_DETAIL_FILTER_H) */
@@ -0,0 +1,193 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/filter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static int lookups;
+
+static
+const char *
+lookup(const void *data, const char *name)
+{
+    const char *const *props = data;
+
+    lookups++;
+    for (; *props != NULL; props += 2) {
+        if (strcmp(props[0], name) == 0)
+            return props[1];
+    }
+    return NULL;
+}
+
+static
+bool
+matches(const char *const *exprs, const char *name,
+        const char *const *props)
+{
+    atf_filter_t filter;
+    bool result;
+
+    RE(atf_filter_init(&filter));
+    for (; *exprs != NULL; exprs++)
+        RE(atf_filter_add(&filter, *exprs));
+    result = atf_filter_matches(&filter, name, lookup, props);
+    atf_filter_fini(&filter);
+
+    return result;
+}
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_filter" type.
+ * --------------------------------------------------------------------- */
+
+static const char *const no_props[] = { NULL };
+
+ATF_TC_WITHOUT_HEAD(init);
+ATF_TC_BODY(init, tc)
+{
+    atf_filter_t filter;
+
+    RE(atf_filter_init(&filter));
+    ATF_REQUIRE(atf_filter_is_empty(&filter));
+    ATF_REQUIRE(atf_filter_matches(&filter, "foo", lookup, no_props));
+    RE(atf_filter_add(&filter, "foo"));
+    ATF_REQUIRE(!atf_filter_is_empty(&filter));
+    atf_filter_fini(&filter);
+}
+
+ATF_TC_WITHOUT_HEAD(glob);
+ATF_TC_BODY(glob, tc)
+{
+    const char *const exprs1[] = { "foo*", NULL };
+    const char *const exprs2[] = { "!foo*", NULL };
+    const char *const exprs3[] = { "?ar", "*r", NULL };
+
+    ATF_REQUIRE(matches(exprs1, "foo", no_props));
+    ATF_REQUIRE(matches(exprs1, "foobar", no_props));
+    ATF_REQUIRE(!matches(exprs1, "barfoo", no_props));
+
+    ATF_REQUIRE(!matches(exprs2, "foobar", no_props));
+    ATF_REQUIRE(matches(exprs2, "barfoo", no_props));
+
+    ATF_REQUIRE(matches(exprs3, "bar", no_props));
+    ATF_REQUIRE(!matches(exprs3, "baz", no_props));
+    ATF_REQUIRE(!matches(exprs3, "barr", no_props));
+}
+
+ATF_TC_WITHOUT_HEAD(regex);
+ATF_TC_BODY(regex, tc)
+{
+    const char *const exprs1[] = { "/^(foo|bar)_[0-9]+$/", NULL };
+    const char *const exprs2[] = { "!/o{2}/", NULL };
+
+    ATF_REQUIRE(matches(exprs1, "foo_1", no_props));
+    ATF_REQUIRE(matches(exprs1, "bar_123", no_props));
+    ATF_REQUIRE(!matches(exprs1, "baz_1", no_props));
+    ATF_REQUIRE(!matches(exprs1, "foo_", no_props));
+
+    ATF_REQUIRE(matches(exprs2, "fob", no_props));
+    ATF_REQUIRE(!matches(exprs2, "foo", no_props));
+}
+
+ATF_TC_WITHOUT_HEAD(property);
+ATF_TC_BODY(property, tc)
+{
+    const char *const props[] = { "X-size", "small", "require.user", "root",
+                                  "descr", "a=b", NULL };
+    const char *const exprs1[] = { "X-size=small", NULL };
+    const char *const exprs2[] = { "X-size=s*", "!require.user=root", NULL };
+    const char *const exprs3[] = { "X-undefined=*", NULL };
+    const char *const exprs4[] = { "!X-undefined=*", NULL };
+    const char *const exprs5[] = { "descr=a=b", NULL };
+
+    ATF_REQUIRE(matches(exprs1, "foo", props));
+    ATF_REQUIRE(!matches(exprs2, "foo", props));
+    ATF_REQUIRE(!matches(exprs3, "foo", props));
+    ATF_REQUIRE(matches(exprs4, "foo", props));
+    ATF_REQUIRE(matches(exprs5, "foo", props));
+}
+
+ATF_TC_WITHOUT_HEAD(name_first);
+ATF_TC_BODY(name_first, tc)
+{
+    const char *const props[] = { "X-size", "small", NULL };
+    const char *const exprs[] = { "X-size=small", "foo*", NULL };
+
+    lookups = 0;
+    ATF_REQUIRE(!matches(exprs, "bar", props));
+    ATF_REQUIRE_EQ(0, lookups);
+
+    ATF_REQUIRE(matches(exprs, "foo", props));
+    ATF_REQUIRE_EQ(1, lookups);
+}
+
+ATF_TC_WITHOUT_HEAD(add_invalid);
+ATF_TC_BODY(add_invalid, tc)
+{
+    const char *const exprs[] = { "", "!", "/(/", "!/[a/", "=foo", "!=",
+                                  NULL };
+    const char *const *expr;
+
+    for (expr = exprs; *expr != NULL; expr++) {
+        atf_filter_t filter;
+        atf_error_t err;
+
+        printf("Checking '%s'\n", *expr);
+        RE(atf_filter_init(&filter));
+        err = atf_filter_add(&filter, *expr);
+        ATF_REQUIRE(atf_is_error(err));
+        ATF_REQUIRE(atf_error_is(err, "libc"));
+        atf_error_free(err);
+        ATF_REQUIRE(atf_filter_is_empty(&filter));
+        atf_filter_fini(&filter);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, init);
+    ATF_TP_ADD_TC(tp, glob);
+    ATF_TP_ADD_TC(tp, regex);
+    ATF_TP_ADD_TC(tp, property);
+    ATF_TP_ADD_TC(tp, name_first);
+    ATF_TP_ADD_TC(tp, add_invalid);
+
+    return atf_no_error();
+}
@@ -247,7 +247,7 @@ normalize(atf_dynstr_t *d, char *p)
     PRE(atf_dynstr_length(d) == 0);
 
     if (p[0] == '/')
-        err = atf_dynstr_append_fmt(d, "/");
+        err = atf_dynstr_append_mem(d, "/", 1);
     else
         err = atf_no_error();
 
@@ -256,7 +256,10 @@ normalize(atf_dynstr_t *d, char *p)
     ptr = strtok_r(p, "/", &last);
     while (!atf_is_error(err) && ptr != NULL) {
         if (strlen(ptr) > 0) {
-            err = atf_dynstr_append_fmt(d, "%s%s", first ? "" : "/", ptr);
+            if (!first)
+                err = atf_dynstr_append_mem(d, "/", 1);
+            if (!atf_is_error(err))
+                err = atf_dynstr_append_mem(d, ptr, strlen(ptr));
             first = false;
         }
 
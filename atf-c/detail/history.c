@@ -0,0 +1,352 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/history.h"
+
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atf-c/detail/fs.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* The data of every entry in the map of durations. */
+struct duration {
+    unsigned long m_msecs;
+
+    /* Whether the duration was recorded by this process through
+     * atf_history_set, as opposed to read from a history file. */
+    bool m_measured;
+};
+
+static
+atf_error_t
+set_duration(atf_history_t *h, const char *ident, const unsigned long msecs,
+             const bool measured)
+{
+    struct duration *d;
+
+    d = malloc(sizeof(*d));
+    if (d == NULL)
+        return atf_no_memory_error();
+    d->m_msecs = msecs;
+    d->m_measured = measured;
+
+    return atf_map_insert(&h->m_durations, ident, d, true);
+}
+
+/*
+ * Parses a "msecs ident" line of a history file.  Returns false if the line
+ * is malformed, in which case it is ignored: the history is only a hint for
+ * the scheduler, so a damaged file must never prevent the tests from
+ * running.
+ */
+static
+bool
+parse_line(char *line, unsigned long *msecs, const char **ident)
+{
+    char *end;
+
+    if (*line < '0' || *line > '9')
+        return false;
+
+    errno = 0;
+    *msecs = strtoul(line, &end, 10);
+    if (errno != 0 || *end != ' ' || *(end + 1) == '\0')
+        return false;
+
+    *ident = end + 1;
+    return strchr(*ident, ' ') == NULL;
+}
+
+static
+atf_error_t
+write_entries(const atf_history_t *h, FILE *f, const char *path)
+{
+    atf_map_citer_t iter;
+
+    atf_map_for_each_c(iter, &h->m_durations) {
+        const struct duration *d = atf_map_citer_data(iter);
+
+        if (fprintf(f, "%lu %s\n", d->m_msecs, atf_map_citer_key(iter)) < 0)
+            return atf_libc_error(errno, "Cannot write to %s", path);
+    }
+    return atf_no_error();
+}
+
+/*
+ * Opens and locks a history file for writing, creating it if necessary.
+ * Another process may replace the file while this one waits for the lock,
+ * in which case the new file is locked instead.
+ */
+static
+atf_error_t
+lock_file(const char *path, int *fdp)
+{
+    struct stat fdsb, pathsb;
+    int fd;
+
+    for (;;) {
+        fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1)
+            return atf_libc_error(errno, "Cannot open %s", path);
+
+        while (flock(fd, LOCK_EX) == -1) {
+            if (errno != EINTR) {
+                const int olderrno = errno;
+                close(fd);
+                return atf_libc_error(olderrno, "Cannot lock %s", path);
+            }
+        }
+
+        if (fstat(fd, &fdsb) == -1 || stat(path, &pathsb) == -1 ||
+            (fdsb.st_dev == pathsb.st_dev && fdsb.st_ino == pathsb.st_ino))
+            break;
+        close(fd);
+    }
+
+    *fdp = fd;
+    return atf_no_error();
+}
+
+/*
+ * Writes the entries of the history to a temporary file and moves it over
+ * path.
+ */
+static
+atf_error_t
+replace_file(const atf_history_t *h, const char *path)
+{
+    atf_error_t err;
+    atf_fs_path_t temp;
+    FILE *f;
+    int fd;
+
+    err = atf_fs_path_init_fmt(&temp, "%s.XXXXXX", path);
+    if (atf_is_error(err))
+        goto out;
+
+    err = atf_fs_mkstemp(&temp, &fd);
+    if (atf_is_error(err))
+        goto out_temp;
+    (void)fchmod(fd, 0644);
+
+    f = fdopen(fd, "w");
+    if (f == NULL) {
+        err = atf_libc_error(errno, "Cannot open %s",
+                             atf_fs_path_cstring(&temp));
+        close(fd);
+        goto out_unlink;
+    }
+
+    err = write_entries(h, f, atf_fs_path_cstring(&temp));
+    if (fclose(f) == EOF && !atf_is_error(err))
+        err = atf_libc_error(errno, "Cannot write to %s",
+                             atf_fs_path_cstring(&temp));
+    if (atf_is_error(err))
+        goto out_unlink;
+
+    if (rename(atf_fs_path_cstring(&temp), path) == -1) {
+        err = atf_libc_error(errno, "Cannot replace %s", path);
+        goto out_unlink;
+    }
+
+    INV(!atf_is_error(err));
+    goto out_temp;
+
+out_unlink:
+    (void)unlink(atf_fs_path_cstring(&temp));
+out_temp:
+    atf_fs_path_fini(&temp);
+out:
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_history" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_history_init(atf_history_t *h)
+{
+    return atf_map_init(&h->m_durations);
+}
+
+void
+atf_history_fini(atf_history_t *h)
+{
+    atf_map_fini(&h->m_durations);
+}
+
+/*
+ * Getters.
+ */
+
+/*
+ * Returns false if the test case has no recorded duration.
+ */
+bool
+atf_history_get(const atf_history_t *h, const char *ident,
+                unsigned long *msecs)
+{
+    atf_map_citer_t iter;
+
+    iter = atf_map_find_c(&h->m_durations, ident);
+    if (atf_equal_map_citer_map_citer(iter, atf_map_end_c(&h->m_durations)))
+        return false;
+
+    *msecs = ((const struct duration *)atf_map_citer_data(iter))->m_msecs;
+    return true;
+}
+
+size_t
+atf_history_size(const atf_history_t *h)
+{
+    return atf_map_size(&h->m_durations);
+}
+
+/*
+ * Modifiers.
+ */
+
+atf_error_t
+atf_history_set(atf_history_t *h, const char *ident,
+                const unsigned long msecs)
+{
+    return set_duration(h, ident, msecs, true);
+}
+
+/*
+ * Operations.
+ */
+
+/*
+ * Adds the durations recorded in a history file, overriding those already
+ * known.  A missing file is not an error, and malformed lines are skipped.
+ */
+atf_error_t
+atf_history_load(atf_history_t *h, const char *path)
+{
+    atf_error_t err;
+    char line[1024];
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        if (errno == ENOENT)
+            return atf_no_error();
+        return atf_libc_error(errno, "Cannot open %s", path);
+    }
+
+    err = atf_no_error();
+    while (!atf_is_error(err) && fgets(line, sizeof(line), f) != NULL) {
+        const size_t len = strlen(line);
+        const char *ident;
+        unsigned long msecs;
+
+        if (len > 0 && line[len - 1] == '\n') {
+            line[len - 1] = '\0';
+        } else if (len == sizeof(line) - 1) {
+            int ch;
+
+            /* Overlong line; discard the rest of it. */
+            while ((ch = getc(f)) != EOF && ch != '\n')
+                continue;
+            continue;
+        }
+
+        if (parse_line(line, &msecs, &ident))
+            err = set_duration(h, ident, msecs, false);
+    }
+    if (!atf_is_error(err) && ferror(f))
+        err = atf_libc_error(errno, "Cannot read %s", path);
+    fclose(f);
+
+    return err;
+}
+
+/*
+ * Writes the durations set through atf_history_set to a history file,
+ * keeping the other entries that the file has at that point.  This lets
+ * several processes that run test cases of the same program concurrently
+ * share its history: writers are serialized with a lock on the file, and
+ * the file is replaced atomically so that readers never see a
+ * partially-written history.
+ */
+atf_error_t
+atf_history_save(const atf_history_t *h, const char *path)
+{
+    atf_error_t err;
+    atf_history_t merged;
+    atf_map_citer_t iter;
+    int fd = -1;
+
+    err = lock_file(path, &fd);
+    if (atf_is_error(err))
+        goto out;
+
+    err = atf_history_init(&merged);
+    if (atf_is_error(err))
+        goto out_fd;
+
+    err = atf_history_load(&merged, path);
+    if (atf_is_error(err))
+        goto out_merged;
+
+    atf_map_for_each_c(iter, &h->m_durations) {
+        const struct duration *d = atf_map_citer_data(iter);
+
+        if (d->m_measured) {
+            err = set_duration(&merged, atf_map_citer_key(iter), d->m_msecs,
+                               true);
+            if (atf_is_error(err))
+                goto out_merged;
+        }
+    }
+
+    err = replace_file(&merged, path);
+
+out_merged:
+    atf_history_fini(&merged);
+out_fd:
+    close(fd);  /* Releases the lock. */
+out:
+    return err;
+}
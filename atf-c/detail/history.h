@@ -0,0 +1,63 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_HISTORY_H)
+#define ATF_C_DETAIL_HISTORY_H
+
+#include <stdbool.h>
+
+#include <atf-c/detail/map.h>
+#include <atf-c/error_fwd.h>
+
+/* ---------------------------------------------------------------------
+ * The "atf_history" type.
+ * --------------------------------------------------------------------- */
+
+/* The wall time, in milliseconds, that each test case of a program took
+ * the last time it was run.  It is persisted to a text file with one
+ * "msecs ident" line per test case, which concurrent runs of the program
+ * merge their durations into. */
+struct atf_history {
+    atf_map_t m_durations;
+};
+typedef struct atf_history atf_history_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_history_init(atf_history_t *);
+void atf_history_fini(atf_history_t *);
+
+/* Getters. */
+bool atf_history_get(const atf_history_t *, const char *, unsigned long *);
+size_t atf_history_size(const atf_history_t *);
+
+/* Modifiers. */
+atf_error_t atf_history_set(atf_history_t *, const char *,
+                            const unsigned long);
+
+/* Operations. */
+atf_error_t atf_history_load(atf_history_t *, const char *);
+atf_error_t atf_history_save(const atf_history_t *, const char *);
+
+#endif /* !defined(ATF_C_DETAIL_HISTORY_H) */
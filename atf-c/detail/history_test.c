@@ -0,0 +1,191 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/history.h"
+
+#include <stdio.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_history" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(get_set);
+ATF_TC_BODY(get_set, tc)
+{
+    atf_history_t h;
+    unsigned long msecs;
+
+    RE(atf_history_init(&h));
+    ATF_REQUIRE_EQ(0, atf_history_size(&h));
+    ATF_REQUIRE(!atf_history_get(&h, "foo", &msecs));
+
+    RE(atf_history_set(&h, "foo", 15));
+    RE(atf_history_set(&h, "bar", 0));
+    ATF_REQUIRE_EQ(2, atf_history_size(&h));
+    ATF_REQUIRE(atf_history_get(&h, "foo", &msecs));
+    ATF_REQUIRE_EQ(15, msecs);
+    ATF_REQUIRE(atf_history_get(&h, "bar", &msecs));
+    ATF_REQUIRE_EQ(0, msecs);
+
+    RE(atf_history_set(&h, "foo", 30));
+    ATF_REQUIRE_EQ(2, atf_history_size(&h));
+    ATF_REQUIRE(atf_history_get(&h, "foo", &msecs));
+    ATF_REQUIRE_EQ(30, msecs);
+
+    atf_history_fini(&h);
+}
+
+ATF_TC_WITHOUT_HEAD(load_missing);
+ATF_TC_BODY(load_missing, tc)
+{
+    atf_history_t h;
+
+    RE(atf_history_init(&h));
+    RE(atf_history_load(&h, "missing"));
+    ATF_REQUIRE_EQ(0, atf_history_size(&h));
+    atf_history_fini(&h);
+}
+
+ATF_TC_WITHOUT_HEAD(load_malformed);
+ATF_TC_BODY(load_malformed, tc)
+{
+    atf_history_t h;
+    unsigned long msecs;
+
+    atf_utils_create_file("history", "10 first\n"
+                                     "garbage\n"
+                                     "20\n"
+                                     "30 \n"
+                                     "x40 second\n"
+                                     "50 with space\n"
+                                     "-60 negative\n"
+                                     "99999999999999999999999 overflow\n"
+                                     "70 last");
+
+    RE(atf_history_init(&h));
+    RE(atf_history_load(&h, "history"));
+    ATF_REQUIRE_EQ(2, atf_history_size(&h));
+    ATF_REQUIRE(atf_history_get(&h, "first", &msecs));
+    ATF_REQUIRE_EQ(10, msecs);
+    ATF_REQUIRE(atf_history_get(&h, "last", &msecs));
+    ATF_REQUIRE_EQ(70, msecs);
+    atf_history_fini(&h);
+}
+
+ATF_TC_WITHOUT_HEAD(save_load);
+ATF_TC_BODY(save_load, tc)
+{
+    atf_history_t h1, h2;
+    unsigned long msecs;
+
+    RE(atf_history_init(&h1));
+    RE(atf_history_set(&h1, "foo", 1234));
+    RE(atf_history_set(&h1, "bar", 5));
+    RE(atf_history_save(&h1, "history"));
+    atf_history_fini(&h1);
+
+    ATF_REQUIRE(atf_utils_compare_file("history", "1234 foo\n5 bar\n"));
+
+    RE(atf_history_init(&h2));
+    RE(atf_history_set(&h2, "foo", 1));
+    RE(atf_history_set(&h2, "baz", 2));
+    RE(atf_history_load(&h2, "history"));
+    ATF_REQUIRE_EQ(3, atf_history_size(&h2));
+    ATF_REQUIRE(atf_history_get(&h2, "foo", &msecs));
+    ATF_REQUIRE_EQ(1234, msecs);
+    ATF_REQUIRE(atf_history_get(&h2, "bar", &msecs));
+    ATF_REQUIRE_EQ(5, msecs);
+    ATF_REQUIRE(atf_history_get(&h2, "baz", &msecs));
+    ATF_REQUIRE_EQ(2, msecs);
+    atf_history_fini(&h2);
+}
+
+ATF_TC_WITHOUT_HEAD(save_merge);
+ATF_TC_BODY(save_merge, tc)
+{
+    atf_history_t h1, h2, h3;
+    unsigned long msecs;
+
+    atf_utils_create_file("history", "10 a\n20 b\n");
+
+    RE(atf_history_init(&h1));
+    RE(atf_history_load(&h1, "history"));
+    RE(atf_history_set(&h1, "a", 11));
+
+    /* Another process saves its own durations in the meantime. */
+    RE(atf_history_init(&h2));
+    RE(atf_history_set(&h2, "b", 25));
+    RE(atf_history_set(&h2, "c", 30));
+    RE(atf_history_save(&h2, "history"));
+    atf_history_fini(&h2);
+
+    RE(atf_history_save(&h1, "history"));
+    atf_history_fini(&h1);
+
+    RE(atf_history_init(&h3));
+    RE(atf_history_load(&h3, "history"));
+    ATF_REQUIRE_EQ(3, atf_history_size(&h3));
+    ATF_REQUIRE(atf_history_get(&h3, "a", &msecs));
+    ATF_REQUIRE_EQ(11, msecs);
+    ATF_REQUIRE(atf_history_get(&h3, "b", &msecs));
+    ATF_REQUIRE_EQ(25, msecs);
+    ATF_REQUIRE(atf_history_get(&h3, "c", &msecs));
+    ATF_REQUIRE_EQ(30, msecs);
+    atf_history_fini(&h3);
+}
+
+ATF_TC_WITHOUT_HEAD(save_error);
+ATF_TC_BODY(save_error, tc)
+{
+    atf_history_t h;
+    atf_error_t err;
+
+    RE(atf_history_init(&h));
+    err = atf_history_save(&h, "missing/history");
+    ATF_REQUIRE(atf_is_error(err));
+    atf_error_free(err);
+    atf_history_fini(&h);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, get_set);
+    ATF_TP_ADD_TC(tp, load_missing);
+    ATF_TP_ADD_TC(tp, load_malformed);
+    ATF_TP_ADD_TC(tp, save_load);
+    ATF_TP_ADD_TC(tp, save_merge);
+    ATF_TP_ADD_TC(tp, save_error);
+
+    return atf_no_error();
+}
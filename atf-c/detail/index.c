@@ -0,0 +1,214 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/index.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atf-c/detail/arena.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+struct atf_index_slot {
+    const char *m_key;
+    size_t m_hash;
+    void *m_value;
+};
+
+/* The table is grown when it becomes more than half full, which keeps
+ * the probe sequences of the linear probing short. */
+#define INITIAL_CAPACITY 16
+
+/*
+ * Computes the FNV-1a hash of a string.
+ */
+static
+size_t
+hash_string(const char *str)
+{
+    uint64_t hash = UINT64_C(14695981039346656037);
+
+    for (; *str != '\0'; str++) {
+        hash ^= (unsigned char)*str;
+        hash *= UINT64_C(1099511628211);
+    }
+    return (size_t)hash;
+}
+
+/*
+ * Returns the slot holding the given key or, if it is not in the table,
+ * the empty slot where it would be inserted.  The table must have at
+ * least one empty slot.
+ */
+static
+struct atf_index_slot *
+find_slot(struct atf_index_slot *slots, const size_t capacity, const char *key,
+          const size_t hash)
+{
+    size_t i = hash & (capacity - 1);
+
+    while (slots[i].m_key != NULL) {
+        if (slots[i].m_hash == hash &&
+            (slots[i].m_key == key || strcmp(slots[i].m_key, key) == 0))
+            break;
+        i = (i + 1) & (capacity - 1);
+    }
+    return &slots[i];
+}
+
+static
+atf_error_t
+grow(atf_index_t *idx)
+{
+    struct atf_index_slot *slots;
+    size_t capacity, i;
+
+    capacity = idx->m_capacity == 0 ? INITIAL_CAPACITY : idx->m_capacity * 2;
+    if (idx->m_arena != NULL) {
+        /* The old table stays in the arena until it is released. */
+        slots = atf_arena_alloc(idx->m_arena,
+                                capacity * sizeof(struct atf_index_slot));
+        if (slots != NULL)
+            memset(slots, 0, capacity * sizeof(struct atf_index_slot));
+    } else
+        slots = calloc(capacity, sizeof(struct atf_index_slot));
+    if (slots == NULL)
+        return atf_no_memory_error();
+
+    for (i = 0; i < idx->m_capacity; i++) {
+        const struct atf_index_slot *old = &idx->m_slots[i];
+
+        if (old->m_key != NULL)
+            *find_slot(slots, capacity, old->m_key, old->m_hash) = *old;
+    }
+
+    if (idx->m_arena == NULL)
+        free(idx->m_slots);
+    idx->m_slots = slots;
+    idx->m_capacity = capacity;
+    return atf_no_error();
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_index" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_index_init(atf_index_t *idx)
+{
+    idx->m_slots = NULL;
+    idx->m_capacity = 0;
+    idx->m_size = 0;
+    idx->m_arena = NULL;
+    return atf_no_error();
+}
+
+/*
+ * Same as atf_index_init but allocates the table from the given arena,
+ * which must outlive the index.
+ */
+atf_error_t
+atf_index_init_arena(atf_index_t *idx, struct atf_arena *arena)
+{
+    atf_error_t err;
+
+    err = atf_index_init(idx);
+    if (!atf_is_error(err))
+        idx->m_arena = arena;
+    return err;
+}
+
+void
+atf_index_fini(atf_index_t *idx)
+{
+    if (idx->m_arena == NULL)
+        free(idx->m_slots);
+}
+
+/*
+ * Getters.
+ */
+
+/*
+ * Returns the value associated to the given key, or NULL if there is none.
+ */
+void *
+atf_index_get(const atf_index_t *idx, const char *key)
+{
+    if (idx->m_size == 0)
+        return NULL;
+    return find_slot(idx->m_slots, idx->m_capacity, key,
+                     hash_string(key))->m_value;
+}
+
+size_t
+atf_index_size(const atf_index_t *idx)
+{
+    return idx->m_size;
+}
+
+/*
+ * Modifiers.
+ */
+
+/*
+ * Associates a value to a key, replacing any previous value.  The key is
+ * not copied, so it must remain valid for as long as the index is used.
+ */
+atf_error_t
+atf_index_insert(atf_index_t *idx, const char *key, void *value)
+{
+    struct atf_index_slot *slot;
+    size_t hash;
+
+    PRE(value != NULL);
+
+    if ((idx->m_size + 1) * 2 > idx->m_capacity) {
+        atf_error_t err = grow(idx);
+        if (atf_is_error(err))
+            return err;
+    }
+
+    hash = hash_string(key);
+    slot = find_slot(idx->m_slots, idx->m_capacity, key, hash);
+    if (slot->m_key == NULL) {
+        slot->m_key = key;
+        slot->m_hash = hash;
+        idx->m_size++;
+    }
+    slot->m_value = value;
+
+    return atf_no_error();
+}
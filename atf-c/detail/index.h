@@ -0,0 +1,63 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_INDEX_H)
+#define ATF_C_DETAIL_INDEX_H
+
+#include <stddef.h>
+
+#include <atf-c/error_fwd.h>
+
+struct atf_arena;
+
+/* ---------------------------------------------------------------------
+ * The "atf_index" type.
+ * --------------------------------------------------------------------- */
+
+/* A hash table from strings to pointers, used to look up objects by
+ * name.  The index does not own its keys nor its values: both must
+ * outlive it.  If m_arena is not NULL, the table is allocated from it
+ * instead of the heap. */
+struct atf_index {
+    struct atf_index_slot *m_slots;
+    size_t m_capacity;
+    size_t m_size;
+    struct atf_arena *m_arena;
+};
+typedef struct atf_index atf_index_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_index_init(atf_index_t *);
+atf_error_t atf_index_init_arena(atf_index_t *, struct atf_arena *);
+void atf_index_fini(atf_index_t *);
+
+/* Getters. */
+void *atf_index_get(const atf_index_t *, const char *);
+size_t atf_index_size(const atf_index_t *);
+
+/* Modifiers. */
+atf_error_t atf_index_insert(atf_index_t *, const char *, void *);
+
+#endif /* !defined(ATF_C_DETAIL_INDEX_H) */
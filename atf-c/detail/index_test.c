@@ -0,0 +1,142 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/index.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/arena.h"
+#include "atf-c/detail/test_helpers.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_index" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(init);
+ATF_TC_BODY(init, tc)
+{
+    atf_index_t idx;
+
+    RE(atf_index_init(&idx));
+    ATF_REQUIRE_EQ(0, atf_index_size(&idx));
+    ATF_REQUIRE(atf_index_get(&idx, "foo") == NULL);
+    atf_index_fini(&idx);
+}
+
+ATF_TC_WITHOUT_HEAD(insert_get);
+ATF_TC_BODY(insert_get, tc)
+{
+    atf_index_t idx;
+    int v1, v2;
+
+    RE(atf_index_init(&idx));
+    RE(atf_index_insert(&idx, "K1", &v1));
+    RE(atf_index_insert(&idx, "K2", &v2));
+    ATF_REQUIRE_EQ(2, atf_index_size(&idx));
+    ATF_REQUIRE(atf_index_get(&idx, "K1") == &v1);
+    ATF_REQUIRE(atf_index_get(&idx, "K2") == &v2);
+    ATF_REQUIRE(atf_index_get(&idx, "K3") == NULL);
+    ATF_REQUIRE(atf_index_get(&idx, "") == NULL);
+    atf_index_fini(&idx);
+}
+
+ATF_TC_WITHOUT_HEAD(insert_replace);
+ATF_TC_BODY(insert_replace, tc)
+{
+    atf_index_t idx;
+    int v1, v2;
+    char key[] = "K1";
+
+    RE(atf_index_init(&idx));
+    RE(atf_index_insert(&idx, "K1", &v1));
+    RE(atf_index_insert(&idx, key, &v2));
+    ATF_REQUIRE_EQ(1, atf_index_size(&idx));
+    ATF_REQUIRE(atf_index_get(&idx, "K1") == &v2);
+    atf_index_fini(&idx);
+}
+
+ATF_TC_WITHOUT_HEAD(insert_many);
+ATF_TC_BODY(insert_many, tc)
+{
+    static char keys[5000][16];
+    static int values[5000];
+    atf_index_t idx;
+    size_t i;
+
+    RE(atf_index_init(&idx));
+    for (i = 0; i < 5000; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "tc_%zu", i);
+        RE(atf_index_insert(&idx, keys[i], &values[i]));
+    }
+    ATF_REQUIRE_EQ(5000, atf_index_size(&idx));
+
+    for (i = 0; i < 5000; i++) {
+        char key[16];
+
+        snprintf(key, sizeof(key), "tc_%zu", i);
+        ATF_REQUIRE(atf_index_get(&idx, key) == &values[i]);
+    }
+    ATF_REQUIRE(atf_index_get(&idx, "tc_5000") == NULL);
+    atf_index_fini(&idx);
+}
+
+ATF_TC_WITHOUT_HEAD(init_arena);
+ATF_TC_BODY(init_arena, tc)
+{
+    static char keys[100][16];
+    static int values[100];
+    atf_arena_t arena;
+    atf_index_t idx;
+    size_t i;
+
+    RE(atf_arena_init(&arena));
+    RE(atf_index_init_arena(&idx, &arena));
+    for (i = 0; i < 100; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "tc_%zu", i);
+        RE(atf_index_insert(&idx, keys[i], &values[i]));
+    }
+    for (i = 0; i < 100; i++)
+        ATF_REQUIRE(atf_index_get(&idx, keys[i]) == &values[i]);
+    atf_index_fini(&idx);
+    atf_arena_fini(&arena);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, init);
+    ATF_TP_ADD_TC(tp, insert_get);
+    ATF_TP_ADD_TC(tp, insert_replace);
+    ATF_TP_ADD_TC(tp, insert_many);
+    ATF_TP_ADD_TC(tp, init_arena);
+
+    return atf_no_error();
+}
@@ -0,0 +1,80 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/intern.h"
+
+#include <stddef.h>
+
+#include "atf-c/detail/arena.h"
+#include "atf-c/detail/index.h"
+#include "atf-c/error.h"
+
+/* Storage for the strings themselves; never released. */
+static atf_arena_t Strings = { NULL, NULL, 0 };
+
+/* Maps every interned string to itself. */
+static atf_index_t Index = { NULL, 0, 0, NULL };
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Returns the interned copy of str, adding it to the table if needed, or
+ * NULL if there is no memory left.
+ */
+const char *
+atf_intern(const char *str)
+{
+    const char *interned;
+    char *copy;
+    atf_error_t err;
+
+    interned = atf_index_get(&Index, str);
+    if (interned != NULL)
+        return interned;
+
+    copy = atf_arena_strdup(&Strings, str);
+    if (copy == NULL)
+        return NULL;
+
+    err = atf_index_insert(&Index, copy, copy);
+    if (atf_is_error(err)) {
+        /* The copy stays unused in the arena. */
+        atf_error_free(err);
+        return NULL;
+    }
+
+    return copy;
+}
+
+/*
+ * Returns the interned copy of str, or NULL if it has never been interned.
+ */
+const char *
+atf_intern_find(const char *str)
+{
+    return atf_index_get(&Index, str);
+}
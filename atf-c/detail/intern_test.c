@@ -0,0 +1,103 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/intern.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+/* ---------------------------------------------------------------------
+ * Tests for the interning table.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(intern_same);
+ATF_TC_BODY(intern_same, tc)
+{
+    char buf1[] = "some.key";
+    char buf2[] = "some.key";
+    const char *str;
+
+    str = atf_intern(buf1);
+    ATF_REQUIRE(str != NULL);
+    ATF_REQUIRE(str != buf1);
+    ATF_REQUIRE_STREQ(str, "some.key");
+    ATF_REQUIRE_EQ(atf_intern(buf2), str);
+
+    /* The interned copy does not follow the original. */
+    strcpy(buf1, "new.key!");
+    ATF_REQUIRE_STREQ(str, "some.key");
+    ATF_REQUIRE(atf_intern(buf1) != str);
+}
+
+ATF_TC_WITHOUT_HEAD(intern_find);
+ATF_TC_BODY(intern_find, tc)
+{
+    const char *str;
+
+    ATF_REQUIRE(atf_intern_find("not.yet.interned") == NULL);
+    str = atf_intern("not.yet.interned");
+    ATF_REQUIRE(str != NULL);
+    ATF_REQUIRE_EQ(atf_intern_find("not.yet.interned"), str);
+    ATF_REQUIRE(atf_intern_find("not.yet") == NULL);
+
+    ATF_REQUIRE_STREQ(atf_intern(""), "");
+    ATF_REQUIRE_EQ(atf_intern_find(""), atf_intern(""));
+}
+
+ATF_TC_WITHOUT_HEAD(intern_many);
+ATF_TC_BODY(intern_many, tc)
+{
+    const char *strs[5000];
+    char buf[32];
+    size_t i;
+
+    for (i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "key%zd", i);
+        strs[i] = atf_intern(buf);
+        ATF_REQUIRE(strs[i] != NULL);
+    }
+
+    for (i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "key%zd", i);
+        ATF_REQUIRE_EQ(atf_intern_find(buf), strs[i]);
+        ATF_REQUIRE_EQ(atf_intern(buf), strs[i]);
+        ATF_REQUIRE_STREQ(strs[i], buf);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, intern_same);
+    ATF_TP_ADD_TC(tp, intern_find);
+    ATF_TP_ADD_TC(tp, intern_many);
+
+    return atf_no_error();
+}
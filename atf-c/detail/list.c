@@ -37,12 +37,22 @@
  * --------------------------------------------------------------------- */
 
 struct list_entry {
-    struct list_entry *m_prev;
-    struct list_entry *m_next;
     void *m_object;
     bool m_managed;
 };
 
+static
+struct list_entry *
+entry_at(const atf_list_t *l, const size_t idx)
+{
+    PRE(idx <= l->m_size);
+
+    /* An empty list may not have any storage yet. */
+    if (l->m_entries == NULL)
+        return NULL;
+    return (struct list_entry *)l->m_entries + idx;
+}
+
 static
 atf_list_citer_t
 entry_to_citer(const atf_list_t *l, const struct list_entry *le)
@@ -63,50 +73,28 @@ entry_to_iter(atf_list_t *l, struct list_entry *le)
     return iter;
 }
 
+/** Ensures that the list can hold at least size elements. */
 static
-struct list_entry *
-new_entry(void *object, bool managed)
+atf_error_t
+reserve(atf_list_t *l, const size_t size)
 {
-    struct list_entry *le;
+    size_t capacity;
+    void *entries;
 
-    le = (struct list_entry *)malloc(sizeof(*le));
-    if (le != NULL) {
-        le->m_prev = le->m_next = NULL;
-        le->m_object = object;
-        le->m_managed = managed;
-    } else if (managed)
-        free(object);
+    if (size <= l->m_capacity)
+        return atf_no_error();
 
-    return le;
-}
+    capacity = l->m_capacity == 0 ? 8 : l->m_capacity * 2;
+    if (capacity < size)
+        capacity = size;
 
-static
-void
-delete_entry(struct list_entry *le)
-{
-    if (le->m_managed)
-        free(le->m_object);
-
-    free(le);
-}
-
-static
-struct list_entry *
-new_entry_and_link(void *object, bool managed, struct list_entry *prev,
-                   struct list_entry *next)
-{
-    struct list_entry *le;
-
-    le = new_entry(object, managed);
-    if (le != NULL) {
-        le->m_prev = prev;
-        le->m_next = next;
-
-        prev->m_next = le;
-        next->m_prev = le;
-    }
+    entries = realloc(l->m_entries, capacity * sizeof(struct list_entry));
+    if (entries == NULL)
+        return atf_no_memory_error();
 
-    return le;
+    l->m_entries = entries;
+    l->m_capacity = capacity;
+    return atf_no_error();
 }
 
 /* ---------------------------------------------------------------------
@@ -134,7 +122,7 @@ atf_list_citer_next(const atf_list_citer_t citer)
     PRE(le != NULL);
 
     newciter = citer;
-    newciter.m_entry = le->m_next;
+    newciter.m_entry = le + 1;
 
     return newciter;
 }
@@ -165,13 +153,13 @@ atf_list_iter_data(const atf_list_iter_t iter)
 atf_list_iter_t
 atf_list_iter_next(const atf_list_iter_t iter)
 {
-    const struct list_entry *le = iter.m_entry;
+    struct list_entry *le = iter.m_entry;
     atf_list_iter_t newiter;
 
     PRE(le != NULL);
 
     newiter = iter;
-    newiter.m_entry = le->m_next;
+    newiter.m_entry = le + 1;
 
     return newiter;
 }
@@ -194,28 +182,10 @@ atf_equal_list_iter_list_iter(const atf_list_iter_t i1,
 atf_error_t
 atf_list_init(atf_list_t *l)
 {
-    struct list_entry *lebeg, *leend;
-
-    lebeg = new_entry(NULL, false);
-    if (lebeg == NULL) {
-        return atf_no_memory_error();
-    }
-
-    leend = new_entry(NULL, false);
-    if (leend == NULL) {
-        free(lebeg);
-        return atf_no_memory_error();
-    }
-
-    lebeg->m_next = leend;
-    lebeg->m_prev = NULL;
-
-    leend->m_next = NULL;
-    leend->m_prev = lebeg;
-
+    /* Storage is allocated on the first append. */
+    l->m_entries = NULL;
     l->m_size = 0;
-    l->m_begin = lebeg;
-    l->m_end = leend;
+    l->m_capacity = 0;
 
     return atf_no_error();
 }
@@ -223,21 +193,15 @@ atf_list_init(atf_list_t *l)
 void
 atf_list_fini(atf_list_t *l)
 {
-    struct list_entry *le;
-    size_t freed;
-
-    le = (struct list_entry *)l->m_begin;
-    freed = 0;
-    while (le != NULL) {
-        struct list_entry *lenext;
+    size_t i;
 
-        lenext = le->m_next;
-        delete_entry(le);
-        le = lenext;
+    for (i = 0; i < l->m_size; i++) {
+        struct list_entry *le = entry_at(l, i);
 
-        freed++;
+        if (le->m_managed)
+            free(le->m_object);
     }
-    INV(freed == l->m_size + 2);
+    free(l->m_entries);
 }
 
 /*
@@ -247,66 +211,41 @@ atf_list_fini(atf_list_t *l)
 atf_list_iter_t
 atf_list_begin(atf_list_t *l)
 {
-    struct list_entry *le = l->m_begin;
-    return entry_to_iter(l, le->m_next);
+    return entry_to_iter(l, entry_at(l, 0));
 }
 
 atf_list_citer_t
 atf_list_begin_c(const atf_list_t *l)
 {
-    const struct list_entry *le = l->m_begin;
-    return entry_to_citer(l, le->m_next);
+    return entry_to_citer(l, entry_at(l, 0));
 }
 
 atf_list_iter_t
 atf_list_end(atf_list_t *l)
 {
-    return entry_to_iter(l, l->m_end);
+    return entry_to_iter(l, entry_at(l, l->m_size));
 }
 
 atf_list_citer_t
 atf_list_end_c(const atf_list_t *l)
 {
-    return entry_to_citer(l, l->m_end);
+    return entry_to_citer(l, entry_at(l, l->m_size));
 }
 
 void *
 atf_list_index(atf_list_t *list, const size_t idx)
 {
-    atf_list_iter_t iter;
-
     PRE(idx < atf_list_size(list));
 
-    iter = atf_list_begin(list);
-    {
-        size_t pos = 0;
-        while (pos < idx &&
-               !atf_equal_list_iter_list_iter((iter), atf_list_end(list))) {
-            iter = atf_list_iter_next(iter);
-            pos++;
-        }
-    }
-    return atf_list_iter_data(iter);
+    return entry_at(list, idx)->m_object;
 }
 
 const void *
 atf_list_index_c(const atf_list_t *list, const size_t idx)
 {
-    atf_list_citer_t iter;
-
     PRE(idx < atf_list_size(list));
 
-    iter = atf_list_begin_c(list);
-    {
-        size_t pos = 0;
-        while (pos < idx &&
-               !atf_equal_list_citer_list_citer((iter),
-                                                atf_list_end_c(list))) {
-            iter = atf_list_citer_next(iter);
-            pos++;
-        }
-    }
-    return atf_list_citer_data(iter);
+    return entry_at(list, idx)->m_object;
 }
 
 size_t
@@ -319,23 +258,19 @@ char **
 atf_list_to_charpp(const atf_list_t *l)
 {
     char **array;
-    atf_list_citer_t iter;
     size_t i;
 
     array = malloc(sizeof(char *) * (atf_list_size(l) + 1));
     if (array == NULL)
         goto out;
 
-    i = 0;
-    atf_list_for_each_c(iter, l) {
-        array[i] = strdup((const char *)atf_list_citer_data(iter));
+    for (i = 0; i < l->m_size; i++) {
+        array[i] = strdup((const char *)entry_at(l, i)->m_object);
         if (array[i] == NULL) {
             atf_utils_free_charpp(array);
             array = NULL;
             goto out;
         }
-
-        i++;
     }
     array[i] = NULL;
 
@@ -347,42 +282,73 @@ out:
  * Modifiers.
  */
 
+/*
+ * Appends data to the list.  If managed is true, the list takes ownership
+ * of data even if the append fails.
+ */
 atf_error_t
 atf_list_append(atf_list_t *l, void *data, bool managed)
 {
-    struct list_entry *le, *next, *prev;
+    struct list_entry *le;
     atf_error_t err;
 
-    next = (struct list_entry *)l->m_end;
-    prev = next->m_prev;
-    le = new_entry_and_link(data, managed, prev, next);
-    if (le == NULL)
-        err = atf_no_memory_error();
-    else {
-        l->m_size++;
-        err = atf_no_error();
+    err = reserve(l, l->m_size + 1);
+    if (atf_is_error(err)) {
+        if (managed)
+            free(data);
+        return err;
     }
 
-    return err;
+    le = entry_at(l, l->m_size);
+    le->m_object = data;
+    le->m_managed = managed;
+    l->m_size++;
+
+    return atf_no_error();
 }
 
+/*
+ * Removes the last element of l, releasing it if the list manages it.
+ */
 void
-atf_list_append_list(atf_list_t *l, atf_list_t *src)
+atf_list_remove_last(atf_list_t *l)
 {
-    struct list_entry *e1, *e2, *ghost1, *ghost2;
+    struct list_entry *le;
 
-    ghost1 = (struct list_entry *)l->m_end;
-    ghost2 = (struct list_entry *)src->m_begin;
+    PRE(l->m_size > 0);
 
-    e1 = ghost1->m_prev;
-    e2 = ghost2->m_next;
+    l->m_size--;
+    le = entry_at(l, l->m_size);
+    if (le->m_managed)
+        free(le->m_object);
+}
+
+/*
+ * Moves all the elements of src to the end of l.  src is always consumed
+ * and must not be used nor finalized afterwards, even if this fails.
+ */
+atf_error_t
+atf_list_append_list(atf_list_t *l, atf_list_t *src)
+{
+    atf_error_t err;
 
-    delete_entry(ghost1);
-    delete_entry(ghost2);
+    if (l->m_size == 0) {
+        free(l->m_entries);
+        *l = *src;
+        return atf_no_error();
+    }
 
-    e1->m_next = e2;
-    e2->m_prev = e1;
+    err = reserve(l, l->m_size + src->m_size);
+    if (atf_is_error(err)) {
+        atf_list_fini(src);
+        return err;
+    }
 
-    l->m_end = src->m_end;
+    if (src->m_size > 0)
+        memcpy(entry_at(l, l->m_size), src->m_entries,
+               src->m_size * sizeof(struct list_entry));
     l->m_size += src->m_size;
+    free(src->m_entries);
+
+    return atf_no_error();
 }
@@ -72,11 +72,12 @@ bool atf_equal_list_iter_list_iter(const atf_list_iter_t,
  * The "atf_list" type.
  * --------------------------------------------------------------------- */
 
+/* A growable array of pointers.  Appending may move the elements, so it
+ * invalidates any iterators into the list. */
 struct atf_list {
-    void *m_begin;
-    void *m_end;
-
+    void *m_entries;
     size_t m_size;
+    size_t m_capacity;
 };
 typedef struct atf_list atf_list_t;
 
@@ -96,7 +97,8 @@ char **atf_list_to_charpp(const atf_list_t *);
 
 /* Modifiers. */
 atf_error_t atf_list_append(atf_list_t *, void *, bool);
-void atf_list_append_list(atf_list_t *, atf_list_t *);
+atf_error_t atf_list_append_list(atf_list_t *, atf_list_t *);
+void atf_list_remove_last(atf_list_t *);
 
 /* Macros. */
 #define atf_list_for_each(iter, list) \
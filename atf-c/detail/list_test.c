@@ -168,6 +168,34 @@ ATF_TC_BODY(list_append, tc)
     atf_list_fini(&list);
 }
 
+ATF_TC(list_remove_last);
+ATF_TC_HEAD(list_remove_last, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks the atf_list_remove_last "
+                      "function");
+}
+ATF_TC_BODY(list_remove_last, tc)
+{
+    atf_list_t list;
+    char buf1[] = "First", buf2[] = "Second";
+
+    RE(atf_list_init(&list));
+    RE(atf_list_append(&list, buf1, false));
+    RE(atf_list_append(&list, buf2, false));
+    RE(atf_list_append(&list, strdup("Managed"), true));
+
+    atf_list_remove_last(&list);
+    ATF_REQUIRE_EQ(atf_list_size(&list), 2);
+    atf_list_remove_last(&list);
+    ATF_REQUIRE_EQ(atf_list_size(&list), 1);
+    ATF_REQUIRE(atf_list_index(&list, 0) == buf1);
+
+    RE(atf_list_append(&list, buf2, false));
+    ATF_REQUIRE_EQ(atf_list_size(&list), 2);
+    ATF_REQUIRE(atf_list_index(&list, 1) == buf2);
+    atf_list_fini(&list);
+}
+
 ATF_TC(list_append_list);
 ATF_TC_HEAD(list_append_list, tc)
 {
@@ -182,7 +210,7 @@ ATF_TC_BODY(list_append_list, tc)
         RE(atf_list_init(&l1));
         RE(atf_list_init(&l2));
 
-        atf_list_append_list(&l1, &l2);
+        RE(atf_list_append_list(&l1, &l2));
         ATF_CHECK_EQ(atf_list_size(&l1), 0);
 
         atf_list_fini(&l1);
@@ -196,7 +224,7 @@ ATF_TC_BODY(list_append_list, tc)
         RE(atf_list_append(&l1, &item, false));
         RE(atf_list_init(&l2));
 
-        atf_list_append_list(&l1, &l2);
+        RE(atf_list_append_list(&l1, &l2));
         ATF_CHECK_EQ(atf_list_size(&l1), 1);
         ATF_CHECK_EQ(*(int *)atf_list_index(&l1, 0), item);
 
@@ -211,7 +239,7 @@ ATF_TC_BODY(list_append_list, tc)
         RE(atf_list_init(&l2));
         RE(atf_list_append(&l2, &item, false));
 
-        atf_list_append_list(&l1, &l2);
+        RE(atf_list_append_list(&l1, &l2));
         ATF_CHECK_EQ(atf_list_size(&l1), 1);
         ATF_CHECK_EQ(*(int *)atf_list_index(&l1, 0), item);
 
@@ -228,7 +256,7 @@ ATF_TC_BODY(list_append_list, tc)
         RE(atf_list_init(&l2));
         RE(atf_list_append(&l2, &item2, false));
 
-        atf_list_append_list(&l1, &l2);
+        RE(atf_list_append_list(&l1, &l2));
         ATF_CHECK_EQ(atf_list_size(&l1), 2);
         ATF_CHECK_EQ(*(int *)atf_list_index(&l1, 0), item1);
         ATF_CHECK_EQ(*(int *)atf_list_index(&l1, 1), item2);
@@ -238,18 +266,21 @@ ATF_TC_BODY(list_append_list, tc)
 
     {
         atf_list_t l1, l2;
-        atf_list_citer_t end1, end2;
+        size_t i;
 
         RE(atf_list_init(&l1));
+        RE(atf_list_append(&l1, strdup("first"), true));
         RE(atf_list_init(&l2));
+        for (i = 0; i < 20; i++)
+            RE(atf_list_append(&l2, strdup("second"), true));
 
-        end1 = atf_list_end_c(&l1);
-        end2 = atf_list_end_c(&l2);
-        /* XXX Shouldn't query m_entry here. */
-        ATF_CHECK(end1.m_entry != end2.m_entry);
-
-        atf_list_append_list(&l1, &l2);
-        ATF_CHECK(atf_list_end_c(&l1).m_entry == end2.m_entry);
+        /* The managed elements of l2 now belong to l1 only. */
+        RE(atf_list_append_list(&l1, &l2));
+        ATF_CHECK_EQ(atf_list_size(&l1), 21);
+        ATF_CHECK_STREQ((const char *)atf_list_index_c(&l1, 0), "first");
+        for (i = 1; i < 21; i++)
+            ATF_CHECK_STREQ((const char *)atf_list_index_c(&l1, i),
+                            "second");
 
         atf_list_fini(&l1);
     }
@@ -355,6 +386,7 @@ ATF_TP_ADD_TCS(tp)
 
     /* Modifiers. */
     ATF_TP_ADD_TC(tp, list_append);
+    ATF_TP_ADD_TC(tp, list_remove_last);
     ATF_TP_ADD_TC(tp, list_append_list);
 
     /* Macros. */
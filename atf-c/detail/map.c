@@ -26,9 +26,12 @@
 #include "atf-c/detail/map.h"
 
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "atf-c/detail/arena.h"
+#include "atf-c/detail/intern.h"
 #include "atf-c/detail/sanity.h"
 #include "atf-c/error.h"
 #include "atf-c/utils.h"
@@ -38,30 +41,60 @@
  * --------------------------------------------------------------------- */
 
 struct map_entry {
-    char *m_key;
+    const char *m_key;  /* Interned, or the same as m_copy. */
+    char *m_copy;  /* The key if the map does not intern them, else NULL. */
     void *m_value;
     bool m_managed;
 };
 
+/* The index cannot hold NULL values, so it maps keys to the position of
+ * their entry plus one. */
+#define POSITION_TO_VALUE(pos) ((void *)(uintptr_t)((pos) + 1))
+#define VALUE_TO_POSITION(value) ((size_t)(uintptr_t)(value) - 1)
+
+/** Looks up the entry of a key. */
 static
 struct map_entry *
-new_entry(const char *key, void *value, bool managed)
+find_entry(const atf_map_t *m, const char *key)
 {
-    struct map_entry *me;
+    struct map_entry *entries = m->m_entries;
+    void *value;
 
-    me = (struct map_entry *)malloc(sizeof(*me));
-    if (me != NULL) {
-        me->m_key = strdup(key);
-        if (me->m_key == NULL) {
-            free(me);
-            me = NULL;
-        } else {
-            me->m_value = value;
-            me->m_managed = managed;
-        }
-    }
+    if (m->m_size == 0)
+        return NULL;
 
-    return me;
+    value = atf_index_get(&m->m_index, key);
+    if (value == NULL)
+        return NULL;
+    return &entries[VALUE_TO_POSITION(value)];
+}
+
+/** Makes room for one more entry. */
+static
+atf_error_t
+grow(atf_map_t *m)
+{
+    const size_t capacity = m->m_capacity == 0 ? 8 : m->m_capacity * 2;
+    const size_t size = capacity * sizeof(struct map_entry);
+    void *newentries;
+
+    if (m->m_size < m->m_capacity)
+        return atf_no_error();
+
+    if (m->m_arena != NULL) {
+        /* The old table stays in the arena until it is released. */
+        newentries = atf_arena_alloc(m->m_arena, size);
+        if (newentries != NULL && m->m_size > 0)
+            memcpy(newentries, m->m_entries,
+                   m->m_size * sizeof(struct map_entry));
+    } else
+        newentries = realloc(m->m_entries, size);
+    if (newentries == NULL)
+        return atf_no_memory_error();
+    m->m_entries = newentries;
+    m->m_capacity = capacity;
+
+    return atf_no_error();
 }
 
 /* ---------------------------------------------------------------------
@@ -91,12 +124,17 @@ atf_map_citer_data(const atf_map_citer_t citer)
 atf_map_citer_t
 atf_map_citer_next(const atf_map_citer_t citer)
 {
+    const struct map_entry *entries = citer.m_map->m_entries;
     atf_map_citer_t newciter;
 
+    PRE(citer.m_index < citer.m_map->m_size);
+
     newciter = citer;
-    newciter.m_listiter = atf_list_citer_next(citer.m_listiter);
-    newciter.m_entry = ((const struct map_entry *)
-                        atf_list_citer_data(newciter.m_listiter));
+    newciter.m_index++;
+    if (newciter.m_index < citer.m_map->m_size)
+        newciter.m_entry = &entries[newciter.m_index];
+    else
+        newciter.m_entry = NULL;
 
     return newciter;
 }
@@ -105,7 +143,7 @@ bool
 atf_equal_map_citer_map_citer(const atf_map_citer_t i1,
                               const atf_map_citer_t i2)
 {
-    return i1.m_map == i2.m_map && i1.m_entry == i2.m_entry;
+    return i1.m_map == i2.m_map && i1.m_index == i2.m_index;
 }
 
 /* ---------------------------------------------------------------------
@@ -135,12 +173,17 @@ atf_map_iter_data(const atf_map_iter_t iter)
 atf_map_iter_t
 atf_map_iter_next(const atf_map_iter_t iter)
 {
+    struct map_entry *entries = iter.m_map->m_entries;
     atf_map_iter_t newiter;
 
+    PRE(iter.m_index < iter.m_map->m_size);
+
     newiter = iter;
-    newiter.m_listiter = atf_list_iter_next(iter.m_listiter);
-    newiter.m_entry = ((struct map_entry *)
-                       atf_list_iter_data(newiter.m_listiter));
+    newiter.m_index++;
+    if (newiter.m_index < iter.m_map->m_size)
+        newiter.m_entry = &entries[newiter.m_index];
+    else
+        newiter.m_entry = NULL;
 
     return newiter;
 }
@@ -149,7 +192,7 @@ bool
 atf_equal_map_iter_map_iter(const atf_map_iter_t i1,
                             const atf_map_iter_t i2)
 {
-    return i1.m_map == i2.m_map && i1.m_entry == i2.m_entry;
+    return i1.m_map == i2.m_map && i1.m_index == i2.m_index;
 }
 
 /* ---------------------------------------------------------------------
@@ -163,7 +206,39 @@ atf_equal_map_iter_map_iter(const atf_map_iter_t i1,
 atf_error_t
 atf_map_init(atf_map_t *m)
 {
-    return atf_list_init(&m->m_list);
+    /* Storage is allocated on the first insertion. */
+    m->m_entries = NULL;
+    m->m_size = 0;
+    m->m_capacity = 0;
+    m->m_arena = NULL;
+    m->m_intern = false;
+
+    return atf_index_init(&m->m_index);
+}
+
+/*
+ * Same as atf_map_init but interns the keys instead of copying them, for
+ * maps whose keys are a small set of names repeated across many maps.  If
+ * arena is not NULL, the tables of the map are allocated from it, in which
+ * case the arena must outlive the map.  Managed values are still released
+ * with free(3).
+ */
+atf_error_t
+atf_map_init_interned(atf_map_t *m, struct atf_arena *arena)
+{
+    atf_error_t err;
+
+    err = atf_map_init(m);
+    if (atf_is_error(err))
+        return err;
+
+    m->m_arena = arena;
+    m->m_intern = true;
+    if (arena != NULL) {
+        atf_index_fini(&m->m_index);
+        err = atf_index_init_arena(&m->m_index, arena);
+    }
+    return err;
 }
 
 atf_error_t
@@ -201,17 +276,17 @@ atf_map_init_charpp(atf_map_t *m, const char *const *array)
 void
 atf_map_fini(atf_map_t *m)
 {
-    atf_list_iter_t iter;
-
-    atf_list_for_each(iter, &m->m_list) {
-        struct map_entry *me = atf_list_iter_data(iter);
+    struct map_entry *entries = m->m_entries;
+    size_t i;
 
-        if (me->m_managed)
-            free(me->m_value);
-        free(me->m_key);
-        free(me);
+    for (i = 0; i < m->m_size; i++) {
+        if (entries[i].m_managed)
+            free(entries[i].m_value);
+        free(entries[i].m_copy);
     }
-    atf_list_fini(&m->m_list);
+    atf_index_fini(&m->m_index);
+    if (m->m_arena == NULL)
+        free(m->m_entries);
 }
 
 /*
@@ -223,8 +298,8 @@ atf_map_begin(atf_map_t *m)
 {
     atf_map_iter_t iter;
     iter.m_map = m;
-    iter.m_listiter = atf_list_begin(&m->m_list);
-    iter.m_entry = atf_list_iter_data(iter.m_listiter);
+    iter.m_index = 0;
+    iter.m_entry = m->m_size == 0 ? NULL : m->m_entries;
     return iter;
 }
 
@@ -233,8 +308,8 @@ atf_map_begin_c(const atf_map_t *m)
 {
     atf_map_citer_t citer;
     citer.m_map = m;
-    citer.m_listiter = atf_list_begin_c(&m->m_list);
-    citer.m_entry = atf_list_citer_data(citer.m_listiter);
+    citer.m_index = 0;
+    citer.m_entry = m->m_size == 0 ? NULL : m->m_entries;
     return citer;
 }
 
@@ -244,7 +319,7 @@ atf_map_end(atf_map_t *m)
     atf_map_iter_t iter;
     iter.m_map = m;
     iter.m_entry = NULL;
-    iter.m_listiter = atf_list_end(&m->m_list);
+    iter.m_index = m->m_size;
     return iter;
 }
 
@@ -254,54 +329,46 @@ atf_map_end_c(const atf_map_t *m)
     atf_map_citer_t iter;
     iter.m_map = m;
     iter.m_entry = NULL;
-    iter.m_listiter = atf_list_end_c(&m->m_list);
+    iter.m_index = m->m_size;
     return iter;
 }
 
 atf_map_iter_t
 atf_map_find(atf_map_t *m, const char *key)
 {
-    atf_list_iter_t iter;
-
-    atf_list_for_each(iter, &m->m_list) {
-        struct map_entry *me = atf_list_iter_data(iter);
+    struct map_entry *me;
+    atf_map_iter_t i;
 
-        if (strcmp(me->m_key, key) == 0) {
-            atf_map_iter_t i;
-            i.m_map = m;
-            i.m_entry = me;
-            i.m_listiter = iter;
-            return i;
-        }
-    }
+    me = find_entry(m, key);
+    if (me == NULL)
+        return atf_map_end(m);
 
-    return atf_map_end(m);
+    i.m_map = m;
+    i.m_entry = me;
+    i.m_index = me - (struct map_entry *)m->m_entries;
+    return i;
 }
 
 atf_map_citer_t
 atf_map_find_c(const atf_map_t *m, const char *key)
 {
-    atf_list_citer_t iter;
-
-    atf_list_for_each_c(iter, &m->m_list) {
-        const struct map_entry *me = atf_list_citer_data(iter);
+    const struct map_entry *me;
+    atf_map_citer_t i;
 
-        if (strcmp(me->m_key, key) == 0) {
-            atf_map_citer_t i;
-            i.m_map = m;
-            i.m_entry = me;
-            i.m_listiter = iter;
-            return i;
-        }
-    }
+    me = find_entry(m, key);
+    if (me == NULL)
+        return atf_map_end_c(m);
 
-    return atf_map_end_c(m);
+    i.m_map = m;
+    i.m_entry = me;
+    i.m_index = me - (const struct map_entry *)m->m_entries;
+    return i;
 }
 
 size_t
 atf_map_size(const atf_map_t *m)
 {
-    return atf_list_size(&m->m_list);
+    return m->m_size;
 }
 
 char **
@@ -343,28 +410,20 @@ out:
  * Modifiers.
  */
 
+/*
+ * Inserts or replaces the value of key.  The map takes ownership of the
+ * value if managed is true, even if the insertion fails.  Entries may move
+ * in memory, so iterators are invalidated by any insertion.
+ */
 atf_error_t
 atf_map_insert(atf_map_t *m, const char *key, void *value, bool managed)
 {
     struct map_entry *me;
     atf_error_t err;
-    atf_map_iter_t iter;
+    char *copy;
 
-    iter = atf_map_find(m, key);
-    if (atf_equal_map_iter_map_iter(iter, atf_map_end(m))) {
-        me = new_entry(key, value, managed);
-        if (me == NULL)
-            err = atf_no_memory_error();
-        else {
-            err = atf_list_append(&m->m_list, me, false);
-            if (atf_is_error(err)) {
-                if (managed)
-                    free(value);
-                free(me);
-            }
-        }
-    } else {
-        me = iter.m_entry;
+    me = find_entry(m, key);
+    if (me != NULL) {
         if (me->m_managed)
             free(me->m_value);
 
@@ -372,8 +431,41 @@ atf_map_insert(atf_map_t *m, const char *key, void *value, bool managed)
         me->m_value = value;
         me->m_managed = managed;
 
-        err = atf_no_error();
+        return atf_no_error();
+    }
+
+    err = grow(m);
+    if (atf_is_error(err))
+        goto err;
+
+    if (m->m_intern) {
+        copy = NULL;
+        key = atf_intern(key);
+    } else
+        key = copy = strdup(key);
+    if (key == NULL) {
+        err = atf_no_memory_error();
+        goto err;
+    }
+
+    err = atf_index_insert(&m->m_index, key,
+                           POSITION_TO_VALUE(m->m_size));
+    if (atf_is_error(err)) {
+        free(copy);
+        goto err;
     }
 
+    me = &((struct map_entry *)m->m_entries)[m->m_size];
+    me->m_key = key;
+    me->m_copy = copy;
+    me->m_value = value;
+    me->m_managed = managed;
+    m->m_size++;
+
+    return atf_no_error();
+
+err:
+    if (managed)
+        free(value);
     return err;
 }
@@ -28,10 +28,13 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 
-#include <atf-c/detail/list.h>
+#include <atf-c/detail/index.h>
 #include <atf-c/error_fwd.h>
 
+struct atf_arena;
+
 /* ---------------------------------------------------------------------
  * The "atf_map_citer" type.
  * --------------------------------------------------------------------- */
@@ -39,7 +42,7 @@
 struct atf_map_citer {
     const struct atf_map *m_map;
     const void *m_entry;
-    atf_list_citer_t m_listiter;
+    size_t m_index;
 };
 typedef struct atf_map_citer atf_map_citer_t;
 
@@ -59,7 +62,7 @@ bool atf_equal_map_citer_map_citer(const atf_map_citer_t,
 struct atf_map_iter {
     struct atf_map *m_map;
     void *m_entry;
-    atf_list_iter_t m_listiter;
+    size_t m_index;
 };
 typedef struct atf_map_iter atf_map_iter_t;
 
@@ -76,15 +79,27 @@ bool atf_equal_map_iter_map_iter(const atf_map_iter_t,
  * The "atf_map" type.
  * --------------------------------------------------------------------- */
 
-/* A list-based map.  Typically very inefficient, but our maps are small
- * enough. */
+/* A hash table.  The entries live in an array kept in insertion order,
+ * which is the order used by the iterators, and m_index maps keys to
+ * positions in that array.  Keys are copied into the map unless m_intern
+ * is set, in which case they are interned (see intern.h) and thus stored
+ * once per program.  If m_arena is not NULL, the tables are allocated from
+ * it instead of the heap. */
 struct atf_map {
-    atf_list_t m_list;
+    void *m_entries;
+    size_t m_size;
+    size_t m_capacity;
+
+    atf_index_t m_index;
+
+    struct atf_arena *m_arena;
+    bool m_intern;
 };
 typedef struct atf_map atf_map_t;
 
 /* Constructors and destructors */
 atf_error_t atf_map_init(atf_map_t *);
+atf_error_t atf_map_init_interned(atf_map_t *, struct atf_arena *);
 atf_error_t atf_map_init_charpp(atf_map_t *, const char *const *);
 void atf_map_fini(atf_map_t *);
 
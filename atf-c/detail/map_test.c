@@ -30,6 +30,7 @@
 
 #include <atf-c.h>
 
+#include "atf-c/detail/intern.h"
 #include "atf-c/detail/test_helpers.h"
 #include "atf-c/utils.h"
 
@@ -388,6 +389,83 @@ ATF_TC_BODY(stable_keys, tc)
     atf_map_fini(&map);
 }
 
+ATF_TC(interned_keys);
+ATF_TC_HEAD(interned_keys, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that only the maps created with "
+                      "atf_map_init_interned intern their keys");
+}
+ATF_TC_BODY(interned_keys, tc)
+{
+    atf_map_t map;
+    atf_map_citer_t iter;
+
+    RE(atf_map_init(&map));
+    RE(atf_map_insert(&map, "map_test.copied", strdup("v"), true));
+    iter = atf_map_find_c(&map, "map_test.copied");
+    ATF_REQUIRE_STREQ(atf_map_citer_key(iter), "map_test.copied");
+    ATF_REQUIRE(atf_intern_find("map_test.copied") == NULL);
+    atf_map_fini(&map);
+
+    RE(atf_map_init_interned(&map, NULL));
+    RE(atf_map_insert(&map, "map_test.interned", strdup("v"), true));
+    iter = atf_map_find_c(&map, "map_test.interned");
+    ATF_REQUIRE(atf_map_citer_key(iter) ==
+                atf_intern_find("map_test.interned"));
+    atf_map_fini(&map);
+}
+
+ATF_TC(many_keys);
+ATF_TC_HEAD(many_keys, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that lookups and the insertion "
+                      "order survive the growth of the map");
+}
+ATF_TC_BODY(many_keys, tc)
+{
+    atf_map_t map;
+    atf_map_citer_t iter;
+    char key[16];
+    size_t i;
+
+    RE(atf_map_init(&map));
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%zd", 999 - i);
+        RE(atf_map_insert(&map, key, strdup(key + 3), true));
+    }
+    ATF_REQUIRE_EQ(atf_map_size(&map), 1000);
+
+    RE(atf_map_insert(&map, "key500", strdup("replaced"), true));
+    ATF_REQUIRE_EQ(atf_map_size(&map), 1000);
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%zd", i);
+        iter = atf_map_find_c(&map, key);
+        ATF_REQUIRE(!atf_equal_map_citer_map_citer(iter,
+                                                   atf_map_end_c(&map)));
+        ATF_REQUIRE_STREQ(atf_map_citer_key(iter), key);
+        if (i == 500)
+            ATF_REQUIRE_STREQ((const char *)atf_map_citer_data(iter),
+                              "replaced");
+        else
+            ATF_REQUIRE_STREQ((const char *)atf_map_citer_data(iter),
+                              key + 3);
+    }
+    iter = atf_map_find_c(&map, "key1000");
+    ATF_REQUIRE(atf_equal_map_citer_map_citer(iter, atf_map_end_c(&map)));
+
+    i = 0;
+    atf_map_for_each_c(iter, &map) {
+        snprintf(key, sizeof(key), "key%zd", 999 - i);
+        ATF_REQUIRE_STREQ(atf_map_citer_key(iter), key);
+        i++;
+    }
+    ATF_REQUIRE_EQ(i, 1000);
+
+    atf_map_fini(&map);
+}
+
 /* ---------------------------------------------------------------------
  * Main.
  * --------------------------------------------------------------------- */
@@ -416,6 +494,8 @@ ATF_TP_ADD_TCS(tp)
 
     /* Other. */
     ATF_TP_ADD_TC(tp, stable_keys);
+    ATF_TP_ADD_TC(tp, interned_keys);
+    ATF_TP_ADD_TC(tp, many_keys);
 
     return atf_no_error();
 }
@@ -0,0 +1,673 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/report.h"
+
+#include <sys/stat.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atf-c/detail/dynstr.h"
+#include "atf-c/detail/env.h"
+#include "atf-c/detail/fs.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* Number of records appended between calls to fsync(2).  Syncing after
+ * every test case would make the report the bottleneck of runs with many
+ * short test cases; syncing in batches bounds how many records a crash of
+ * the host can lose. */
+#define SYNC_BATCH 32
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions for writing records.
+ * --------------------------------------------------------------------- */
+
+static
+atf_error_t
+append_json_string(atf_dynstr_t *out, const char *str, const size_t len)
+{
+    atf_error_t err;
+    size_t i, plain;
+
+    err = atf_dynstr_append_mem(out, "\"", 1);
+    for (i = plain = 0; !atf_is_error(err) && i < len; i++) {
+        const unsigned char ch = (unsigned char)str[i];
+        const char escape[2] = { '\\', (char)ch };
+
+        if (ch != '"' && ch != '\\' && ch >= 0x20)
+            continue;
+
+        /* Copy the run of plain characters before this one in one go. */
+        err = atf_dynstr_append_mem(out, str + plain, i - plain);
+        plain = i + 1;
+        if (atf_is_error(err))
+            break;
+
+        if (ch == '"' || ch == '\\')
+            err = atf_dynstr_append_mem(out, escape, sizeof(escape));
+        else if (ch == '\n')
+            err = atf_dynstr_append_mem(out, "\\n", 2);
+        else if (ch == '\t')
+            err = atf_dynstr_append_mem(out, "\\t", 2);
+        else
+            err = atf_dynstr_append_fmt(out, "\\u%04x", ch);
+    }
+    if (!atf_is_error(err))
+        err = atf_dynstr_append_mem(out, str + plain, len - plain);
+    if (!atf_is_error(err))
+        err = atf_dynstr_append_mem(out, "\"", 1);
+    return err;
+}
+
+static
+bool
+is_number(const char *str, const size_t len)
+{
+    size_t i;
+    bool dot = false;
+
+    if (len == 0 || !isdigit((unsigned char)str[0]))
+        return false;
+    for (i = 1; i < len; i++) {
+        if (str[i] == '.' && !dot && i + 1 < len)
+            dot = true;
+        else if (!isdigit((unsigned char)str[i]))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Appends the fields for a result such as "expected_exit(1): Some reason":
+ * the keyword goes into "result", the optional argument into "arg" and the
+ * optional reason into "reason".
+ */
+static
+atf_error_t
+append_result(atf_dynstr_t *out, const char *result)
+{
+    atf_error_t err;
+    const char *ptr = result;
+
+    while (*ptr == '_' || (*ptr >= 'a' && *ptr <= 'z'))
+        ptr++;
+    err = atf_dynstr_append_fmt(out, ", \"result\": ");
+    if (!atf_is_error(err))
+        err = append_json_string(out, result, ptr - result);
+
+    if (!atf_is_error(err) && *ptr == '(') {
+        const char *arg = ptr + 1;
+
+        for (ptr = arg; isdigit((unsigned char)*ptr); ptr++)
+            continue;
+        if (*ptr == ')' && ptr != arg) {
+            err = atf_dynstr_append_fmt(out, ", \"arg\": ");
+            if (!atf_is_error(err))
+                err = atf_dynstr_append_mem(out, arg, ptr - arg);
+            ptr++;
+        }
+    }
+
+    if (!atf_is_error(err) && strncmp(ptr, ": ", 2) == 0) {
+        err = atf_dynstr_append_fmt(out, ", \"reason\": ");
+        if (!atf_is_error(err))
+            err = append_json_string(out, ptr + 2, strlen(ptr + 2));
+    }
+    return err;
+}
+
+/*
+ * Appends a field for every "key: value" line of the extended results
+ * format.  Values that look like numbers are stored as such.
+ */
+static
+atf_error_t
+append_extra(atf_dynstr_t *out, const char *extra)
+{
+    atf_error_t err = atf_no_error();
+    const char *line, *sep, *end;
+
+    for (line = extra; !atf_is_error(err) && *line != '\0'; line = end) {
+        end = strchr(line, '\n');
+        if (end == NULL)
+            end = line + strlen(line);
+        sep = strstr(line, ": ");
+        if (sep != NULL && sep < end) {
+            const char *value = sep + 2;
+            const size_t len = end - value;
+
+            err = atf_dynstr_append_fmt(out, ", ");
+            if (!atf_is_error(err))
+                err = append_json_string(out, line, sep - line);
+            if (!atf_is_error(err))
+                err = atf_dynstr_append_fmt(out, ": ");
+            if (!atf_is_error(err)) {
+                if (is_number(value, len))
+                    err = atf_dynstr_append_mem(out, value, len);
+                else
+                    err = append_json_string(out, value, len);
+            }
+        }
+        if (*end == '\n')
+            end++;
+    }
+    return err;
+}
+
+static
+atf_error_t
+write_all(const int fd, const char *buf, size_t len, const char *path)
+{
+    ssize_t cnt;
+
+    while (len > 0) {
+        cnt = write(fd, buf, len);
+        if (cnt == -1) {
+            if (errno == EINTR)
+                continue;
+            return atf_libc_error(errno, "Cannot write to %s", path);
+        }
+        buf += cnt;
+        len -= cnt;
+    }
+    return atf_no_error();
+}
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions for reading records.
+ * --------------------------------------------------------------------- */
+
+/* The fields of a record needed to convert it; they point into the line
+ * that holds the record. */
+struct record {
+    const char *m_program;
+    const char *m_ident;
+    const char *m_result;
+    const char *m_reason;
+    const char *m_duration;
+};
+
+static
+char *
+skip_space(char *ptr)
+{
+    while (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r')
+        ptr++;
+    return ptr;
+}
+
+/*
+ * Parses the JSON string at *ptr in place, replacing it with its unescaped
+ * and nul-terminated value, which is never longer than the original text.
+ * Escaped characters outside of ASCII are replaced by '?'.  Returns NULL
+ * if the string is malformed.
+ */
+static
+char *
+parse_string(char **ptr)
+{
+    char *in = *ptr, *out, *start;
+
+    if (*in != '"')
+        return NULL;
+    start = out = ++in;
+    while (*in != '"') {
+        if (*in == '\0')
+            return NULL;
+        if (*in != '\\') {
+            *out++ = *in++;
+            continue;
+        }
+
+        in++;
+        switch (*in) {
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u': {
+            unsigned long code;
+            char hex[5], *end;
+
+            if (strlen(in + 1) < 4)
+                return NULL;
+            memcpy(hex, in + 1, 4);
+            hex[4] = '\0';
+            code = strtoul(hex, &end, 16);
+            if (*end != '\0')
+                return NULL;
+            *out++ = (code > 0 && code < 0x80) ? (char)code : '?';
+            in += 4;
+            break;
+        }
+        case '\0':
+            return NULL;
+        default:
+            *out++ = *in;
+            break;
+        }
+        in++;
+    }
+    *out = '\0';
+    *ptr = in + 1;
+    return start;
+}
+
+/*
+ * Parses a record as written by atf_report_add.  Only flat objects with
+ * string and numeric values are supported, which is all the report ever
+ * contains.  Returns false if the record is malformed or lacks the ident
+ * or result fields.
+ */
+static
+bool
+parse_record(char *line, struct record *rec)
+{
+    char *ptr, *key, *value;
+
+    rec->m_program = rec->m_ident = rec->m_result = NULL;
+    rec->m_reason = rec->m_duration = NULL;
+
+    ptr = skip_space(line);
+    if (*ptr++ != '{')
+        return false;
+    ptr = skip_space(ptr);
+    if (*ptr == '}')
+        return false;
+    for (;;) {
+        char *end, sep;
+
+        key = parse_string(&ptr);
+        if (key == NULL)
+            return false;
+        ptr = skip_space(ptr);
+        if (*ptr++ != ':')
+            return false;
+        ptr = skip_space(ptr);
+        if (*ptr == '"') {
+            value = parse_string(&ptr);
+            if (value == NULL)
+                return false;
+            end = NULL;
+        } else {
+            value = ptr;
+            while (*ptr != '\0' && strchr("+-.0123456789Ee", *ptr) != NULL)
+                ptr++;
+            if (ptr == value)
+                return false;
+            end = ptr;
+        }
+        ptr = skip_space(ptr);
+        sep = *ptr;
+        if (end != NULL)
+            *end = '\0';
+        if (sep == ',')
+            ptr = skip_space(ptr + 1);
+        else if (sep != '}')
+            return false;
+
+        if (strcmp(key, "program") == 0)
+            rec->m_program = value;
+        else if (strcmp(key, "ident") == 0)
+            rec->m_ident = value;
+        else if (strcmp(key, "result") == 0)
+            rec->m_result = value;
+        else if (strcmp(key, "reason") == 0)
+            rec->m_reason = value;
+        else if (strcmp(key, "time.body.duration") == 0)
+            rec->m_duration = value;
+
+        if (sep == '}')
+            break;
+    }
+    return rec->m_ident != NULL && rec->m_result != NULL;
+}
+
+static
+bool
+result_is_failure(const char *result)
+{
+    return strcmp(result, "failed") == 0;
+}
+
+static
+bool
+result_is_error(const char *result)
+{
+    return strcmp(result, "passed") != 0 &&
+        strcmp(result, "skipped") != 0 &&
+        strncmp(result, "expected_", 9) != 0 &&
+        !result_is_failure(result);
+}
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions for writing JUnit XML files.
+ * --------------------------------------------------------------------- */
+
+/* Prints a string as XML attribute text.  Control characters are not
+ * allowed in XML 1.0 documents, so they are replaced by '?'. */
+static
+void
+print_xml(FILE *f, const char *str)
+{
+    for (; *str != '\0'; str++) {
+        const unsigned char ch = (unsigned char)*str;
+
+        if (ch == '&')
+            fputs("&amp;", f);
+        else if (ch == '<')
+            fputs("&lt;", f);
+        else if (ch == '>')
+            fputs("&gt;", f);
+        else if (ch == '"')
+            fputs("&quot;", f);
+        else if (ch == '\n')
+            fputs("&#10;", f);
+        else if (ch < 0x20 && ch != '\t')
+            fputc('?', f);
+        else
+            fputc(ch, f);
+    }
+}
+
+static
+void
+print_testcase(FILE *f, const struct record *rec)
+{
+    const char *element = NULL;
+
+    fputs("  <testcase classname=\"", f);
+    print_xml(f, rec->m_program != NULL ? rec->m_program : "");
+    fputs("\" name=\"", f);
+    print_xml(f, rec->m_ident);
+    fputs("\"", f);
+    if (rec->m_duration != NULL) {
+        fputs(" time=\"", f);
+        print_xml(f, rec->m_duration);
+        fputs("\"", f);
+    }
+
+    if (strcmp(rec->m_result, "skipped") == 0)
+        element = "skipped";
+    else if (result_is_failure(rec->m_result))
+        element = "failure";
+    else if (result_is_error(rec->m_result))
+        element = "error";
+
+    if (element == NULL) {
+        fputs("/>\n", f);
+        return;
+    }
+    fprintf(f, ">\n    <%s message=\"", element);
+    print_xml(f, rec->m_reason != NULL ? rec->m_reason : rec->m_result);
+    fputs("\"/>\n  </testcase>\n", f);
+}
+
+/*
+ * Converts the records of an open report, which is read twice: once to
+ * count the test cases for the attributes of the test suite and once more
+ * to print them, so that memory use does not grow with the report.
+ */
+static
+atf_error_t
+convert_records(FILE *in, FILE *out, const char *path)
+{
+    atf_error_t err = atf_no_error();
+    struct record rec;
+    unsigned long tests = 0, failures = 0, errors = 0, skipped = 0;
+    char *line = NULL;
+    size_t linesize = 0;
+
+    while (getline(&line, &linesize, in) != -1) {
+        if (!parse_record(line, &rec))
+            continue;
+        tests++;
+        if (strcmp(rec.m_result, "skipped") == 0)
+            skipped++;
+        else if (result_is_failure(rec.m_result))
+            failures++;
+        else if (result_is_error(rec.m_result))
+            errors++;
+    }
+    if (ferror(in)) {
+        err = atf_libc_error(errno, "Cannot read %s", path);
+        goto out;
+    }
+    rewind(in);
+
+    fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<testsuite name=\"atf\" tests=\"%lu\" failures=\"%lu\" "
+            "errors=\"%lu\" skipped=\"%lu\">\n", tests, failures, errors,
+            skipped);
+    while (getline(&line, &linesize, in) != -1) {
+        if (parse_record(line, &rec))
+            print_testcase(out, &rec);
+    }
+    if (ferror(in)) {
+        err = atf_libc_error(errno, "Cannot read %s", path);
+        goto out;
+    }
+    fputs("</testsuite>\n", out);
+
+out:
+    free(line);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_report" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+/*
+ * Opens the report at path for appending, creating it if needed, so that
+ * several test programs can add their records to the same report.  The
+ * program name is not copied and must outlive the report.
+ */
+atf_error_t
+atf_report_open(atf_report_t *r, const char *path, const char *program)
+{
+    r->m_path = strdup(path);
+    if (r->m_path == NULL)
+        return atf_no_memory_error();
+
+    r->m_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (r->m_fd == -1) {
+        atf_error_t err = atf_libc_error(errno, "Cannot open report %s",
+                                         path);
+        free(r->m_path);
+        return err;
+    }
+
+    r->m_program = program;
+    r->m_unsynced = 0;
+    return atf_no_error();
+}
+
+/*
+ * Opens the report named by the ATF_REPORT_FILE environment variable, if
+ * set and not empty.  enabled is set to whether the report was opened.
+ */
+atf_error_t
+atf_report_open_from_env(atf_report_t *r, const char *program, bool *enabled)
+{
+    atf_error_t err;
+
+    *enabled = false;
+    if (!atf_env_has("ATF_REPORT_FILE") ||
+        *atf_env_get("ATF_REPORT_FILE") == '\0')
+        return atf_no_error();
+
+    err = atf_report_open(r, atf_env_get("ATF_REPORT_FILE"), program);
+    if (atf_is_error(err))
+        return err;
+
+    *enabled = true;
+    return atf_no_error();
+}
+
+/*
+ * Flushes the report to disk and closes it.  The report is released even
+ * if an error is returned.
+ */
+atf_error_t
+atf_report_close(atf_report_t *r)
+{
+    atf_error_t err = atf_no_error();
+
+    if (r->m_unsynced > 0 && fsync(r->m_fd) == -1 && errno != EINVAL)
+        err = atf_libc_error(errno, "Cannot sync report %s", r->m_path);
+    if (close(r->m_fd) == -1 && !atf_is_error(err))
+        err = atf_libc_error(errno, "Cannot close report %s", r->m_path);
+
+    free(r->m_path);
+    return err;
+}
+
+/*
+ * Modifiers.
+ */
+
+/*
+ * Appends the record of a completed test case.  result is its single-line
+ * result, such as "failed: Some reason", and extra, if not NULL, holds the
+ * "key: value" lines that follow the result in the extended results format.
+ * Each record is written with a single call to write(2) so that records
+ * appended concurrently by several test programs do not interleave.
+ */
+atf_error_t
+atf_report_add(atf_report_t *r, const char *ident, const char *result,
+               const char *extra)
+{
+    atf_error_t err;
+    atf_dynstr_t rec;
+
+    err = atf_dynstr_init_fmt(&rec, "{\"program\": ");
+    if (atf_is_error(err))
+        return err;
+
+    err = append_json_string(&rec, r->m_program, strlen(r->m_program));
+    if (!atf_is_error(err))
+        err = atf_dynstr_append_fmt(&rec, ", \"ident\": ");
+    if (!atf_is_error(err))
+        err = append_json_string(&rec, ident, strlen(ident));
+    if (!atf_is_error(err))
+        err = append_result(&rec, result);
+    if (!atf_is_error(err) && extra != NULL)
+        err = append_extra(&rec, extra);
+    if (!atf_is_error(err))
+        err = atf_dynstr_append_fmt(&rec, "}\n");
+    if (!atf_is_error(err))
+        err = write_all(r->m_fd, atf_dynstr_cstring(&rec),
+                        atf_dynstr_length(&rec), r->m_path);
+    atf_dynstr_fini(&rec);
+    if (atf_is_error(err))
+        return err;
+
+    if (++r->m_unsynced >= SYNC_BATCH) {
+        if (fsync(r->m_fd) == -1 && errno != EINVAL)
+            return atf_libc_error(errno, "Cannot sync report %s", r->m_path);
+        r->m_unsynced = 0;
+    }
+    return atf_no_error();
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Converts a report into a JUnit XML file with one test suite, in which
+ * every test case is named after its identifier and classified after the
+ * test program it belongs to.  Failed test cases are reported as failures
+ * and broken ones as errors; expected failures count as passes.  Malformed
+ * records are skipped.
+ */
+atf_error_t
+atf_report_to_junit(const char *report, const char *junit)
+{
+    atf_error_t err;
+    atf_fs_path_t temp;
+    FILE *in, *out;
+    int fd;
+
+    in = fopen(report, "r");
+    if (in == NULL) {
+        err = atf_libc_error(errno, "Cannot open report %s", report);
+        goto out;
+    }
+
+    err = atf_fs_path_init_fmt(&temp, "%s.XXXXXX", junit);
+    if (atf_is_error(err))
+        goto out_in;
+
+    err = atf_fs_mkstemp(&temp, &fd);
+    if (atf_is_error(err))
+        goto out_temp;
+    (void)fchmod(fd, 0644);
+
+    out = fdopen(fd, "w");
+    if (out == NULL) {
+        err = atf_libc_error(errno, "Cannot open %s",
+                             atf_fs_path_cstring(&temp));
+        close(fd);
+        goto out_unlink;
+    }
+
+    err = convert_records(in, out, report);
+    if (fclose(out) == EOF && !atf_is_error(err))
+        err = atf_libc_error(errno, "Cannot write to %s",
+                             atf_fs_path_cstring(&temp));
+    if (atf_is_error(err))
+        goto out_unlink;
+
+    if (rename(atf_fs_path_cstring(&temp), junit) == -1) {
+        err = atf_libc_error(errno, "Cannot replace %s", junit);
+        goto out_unlink;
+    }
+
+    INV(!atf_is_error(err));
+    goto out_temp;
+
+out_unlink:
+    (void)unlink(atf_fs_path_cstring(&temp));
+out_temp:
+    atf_fs_path_fini(&temp);
+out_in:
+    fclose(in);
+out:
+    return err;
+}
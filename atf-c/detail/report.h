@@ -0,0 +1,64 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_REPORT_H)
+#define ATF_C_DETAIL_REPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <atf-c/error_fwd.h>
+
+/* ---------------------------------------------------------------------
+ * The "atf_report" type.
+ * --------------------------------------------------------------------- */
+
+/* A JSON Lines stream with one record per completed test case, appended
+ * to as the test cases finish so that it never has to be held in memory.
+ * Converting it to JUnit XML is a separate step; see atf-junit(1). */
+struct atf_report {
+    int m_fd;
+    const char *m_program;
+    size_t m_unsynced;
+    char *m_path;
+};
+typedef struct atf_report atf_report_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_report_open(atf_report_t *, const char *, const char *);
+atf_error_t atf_report_open_from_env(atf_report_t *, const char *, bool *);
+atf_error_t atf_report_close(atf_report_t *);
+
+/* Modifiers. */
+atf_error_t atf_report_add(atf_report_t *, const char *, const char *,
+                           const char *);
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+atf_error_t atf_report_to_junit(const char *, const char *);
+
+#endif /* !defined(ATF_C_DETAIL_REPORT_H) */
@@ -0,0 +1,215 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/report.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/env.h"
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_report" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(add);
+ATF_TC_BODY(add, tc)
+{
+    atf_report_t r;
+
+    RE(atf_report_open(&r, "report", "prog"));
+    RE(atf_report_add(&r, "first", "passed", NULL));
+    RE(atf_report_add(&r, "second", "failed: Some \"quoted\"\n\treason",
+                      "time.body.duration: 1.500000\n"
+                      "io.rchar: 12\n"
+                      "custom.key: some text\n"));
+    RE(atf_report_add(&r, "third", "expected_exit(3): Reason", ""));
+    RE(atf_report_add(&r, "fourth", "expected_signal: Reason", NULL));
+    RE(atf_report_close(&r));
+
+    ATF_REQUIRE(atf_utils_compare_file("report",
+        "{\"program\": \"prog\", \"ident\": \"first\", "
+        "\"result\": \"passed\"}\n"
+        "{\"program\": \"prog\", \"ident\": \"second\", "
+        "\"result\": \"failed\", "
+        "\"reason\": \"Some \\\"quoted\\\"\\n\\treason\", "
+        "\"time.body.duration\": 1.500000, \"io.rchar\": 12, "
+        "\"custom.key\": \"some text\"}\n"
+        "{\"program\": \"prog\", \"ident\": \"third\", "
+        "\"result\": \"expected_exit\", \"arg\": 3, \"reason\": \"Reason\"}\n"
+        "{\"program\": \"prog\", \"ident\": \"fourth\", "
+        "\"result\": \"expected_signal\", \"reason\": \"Reason\"}\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(append);
+ATF_TC_BODY(append, tc)
+{
+    atf_report_t r;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        RE(atf_report_open(&r, "report", i == 0 ? "one" : "two"));
+        RE(atf_report_add(&r, "tc", "passed", NULL));
+        RE(atf_report_close(&r));
+    }
+
+    ATF_REQUIRE(atf_utils_compare_file("report",
+        "{\"program\": \"one\", \"ident\": \"tc\", \"result\": \"passed\"}\n"
+        "{\"program\": \"two\", \"ident\": \"tc\", \"result\": \"passed\"}\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(many);
+ATF_TC_BODY(many, tc)
+{
+    atf_report_t r;
+    char ident[16];
+    int i;
+
+    /* Crosses several sync batches. */
+    RE(atf_report_open(&r, "report", "prog"));
+    for (i = 0; i < 100; i++) {
+        snprintf(ident, sizeof(ident), "tc%d", i);
+        RE(atf_report_add(&r, ident, "passed", NULL));
+    }
+    RE(atf_report_close(&r));
+
+    ATF_REQUIRE(atf_utils_grep_file("\"ident\": \"tc0\"", "report"));
+    ATF_REQUIRE(atf_utils_grep_file("\"ident\": \"tc99\"", "report"));
+}
+
+ATF_TC_WITHOUT_HEAD(open_error);
+ATF_TC_BODY(open_error, tc)
+{
+    atf_report_t r;
+    atf_error_t err;
+
+    err = atf_report_open(&r, "missing/report", "prog");
+    ATF_REQUIRE(atf_is_error(err));
+    ATF_REQUIRE(atf_error_is(err, "libc"));
+    atf_error_free(err);
+}
+
+ATF_TC_WITHOUT_HEAD(open_from_env);
+ATF_TC_BODY(open_from_env, tc)
+{
+    atf_report_t r;
+    bool enabled;
+
+    RE(atf_env_unset("ATF_REPORT_FILE"));
+    RE(atf_report_open_from_env(&r, "prog", &enabled));
+    ATF_REQUIRE(!enabled);
+
+    RE(atf_env_set("ATF_REPORT_FILE", ""));
+    RE(atf_report_open_from_env(&r, "prog", &enabled));
+    ATF_REQUIRE(!enabled);
+
+    RE(atf_env_set("ATF_REPORT_FILE", "report"));
+    RE(atf_env_set("ATF_JUNIT_FILE", "junit.xml"));
+    RE(atf_report_open_from_env(&r, "prog", &enabled));
+    ATF_REQUIRE(enabled);
+    RE(atf_report_add(&r, "tc", "passed", NULL));
+    RE(atf_report_close(&r));
+
+    ATF_REQUIRE(atf_utils_grep_file("\"ident\": \"tc\"", "report"));
+    /* The conversion to JUnit XML is left to atf-junit. */
+    ATF_REQUIRE(!atf_utils_file_exists("junit.xml"));
+}
+
+/* ---------------------------------------------------------------------
+ * Tests for the free functions.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(to_junit);
+ATF_TC_BODY(to_junit, tc)
+{
+    atf_report_t r;
+
+    RE(atf_report_open(&r, "report", "prog"));
+    RE(atf_report_add(&r, "pass", "passed", "time.body.duration: 0.250000\n"));
+    RE(atf_report_add(&r, "fail", "failed: A <bad> & \"odd\"\nreason", NULL));
+    RE(atf_report_add(&r, "skip", "skipped: Not today", NULL));
+    RE(atf_report_add(&r, "broken", "broken: Premature exit", NULL));
+    RE(atf_report_add(&r, "expect", "expected_failure: Known bug", NULL));
+    RE(atf_report_close(&r));
+    {
+        FILE *f = fopen("report", "a");
+        ATF_REQUIRE(f != NULL);
+        fprintf(f, "not a record\n{\"ident\": \"x\"}\n");
+        fclose(f);
+    }
+
+    RE(atf_report_to_junit("report", "junit.xml"));
+    atf_utils_cat_file("junit.xml", "");
+
+    ATF_REQUIRE(atf_utils_compare_file("junit.xml",
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<testsuite name=\"atf\" tests=\"5\" failures=\"1\" errors=\"1\" "
+        "skipped=\"1\">\n"
+        "  <testcase classname=\"prog\" name=\"pass\" time=\"0.250000\"/>\n"
+        "  <testcase classname=\"prog\" name=\"fail\">\n"
+        "    <failure message=\"A &lt;bad&gt; &amp; &quot;odd&quot;&#10;"
+        "reason\"/>\n"
+        "  </testcase>\n"
+        "  <testcase classname=\"prog\" name=\"skip\">\n"
+        "    <skipped message=\"Not today\"/>\n"
+        "  </testcase>\n"
+        "  <testcase classname=\"prog\" name=\"broken\">\n"
+        "    <error message=\"Premature exit\"/>\n"
+        "  </testcase>\n"
+        "  <testcase classname=\"prog\" name=\"expect\"/>\n"
+        "</testsuite>\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(to_junit_missing);
+ATF_TC_BODY(to_junit_missing, tc)
+{
+    atf_error_t err;
+
+    err = atf_report_to_junit("missing", "junit.xml");
+    ATF_REQUIRE(atf_is_error(err));
+    atf_error_free(err);
+    ATF_REQUIRE(access("junit.xml", F_OK) == -1);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, add);
+    ATF_TP_ADD_TC(tp, append);
+    ATF_TP_ADD_TC(tp, many);
+    ATF_TP_ADD_TC(tp, open_error);
+    ATF_TP_ADD_TC(tp, open_from_env);
+    ATF_TP_ADD_TC(tp, to_junit);
+    ATF_TP_ADD_TC(tp, to_junit_missing);
+
+    return atf_no_error();
+}
@@ -0,0 +1,1469 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "atf-c/detail/runner.h"
+
+#include <sys/types.h>
+#if defined(HAVE_MEMFD_CREATE)
+#   include <sys/mman.h>
+#endif
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "atf-c/defs.h"
+#include "atf-c/detail/dynstr.h"
+#include "atf-c/detail/env.h"
+#include "atf-c/detail/fs.h"
+#include "atf-c/detail/history.h"
+#include "atf-c/detail/report.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/detail/text.h"
+#include "atf-c/detail/timeout.h"
+#include "atf-c/error.h"
+
+struct tc_entry {
+    const char *m_ident;
+    bool m_has_cleanup;
+    unsigned int m_timeout;
+};
+
+/* A test case waiting to be run, alongside its expected duration. */
+struct queued_tc {
+    const struct tc_entry *m_tc;
+    size_t m_pos;
+    bool m_known;
+    unsigned long m_msecs;
+};
+
+/* State of a test case that is being run by a worker. */
+struct slot {
+    const struct tc_entry *m_tc;
+    pid_t m_pid;
+    atf_fs_path_t m_ctldir;
+    int m_channel;
+    struct timespec m_start;
+
+    /* Outcomes of the attempts at running m_tc when reruns are enabled. */
+    size_t m_passes;
+    size_t m_failures;
+};
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+atf_error_t
+ctl_path(const atf_fs_path_t *ctldir, const char *name, atf_fs_path_t *path)
+{
+    return atf_fs_path_init_fmt(path, "%s/%s", atf_fs_path_cstring(ctldir),
+                                name);
+}
+
+/*
+ * Whether the output of a test case is captured in its control directory
+ * instead of going straight to the terminal.  This keeps the output of
+ * concurrent test cases apart and lets reruns hide failed attempts.
+ */
+static
+bool
+captures_output(const atf_runner_t *r)
+{
+    return r->m_jobs > 1 || r->m_reruns > 0;
+}
+
+static
+atf_error_t
+read_file(const char *path, atf_dynstr_t *contents)
+{
+    atf_error_t err;
+    char buf[512];
+    ssize_t cnt;
+    int fd;
+
+    err = atf_dynstr_init(contents);
+    if (atf_is_error(err))
+        goto out;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            atf_dynstr_fini(contents);
+            err = atf_libc_error(errno, "Cannot open %s", path);
+        }
+        goto out;
+    }
+
+    while (!atf_is_error(err) && (cnt = read(fd, buf, sizeof(buf))) != 0) {
+        if (cnt == -1) {
+            if (errno == EINTR)
+                continue;
+            err = atf_libc_error(errno, "Cannot read %s", path);
+        } else
+            err = atf_dynstr_append_mem(contents, buf, cnt);
+    }
+    close(fd);
+
+    if (atf_is_error(err))
+        atf_dynstr_fini(contents);
+out:
+    return err;
+}
+
+static
+atf_error_t
+write_file(const char *path, const char *contents)
+{
+    atf_error_t err;
+    size_t len;
+    ssize_t cnt;
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+        return atf_libc_error(errno, "Cannot create %s", path);
+
+    err = atf_no_error();
+    len = strlen(contents);
+    while (len > 0) {
+        cnt = write(fd, contents, len);
+        if (cnt == -1) {
+            if (errno == EINTR)
+                continue;
+            err = atf_libc_error(errno, "Cannot write to %s", path);
+            break;
+        }
+        contents += cnt;
+        len -= cnt;
+    }
+    close(fd);
+
+    return err;
+}
+
+/** Writes a result to a results file, which may be stdout or stderr. */
+static
+atf_error_t
+write_result(const char *path, const char *contents)
+{
+    int fd;
+
+    if (strcmp(path, "/dev/stdout") == 0)
+        fd = STDOUT_FILENO;
+    else if (strcmp(path, "/dev/stderr") == 0)
+        fd = STDERR_FILENO;
+    else
+        return write_file(path, contents);
+
+    if (write(fd, contents, strlen(contents)) == -1)
+        return atf_libc_error(errno, "Cannot write to %s", path);
+    return atf_no_error();
+}
+
+/* ---------------------------------------------------------------------
+ * Result channels.
+ * --------------------------------------------------------------------- */
+
+/*
+ * The result of a test case travels from its body to the supervisor, and
+ * from the supervisor to the runner, through an anonymous file inherited
+ * by the forked children.  The body refers to it as /dev/fd/N, which
+ * atf_tc_run writes to without opening anything, so no file has to be
+ * created, truncated or removed per test case.
+ */
+
+static
+atf_error_t
+channel_open(int *fd)
+{
+    atf_error_t err;
+    atf_fs_path_t path;
+
+#if defined(HAVE_MEMFD_CREATE)
+    *fd = memfd_create("atf-result", MFD_CLOEXEC);
+    if (*fd != -1)
+        return atf_no_error();
+#endif
+
+    /* Fall back to a file that is unlinked right away, whatever the reason
+     * memfd_create failed for: ENOSYS, EPERM from a seccomp filter... */
+    err = atf_fs_path_init_fmt(&path, "%s/atf-result.XXXXXX",
+                               atf_env_get_with_default("TMPDIR", "/tmp"));
+    if (atf_is_error(err))
+        return err;
+    err = atf_fs_mkstemp(&path, fd);
+    if (!atf_is_error(err)) {
+        (void)unlink(atf_fs_path_cstring(&path));
+        (void)fcntl(*fd, F_SETFD, FD_CLOEXEC);
+    }
+    atf_fs_path_fini(&path);
+    return err;
+}
+
+static
+atf_error_t
+channel_path(const int fd, atf_fs_path_t *path)
+{
+    return atf_fs_path_init_fmt(path, "/dev/fd/%d", fd);
+}
+
+static
+atf_error_t
+channel_read(const int fd, atf_dynstr_t *contents)
+{
+    atf_error_t err;
+    char buf[512];
+    off_t off = 0;
+    ssize_t cnt;
+
+    err = atf_dynstr_init(contents);
+    if (atf_is_error(err))
+        return err;
+
+    while (!atf_is_error(err) && (cnt = pread(fd, buf, sizeof(buf), off))
+           != 0) {
+        if (cnt == -1) {
+            if (errno != EINTR)
+                err = atf_libc_error(errno, "Cannot read result channel");
+        } else {
+            err = atf_dynstr_append_mem(contents, buf, cnt);
+            off += cnt;
+        }
+    }
+
+    if (atf_is_error(err))
+        atf_dynstr_fini(contents);
+    return err;
+}
+
+static
+atf_error_t
+channel_write(const int fd, const char *contents)
+{
+    size_t len = strlen(contents);
+    off_t off = 0;
+    ssize_t cnt;
+
+    if (ftruncate(fd, 0) == -1)
+        return atf_libc_error(errno, "Cannot truncate result channel");
+
+    while (len > 0) {
+        cnt = pwrite(fd, contents, len, off);
+        if (cnt == -1) {
+            if (errno == EINTR)
+                continue;
+            return atf_libc_error(errno, "Cannot write to result channel");
+        }
+        contents += cnt;
+        off += cnt;
+        len -= cnt;
+    }
+    return atf_no_error();
+}
+
+static
+void
+copy_fd_contents(const char *path, const int outfd)
+{
+    char buf[4096];
+    ssize_t cnt;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return;
+
+    while ((cnt = read(fd, buf, sizeof(buf))) > 0 ||
+           (cnt == -1 && errno == EINTR)) {
+        if (cnt > 0 && write(outfd, buf, cnt) == -1)
+            break;
+    }
+    close(fd);
+}
+
+/** Recursively removes a directory.
+ *
+ * Test cases may leave behind read-only directories, so every directory is
+ * made accessible before being traversed.  Errors are ignored: there is
+ * nothing sensible that the caller can do about leftover files.
+ */
+static
+void
+remove_tree(const char *path)
+{
+    struct stat sb;
+    DIR *dir;
+    struct dirent *de;
+
+    if (lstat(path, &sb) == -1)
+        return;
+
+    if (!S_ISDIR(sb.st_mode)) {
+        (void)unlink(path);
+        return;
+    }
+
+    (void)chmod(path, S_IRWXU);
+    dir = opendir(path);
+    if (dir != NULL) {
+        while ((de = readdir(dir)) != NULL) {
+            char *subpath;
+
+            if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+                continue;
+
+            if (atf_is_error(atf_text_format(&subpath, "%s/%s", path,
+                                             de->d_name)))
+                continue;  /* Leak the error; see above. */
+            remove_tree(subpath);
+            free(subpath);
+        }
+        closedir(dir);
+    }
+    (void)rmdir(path);
+}
+
+/** Redirects a file descriptor to a file, appending to its contents. */
+static
+void
+append_to(const int target_fd, const char *path)
+{
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    if (fd != target_fd) {
+        if (dup2(fd, target_fd) == -1) {
+            fprintf(stderr, "Cannot redirect fd %d: %s\n", target_fd,
+                    strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * Result calculation.
+ * --------------------------------------------------------------------- */
+
+static
+bool
+result_is_good(const char *result)
+{
+    return strncmp(result, "passed", 6) == 0 ||
+           strncmp(result, "skipped", 7) == 0 ||
+           strncmp(result, "expected_", 9) == 0;
+}
+
+static
+atf_error_t
+format_status(const int status, atf_dynstr_t *out)
+{
+    if (WIFEXITED(status))
+        return atf_dynstr_init_fmt(out, "exited with code %d",
+                                   WEXITSTATUS(status));
+    else {
+        INV(WIFSIGNALED(status));
+        return atf_dynstr_init_fmt(out, "received signal %d%s",
+                                   WTERMSIG(status),
+                                   WCOREDUMP(status) ? " (core dumped)" : "");
+    }
+}
+
+/** Returns whether a line is a "key: value" line of the extended results
+ * format, whose keys are made of lowercase words separated by dots. */
+static
+bool
+is_extended_line(const char *line)
+{
+    const char *ptr;
+    bool dot = false;
+
+    for (ptr = line; (*ptr >= 'a' && *ptr <= 'z') || *ptr == '.' ||
+         *ptr == '_'; ptr++) {
+        if (*ptr == '.')
+            dot = true;
+    }
+    return dot && ptr != line && *line != '.' && *ptr == ':' &&
+        *(ptr + 1) == ' ';
+}
+
+/** Finds the newline that ends the result in a results file.
+ *
+ * The result usually fits in a single line, but kyua(1) accepts reasons that
+ * span several lines, so only the lines of the extended results format that
+ * follow the result are discarded.  Returns NULL if the result is not
+ * followed by a newline. */
+static
+const char *
+find_extended_lines(const char *contents)
+{
+    const char *nl;
+
+    for (nl = strchr(contents, '\n'); nl != NULL; nl = strchr(nl + 1, '\n'))
+    {
+        if (*(nl + 1) == '\0' || is_extended_line(nl + 1))
+            return nl;
+    }
+    return NULL;
+}
+
+/** Splits the contents of a results file in place into the result and the
+ * lines of the extended results format that follow it, if any. */
+static
+atf_error_t
+split_result(atf_dynstr_t *contents, atf_dynstr_t *extra)
+{
+    atf_error_t err;
+    atf_dynstr_t tmp;
+    const char *nl;
+    size_t pos;
+
+    nl = find_extended_lines(atf_dynstr_cstring(contents));
+    if (nl == NULL)
+        return atf_dynstr_init(extra);
+    pos = nl - atf_dynstr_cstring(contents);
+
+    err = atf_dynstr_init_substr(extra, contents, pos + 1, atf_dynstr_npos);
+    if (atf_is_error(err))
+        return err;
+    err = atf_dynstr_init_substr(&tmp, contents, 0, pos);
+    if (atf_is_error(err)) {
+        atf_dynstr_fini(extra);
+        return err;
+    }
+    atf_dynstr_fini(contents);
+    *contents = tmp;
+    return atf_no_error();
+}
+
+/** Parses the optional "(arg)" that follows an expected_exit or
+ * expected_signal result and returns -1 if there is none. */
+static
+int
+parse_result_arg(const char *rest)
+{
+    long arg;
+
+    if (*rest != '(')
+        return -1;
+
+    arg = strtol(rest + 1, NULL, 10);
+    return (int)arg;
+}
+
+/** Combines the results file written by a test case body with its exit
+ * status to compute the final result of the test case.  The lines of the
+ * extended results format, if any, are returned separately in extra.
+ *
+ * The rules in here mimic those applied by kyua(1) so that test cases run
+ * by the test program itself are reported the same way as if they had been
+ * run by an external runtime engine.
+ */
+static
+atf_error_t
+calculate_result(const int channel, const int status, atf_dynstr_t *out,
+                 atf_dynstr_t *extra)
+{
+    atf_error_t err;
+    atf_dynstr_t raw, st;
+    const char *result;
+
+    err = channel_read(channel, &raw);
+    if (atf_is_error(err))
+        goto out;
+
+    err = format_status(status, &st);
+    if (atf_is_error(err))
+        goto out_raw;
+
+    err = split_result(&raw, extra);
+    if (atf_is_error(err))
+        goto out_st;
+    result = atf_dynstr_cstring(&raw);
+
+    if (*result == '\0') {
+        err = atf_dynstr_init_fmt(out, "broken: Premature exit; test case %s",
+                                  atf_dynstr_cstring(&st));
+    } else if (strncmp(result, "expected_death", 14) == 0) {
+        err = atf_dynstr_copy(out, &raw);
+    } else if (strncmp(result, "expected_exit", 13) == 0) {
+        const int arg = parse_result_arg(result + 13);
+        if (WIFEXITED(status) && (arg == -1 || WEXITSTATUS(status) == arg))
+            err = atf_dynstr_copy(out, &raw);
+        else if (arg == -1)
+            err = atf_dynstr_init_fmt(out, "failed: Test case expected to "
+                                      "exit cleanly but %s",
+                                      atf_dynstr_cstring(&st));
+        else
+            err = atf_dynstr_init_fmt(out, "failed: Test case expected to "
+                                      "exit with code %d but %s", arg,
+                                      atf_dynstr_cstring(&st));
+    } else if (strncmp(result, "expected_signal", 15) == 0) {
+        const int arg = parse_result_arg(result + 15);
+        if (WIFSIGNALED(status) && (arg == -1 || WTERMSIG(status) == arg))
+            err = atf_dynstr_copy(out, &raw);
+        else if (arg == -1)
+            err = atf_dynstr_init_fmt(out, "failed: Test case expected to "
+                                      "receive a signal but %s",
+                                      atf_dynstr_cstring(&st));
+        else
+            err = atf_dynstr_init_fmt(out, "failed: Test case expected to "
+                                      "receive signal %d but %s", arg,
+                                      atf_dynstr_cstring(&st));
+    } else if (strncmp(result, "expected_timeout", 16) == 0) {
+        err = atf_dynstr_init_fmt(out, "failed: Test case expected to time "
+                                  "out but %s", atf_dynstr_cstring(&st));
+    } else if (WIFSIGNALED(status)) {
+        err = atf_dynstr_init_fmt(out, "broken: Test case reported '%s' but "
+                                  "%s", result, atf_dynstr_cstring(&st));
+    } else if (strncmp(result, "failed", 6) == 0) {
+        if (WEXITSTATUS(status) == EXIT_SUCCESS)
+            err = atf_dynstr_init_fmt(out, "broken: Failed test case should "
+                                      "have exited with a failure code");
+        else
+            err = atf_dynstr_copy(out, &raw);
+    } else if (result_is_good(result)) {
+        if (WEXITSTATUS(status) != EXIT_SUCCESS)
+            err = atf_dynstr_init_fmt(out, "broken: Test case reported '%s' "
+                                      "but %s", result,
+                                      atf_dynstr_cstring(&st));
+        else
+            err = atf_dynstr_copy(out, &raw);
+    } else {
+        err = atf_dynstr_init_fmt(out, "broken: Unknown result '%s'", result);
+    }
+    if (atf_is_error(err))
+        atf_dynstr_fini(extra);
+
+out_st:
+    atf_dynstr_fini(&st);
+out_raw:
+    atf_dynstr_fini(&raw);
+out:
+    return err;
+}
+
+/** Determines the result of a test case whose body was killed on timeout.
+ *
+ * Test cases that expect to time out record their expectation before
+ * blocking, so their results file is honored in that case.
+ */
+static
+atf_error_t
+timed_out_result(const int channel, const unsigned int timeout,
+                 atf_dynstr_t *out)
+{
+    atf_error_t err;
+    atf_dynstr_t raw;
+
+    err = channel_read(channel, &raw);
+    if (atf_is_error(err))
+        return err;
+
+    if (strncmp(atf_dynstr_cstring(&raw), "expected_timeout", 16) == 0)
+        err = atf_dynstr_copy(out, &raw);
+    else
+        err = atf_dynstr_init_fmt(out, "failed: Test case timed out after %u "
+                                  "seconds\n", timeout);
+
+    atf_dynstr_fini(&raw);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Test case supervision.
+ * --------------------------------------------------------------------- */
+
+/* The part of the test case that the supervisor is waiting for, if any,
+ * and the SIGTERM disposition to restore in the parts. */
+static volatile sig_atomic_t Part_pid = 0;
+static struct sigaction Old_sigterm;
+
+static void kill_part(const int)
+    ATF_DEFS_ATTRIBUTE_NORETURN;
+static void run_part_child(const atf_runner_t *, const struct tc_entry *,
+                           const bool, const atf_fs_path_t *, const int)
+    ATF_DEFS_ATTRIBUTE_NORETURN;
+static void supervise(const atf_runner_t *, const struct tc_entry *,
+                      const atf_fs_path_t *, const int)
+    ATF_DEFS_ATTRIBUTE_NORETURN;
+
+/** Terminates the supervisor along with the part it is running.
+ *
+ * The runner sends SIGTERM to the supervisors of the test cases that are
+ * still running when it bails out. */
+static
+void
+kill_part(const int signo ATF_DEFS_ATTRIBUTE_UNUSED)
+{
+    const pid_t pid = (pid_t)Part_pid;
+
+    if (pid > 0) {
+        (void)kill(-pid, SIGKILL);  /* Its own group if under a timeout. */
+        (void)kill(pid, SIGKILL);
+    }
+    _exit(EXIT_FAILURE);
+}
+
+static
+void
+run_part_child(const atf_runner_t *r, const struct tc_entry *tc,
+               const bool cleanup, const atf_fs_path_t *ctldir,
+               const int channel)
+{
+    atf_fs_path_t resfile, workdir;
+    atf_error_t err;
+
+    err = ctl_path(ctldir, "work", &workdir);
+    if (!atf_is_error(err))
+        err = channel_path(channel, &resfile);
+    if (atf_is_error(err)) {
+        char buf[1024];
+        atf_error_format(err, buf, sizeof(buf));
+        fprintf(stderr, "%s\n", buf);
+        exit(EXIT_FAILURE);
+    }
+
+    if (chdir(atf_fs_path_cstring(&workdir)) == -1) {
+        fprintf(stderr, "Cannot enter %s: %s\n",
+                atf_fs_path_cstring(&workdir), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    (void)atf_env_set("TMPDIR", atf_fs_path_cstring(&workdir));
+
+    {
+        const int fd = open("/dev/null", O_RDONLY);
+        if (fd != -1 && fd != STDIN_FILENO) {
+            (void)dup2(fd, STDIN_FILENO);
+            close(fd);
+        }
+    }
+
+    if (captures_output(r)) {
+        atf_fs_path_t path;
+
+        if (!atf_is_error(ctl_path(ctldir, "stdout", &path))) {
+            append_to(STDOUT_FILENO, atf_fs_path_cstring(&path));
+            atf_fs_path_fini(&path);
+        }
+        if (!atf_is_error(ctl_path(ctldir, "stderr", &path))) {
+            append_to(STDERR_FILENO, atf_fs_path_cstring(&path));
+            atf_fs_path_fini(&path);
+        }
+    }
+
+    /* Allow the supervisor to kill anything the part spawns on timeout. */
+    if (tc->m_timeout > 0)
+        (void)setpgid(0, 0);
+
+    r->m_part(r->m_data, tc->m_ident, cleanup,
+              cleanup ? NULL : atf_fs_path_cstring(&resfile));
+
+    /* The body is not supposed to return; if it does, the lack of a result
+     * will make the test case broken. */
+    fflush(stdout);
+    fflush(stderr);
+    exit(EXIT_SUCCESS);
+}
+
+static
+atf_error_t
+run_part(const atf_runner_t *r, const struct tc_entry *tc, const bool cleanup,
+         const atf_fs_path_t *ctldir, const int channel, int *status,
+         bool *timed_out)
+{
+    atf_error_t err;
+    sigset_t mask, old_mask;
+    pid_t pid;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    /* Do not let SIGTERM arrive before Part_pid is known. */
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    (void)sigprocmask(SIG_BLOCK, &mask, &old_mask);
+
+    pid = fork();
+    if (pid == -1) {
+        err = atf_libc_error(errno, "Failed to fork");
+        (void)sigprocmask(SIG_SETMASK, &old_mask, NULL);
+        return err;
+    } else if (pid == 0) {
+        (void)sigaction(SIGTERM, &Old_sigterm, NULL);
+        (void)sigprocmask(SIG_SETMASK, &old_mask, NULL);
+        run_part_child(r, tc, cleanup, ctldir, channel);
+        UNREACHABLE;
+    }
+
+    Part_pid = pid;
+    (void)sigprocmask(SIG_SETMASK, &old_mask, NULL);
+
+    if (tc->m_timeout > 0)
+        (void)setpgid(pid, pid);
+    err = atf_timeout_wait(pid, tc->m_timeout, status, timed_out);
+    Part_pid = 0;
+    return err;
+}
+
+/** Runs a test case within a supervisor process.
+ *
+ * The supervisor executes the body of the test case and, if it has one, its
+ * cleanup routine, each in their own subprocess.  The body writes its result
+ * to the given channel, which the supervisor then replaces with the final
+ * result of the test case so that the parent runner can collect it.
+ */
+static
+void
+supervise(const atf_runner_t *r, const struct tc_entry *tc,
+          const atf_fs_path_t *ctldir, const int channel)
+{
+    atf_error_t err;
+    atf_dynstr_t result, extra;
+    struct sigaction sa;
+    bool timed_out;
+    int status;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = kill_part;
+    sigemptyset(&sa.sa_mask);
+    (void)sigaction(SIGTERM, &sa, &Old_sigterm);
+
+    err = run_part(r, tc, false, ctldir, channel, &status, &timed_out);
+    if (atf_is_error(err))
+        goto out;
+
+    if (timed_out) {
+        err = atf_dynstr_init(&extra);
+        if (atf_is_error(err))
+            goto out;
+        err = timed_out_result(channel, tc->m_timeout, &result);
+        if (atf_is_error(err))
+            atf_dynstr_fini(&extra);
+    } else
+        err = calculate_result(channel, status, &result, &extra);
+    if (atf_is_error(err))
+        goto out;
+
+    if (tc->m_has_cleanup) {
+        err = run_part(r, tc, true, ctldir, channel, &status, &timed_out);
+        if (!atf_is_error(err) && timed_out) {
+            atf_dynstr_fini(&result);
+            err = atf_dynstr_init_fmt(&result, "broken: Test case cleanup "
+                                      "timed out after %u seconds",
+                                      tc->m_timeout);
+            if (atf_is_error(err))
+                goto out_extra;
+        } else if (!atf_is_error(err)
+            && result_is_good(atf_dynstr_cstring(&result))
+            && (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            atf_dynstr_fini(&result);
+            err = atf_dynstr_init_fmt(&result, "broken: Test case cleanup "
+                                      "did not terminate successfully");
+            if (atf_is_error(err))
+                goto out_extra;
+        }
+    }
+
+    /* Keep the extended lines so that they can go into the report. */
+    if (!atf_is_error(err) && atf_dynstr_length(&extra) > 0)
+        err = atf_dynstr_append_fmt(&result, "\n%s",
+                                    atf_dynstr_cstring(&extra));
+    if (!atf_is_error(err))
+        err = channel_write(channel, atf_dynstr_cstring(&result));
+    atf_dynstr_fini(&result);
+out_extra:
+    atf_dynstr_fini(&extra);
+
+out:
+    if (atf_is_error(err)) {
+        char buf[1024];
+        atf_error_format(err, buf, sizeof(buf));
+        fprintf(stderr, "Test case supervisor failed: %s\n", buf);
+        atf_error_free(err);
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
+
+/* ---------------------------------------------------------------------
+ * Scheduling.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Orders test cases longest first, as in the LPT (longest processing time)
+ * heuristic: handing the next test case in this order to whichever worker
+ * becomes idle keeps a slow test case from being started last and
+ * dominating the wall time of the run.  Test cases without a recorded
+ * duration go first, as they could be the slowest of all, and ties keep the
+ * order in which the test cases were queued.
+ */
+static
+int
+compare_queued_tcs(const void *a, const void *b)
+{
+    const struct queued_tc *qa = a;
+    const struct queued_tc *qb = b;
+
+    if (qa->m_known != qb->m_known)
+        return qa->m_known ? 1 : -1;
+    if (qa->m_known && qa->m_msecs != qb->m_msecs)
+        return qa->m_msecs > qb->m_msecs ? -1 : 1;
+    return qa->m_pos < qb->m_pos ? -1 : (qa->m_pos > qb->m_pos);
+}
+
+/*
+ * Returns the queued test cases in the order in which they should start.
+ * Without a history, this is the order in which they were queued.
+ */
+static
+atf_error_t
+schedule_tcs(const atf_runner_t *r, struct queued_tc **queuep, size_t *countp)
+{
+    atf_list_citer_t iter;
+    struct queued_tc *queue;
+    size_t count;
+
+    queue = calloc(atf_list_size(&r->m_tcs) + 1, sizeof(*queue));
+    if (queue == NULL)
+        return atf_no_memory_error();
+
+    count = 0;
+    atf_list_for_each_c(iter, &r->m_tcs) {
+        struct queued_tc *q = &queue[count];
+
+        q->m_tc = atf_list_citer_data(iter);
+        q->m_pos = count;
+        q->m_known = r->m_history != NULL &&
+            atf_history_get(r->m_history, q->m_tc->m_ident, &q->m_msecs);
+        count++;
+    }
+
+    if (r->m_history != NULL)
+        qsort(queue, count, sizeof(*queue), compare_queued_tcs);
+
+    *queuep = queue;
+    *countp = count;
+    return atf_no_error();
+}
+
+static
+unsigned long
+msecs_since(const struct timespec *start)
+{
+    struct timespec now;
+    long msecs;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    msecs = (now.tv_sec - start->tv_sec) * 1000 +
+            (now.tv_nsec - start->tv_nsec) / 1000000;
+    return msecs > 0 ? (unsigned long)msecs : 0;
+}
+
+/* ---------------------------------------------------------------------
+ * Worker slots.
+ * --------------------------------------------------------------------- */
+
+static
+atf_error_t
+create_ctldir(atf_fs_path_t *ctldir)
+{
+    atf_error_t err;
+    atf_fs_path_t workdir;
+
+    err = atf_fs_path_init_fmt(ctldir, "%s/atf-run.XXXXXX",
+                               atf_env_get_with_default("TMPDIR", "/tmp"));
+    if (atf_is_error(err))
+        goto out;
+
+    if (!atf_fs_path_is_absolute(ctldir)) {
+        atf_fs_path_t abs;
+
+        err = atf_fs_path_to_absolute(ctldir, &abs);
+        if (atf_is_error(err))
+            goto err_ctldir;
+        atf_fs_path_fini(ctldir);
+        *ctldir = abs;
+    }
+
+    err = atf_fs_mkdtemp(ctldir);
+    if (atf_is_error(err))
+        goto err_ctldir;
+
+    err = ctl_path(ctldir, "work", &workdir);
+    if (atf_is_error(err))
+        goto err_mkdtemp;
+
+    if (mkdir(atf_fs_path_cstring(&workdir), 0755) == -1)
+        err = atf_libc_error(errno, "Cannot create work directory %s",
+                             atf_fs_path_cstring(&workdir));
+    atf_fs_path_fini(&workdir);
+    if (atf_is_error(err))
+        goto err_mkdtemp;
+
+    INV(!atf_is_error(err));
+    goto out;
+
+err_mkdtemp:
+    remove_tree(atf_fs_path_cstring(ctldir));
+err_ctldir:
+    atf_fs_path_fini(ctldir);
+out:
+    return err;
+}
+
+static
+atf_error_t
+slot_start(struct slot *s, const atf_runner_t *r, const struct tc_entry *tc)
+{
+    atf_error_t err;
+
+    err = create_ctldir(&s->m_ctldir);
+    if (atf_is_error(err))
+        return err;
+
+    err = channel_open(&s->m_channel);
+    if (atf_is_error(err)) {
+        remove_tree(atf_fs_path_cstring(&s->m_ctldir));
+        atf_fs_path_fini(&s->m_ctldir);
+        return err;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    s->m_pid = fork();
+    if (s->m_pid == -1) {
+        err = atf_libc_error(errno, "Failed to fork");
+        close(s->m_channel);
+        remove_tree(atf_fs_path_cstring(&s->m_ctldir));
+        atf_fs_path_fini(&s->m_ctldir);
+        return err;
+    } else if (s->m_pid == 0) {
+        supervise(r, tc, &s->m_ctldir, s->m_channel);
+        UNREACHABLE;
+    }
+
+    s->m_tc = tc;
+    (void)clock_gettime(CLOCK_MONOTONIC, &s->m_start);
+    return atf_no_error();
+}
+
+static
+void
+slot_release(struct slot *s)
+{
+    close(s->m_channel);
+    remove_tree(atf_fs_path_cstring(&s->m_ctldir));
+    atf_fs_path_fini(&s->m_ctldir);
+    s->m_tc = NULL;
+}
+
+/** Appends the outcomes of the attempts at running a test case to its
+ * extended result lines.
+ *
+ * A test case that failed every time is a deterministic failure, and one
+ * that passed after failing is flaky. */
+static
+atf_error_t
+append_rerun_lines(const struct slot *s, atf_dynstr_t *extra)
+{
+    const char *class;
+
+    if (s->m_failures == 0)
+        class = "stable";
+    else if (s->m_passes == 0)
+        class = "deterministic";
+    else
+        class = "flaky";
+
+    return atf_dynstr_append_fmt(extra, "%srerun.passes: %zu\n"
+                                 "rerun.failures: %zu\nrerun.class: %s",
+                                 atf_dynstr_length(extra) > 0 ? "\n" : "",
+                                 s->m_passes, s->m_failures, class);
+}
+
+/** Collects the result of a finished test case and reports it.
+ *
+ * The result line is appended to the summary file descriptor as
+ * "ident: result", with any newlines in the reason escaped so that there is
+ * exactly one line per test case, and the full result is added to the
+ * report if there is one.  Returns whether the test case succeeded through
+ * the ok argument.
+ *
+ * If the test case failed and has reruns left, nothing is reported yet:
+ * the test case is started again in the same slot and restarted is set.
+ */
+static
+atf_error_t
+slot_finish(struct slot *s, const atf_runner_t *r, const int status,
+            const int outfd, bool *ok, bool *restarted)
+{
+    atf_error_t err;
+    atf_fs_path_t path;
+    atf_dynstr_t result, extra, line;
+    const char *ptr, *end;
+
+    *restarted = false;
+
+    err = channel_read(s->m_channel, &result);
+    if (atf_is_error(err))
+        goto out;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS ||
+        atf_dynstr_length(&result) == 0) {
+        atf_dynstr_t st;
+
+        atf_dynstr_fini(&result);
+        err = format_status(status, &st);
+        if (atf_is_error(err))
+            goto out;
+        err = atf_dynstr_init_fmt(&result, "broken: Test case supervisor %s",
+                                  atf_dynstr_cstring(&st));
+        atf_dynstr_fini(&st);
+        if (atf_is_error(err))
+            goto out;
+    }
+
+    if (result_is_good(atf_dynstr_cstring(&result)))
+        s->m_passes++;
+    else if (s->m_failures++ < r->m_reruns) {
+        const struct tc_entry *tc = s->m_tc;
+
+        atf_dynstr_fini(&result);
+        slot_release(s);
+        err = slot_start(s, r, tc);
+        *restarted = !atf_is_error(err);
+        return err;
+    }
+
+    /* Only the output of the last attempt is shown. */
+    if (captures_output(r)) {
+        err = ctl_path(&s->m_ctldir, "stdout", &path);
+        if (atf_is_error(err))
+            goto out_result;
+        copy_fd_contents(atf_fs_path_cstring(&path), STDOUT_FILENO);
+        atf_fs_path_fini(&path);
+
+        err = ctl_path(&s->m_ctldir, "stderr", &path);
+        if (atf_is_error(err))
+            goto out_result;
+        copy_fd_contents(atf_fs_path_cstring(&path), STDERR_FILENO);
+        atf_fs_path_fini(&path);
+    }
+
+    if (s->m_passes > 0 && s->m_failures > 0)
+        fprintf(stderr, "%s: flaky: passed after %zu failed attempts\n",
+                s->m_tc->m_ident, s->m_failures);
+
+    err = split_result(&result, &extra);
+    if (!atf_is_error(err) && r->m_reruns > 0) {
+        err = append_rerun_lines(s, &extra);
+        if (atf_is_error(err))
+            atf_dynstr_fini(&extra);
+    }
+    if (atf_is_error(err))
+        goto out_result;
+
+    err = atf_dynstr_init_fmt(&line, "%s: ", s->m_tc->m_ident);
+    if (atf_is_error(err))
+        goto out_extra;
+    for (ptr = atf_dynstr_cstring(&result); !atf_is_error(err) && *ptr != '\0';
+         ptr = end) {
+        end = strchr(ptr, '\n');
+        if (end == NULL)
+            end = ptr + strlen(ptr);
+        err = atf_dynstr_append_mem(&line, ptr, end - ptr);
+        if (*end == '\n') {
+            end++;
+            if (!atf_is_error(err) && *end != '\0')
+                err = atf_dynstr_append_fmt(&line, "<<NEWLINE>>");
+        }
+    }
+    if (!atf_is_error(err))
+        err = atf_dynstr_append_fmt(&line, "\n");
+    if (!atf_is_error(err)) {
+        if (write(outfd, atf_dynstr_cstring(&line),
+                  atf_dynstr_length(&line)) == -1)
+            err = atf_libc_error(errno, "Cannot write test case result");
+    }
+    atf_dynstr_fini(&line);
+
+    if (!atf_is_error(err) && r->m_report != NULL)
+        err = atf_report_add(r->m_report, s->m_tc->m_ident,
+                             atf_dynstr_cstring(&result),
+                             atf_dynstr_cstring(&extra));
+
+    *ok = result_is_good(atf_dynstr_cstring(&result));
+
+out_extra:
+    atf_dynstr_fini(&extra);
+out_result:
+    atf_dynstr_fini(&result);
+out:
+    slot_release(s);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_runner" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_runner_init(atf_runner_t *r, atf_runner_part_t part, void *data)
+{
+    r->m_part = part;
+    r->m_data = data;
+    r->m_jobs = 1;
+    r->m_reruns = 0;
+    r->m_history = NULL;
+    r->m_report = NULL;
+    return atf_list_init(&r->m_tcs);
+}
+
+void
+atf_runner_fini(atf_runner_t *r)
+{
+    atf_list_fini(&r->m_tcs);
+}
+
+/*
+ * Modifiers.
+ */
+
+/** Queues a test case for execution.
+ *
+ * The identifier is not copied, so it must remain valid for as long as the
+ * runner is alive.  If timeout is not 0, the body and the cleanup routine of
+ * the test case are each killed if they run for longer than that many
+ * seconds.
+ */
+atf_error_t
+atf_runner_add_tc(atf_runner_t *r, const char *ident, const bool has_cleanup,
+                  const unsigned int timeout)
+{
+    struct tc_entry *tc;
+    atf_error_t err;
+
+    tc = malloc(sizeof(*tc));
+    if (tc == NULL)
+        return atf_no_memory_error();
+    tc->m_ident = ident;
+    tc->m_has_cleanup = has_cleanup;
+    tc->m_timeout = timeout;
+
+    err = atf_list_append(&r->m_tcs, tc, true);
+    if (atf_is_error(err))
+        free(tc);
+    return err;
+}
+
+/** Schedules the test cases by their durations in the given history, and
+ * records in it how long each of them takes to run.
+ *
+ * The history is not owned by the runner and must outlive it.
+ */
+void
+atf_runner_set_history(atf_runner_t *r, atf_history_t *h)
+{
+    r->m_history = h;
+}
+
+void
+atf_runner_set_jobs(atf_runner_t *r, const size_t jobs)
+{
+    PRE(jobs > 0);
+    r->m_jobs = jobs;
+}
+
+/** Reruns every failing test case up to the given number of times.
+ *
+ * A test case that passes on a rerun is reported with its passing result,
+ * and the number of passed and failed attempts of every test case goes
+ * into its extended result lines.
+ */
+void
+atf_runner_set_reruns(atf_runner_t *r, const size_t reruns)
+{
+    r->m_reruns = reruns;
+}
+
+/** Adds a record to the given report for every test case that finishes.
+ *
+ * The report is not owned by the runner and must outlive it.
+ */
+void
+atf_runner_set_report(atf_runner_t *r, atf_report_t *report)
+{
+    r->m_report = report;
+}
+
+/*
+ * Operations.
+ */
+
+/** Runs all queued test cases.
+ *
+ * Up to m_jobs test cases run concurrently, each forked from the current
+ * process and executed in a fresh work directory.  One "ident: result" line
+ * per test case is written to resfile in completion order.  all_ok is set to
+ * false if any of the test cases failed or was broken.
+ *
+ * If the runner has a history, test cases start longest first and their
+ * wall times are recorded in it as they finish.
+ */
+atf_error_t
+atf_runner_run(const atf_runner_t *r, const char *resfile, bool *all_ok)
+{
+    atf_error_t err;
+    struct queued_tc *queue = NULL;
+    struct slot *slots;
+    size_t active, i, next, count = 0;
+    int outfd;
+
+    if (strcmp(resfile, "/dev/stdout") == 0)
+        outfd = STDOUT_FILENO;
+    else if (strcmp(resfile, "/dev/stderr") == 0)
+        outfd = STDERR_FILENO;
+    else {
+        outfd = open(resfile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (outfd == -1)
+            return atf_libc_error(errno, "Cannot create results file '%s'",
+                                  resfile);
+    }
+
+    err = schedule_tcs(r, &queue, &count);
+    if (atf_is_error(err))
+        goto out_fd;
+
+    slots = calloc(r->m_jobs, sizeof(*slots));
+    if (slots == NULL) {
+        err = atf_no_memory_error();
+        goto out_queue;
+    }
+
+    *all_ok = true;
+    active = 0;
+    next = 0;
+    while (!atf_is_error(err) && (active > 0 || next < count)) {
+        int status;
+        pid_t pid;
+
+        for (i = 0; i < r->m_jobs && next < count; i++) {
+            if (slots[i].m_tc != NULL)
+                continue;
+
+            slots[i].m_passes = 0;
+            slots[i].m_failures = 0;
+            err = slot_start(&slots[i], r, queue[next].m_tc);
+            if (atf_is_error(err))
+                break;
+            active++;
+            next++;
+        }
+        if (atf_is_error(err) || active == 0)
+            break;
+
+        pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno != EINTR)
+                err = atf_libc_error(errno, "Failed to wait for test cases");
+            continue;
+        }
+
+        for (i = 0; i < r->m_jobs; i++) {
+            if (slots[i].m_tc != NULL && slots[i].m_pid == pid) {
+                bool ok = false, restarted = false;
+
+                if (r->m_history != NULL)
+                    err = atf_history_set(r->m_history,
+                                          slots[i].m_tc->m_ident,
+                                          msecs_since(&slots[i].m_start));
+                if (!atf_is_error(err))
+                    err = slot_finish(&slots[i], r, status, outfd, &ok,
+                                      &restarted);
+                if (restarted)
+                    break;
+                if (!ok)
+                    *all_ok = false;
+                active--;
+                break;
+            }
+        }
+    }
+
+    /* Do not leave orphaned supervisors behind if we bailed out early, nor
+     * wait for test cases that may never finish. */
+    for (i = 0; i < r->m_jobs; i++) {
+        if (slots[i].m_tc != NULL) {
+            int status;
+
+            (void)kill(slots[i].m_pid, SIGTERM);
+            (void)waitpid(slots[i].m_pid, &status, 0);
+            slot_release(&slots[i]);
+        }
+    }
+    free(slots);
+
+out_queue:
+    free(queue);
+out_fd:
+    if (outfd != STDOUT_FILENO && outfd != STDERR_FILENO)
+        close(outfd);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/** Adds the results file of a test case run outside of a runner to a
+ * report.
+ *
+ * The result is taken as written by the test case, as in the batch mode of
+ * test programs, except that a missing or empty results file is reported
+ * as a premature exit.
+ */
+atf_error_t
+atf_runner_report_resfile(atf_report_t *report, const char *ident,
+                          const char *resfile)
+{
+    atf_error_t err;
+    atf_dynstr_t result, extra;
+
+    err = read_file(resfile, &result);
+    if (atf_is_error(err))
+        goto out;
+    err = split_result(&result, &extra);
+    if (atf_is_error(err))
+        goto out_result;
+
+    if (atf_dynstr_length(&result) == 0)
+        err = atf_report_add(report, ident, "broken: Premature exit",
+                             atf_dynstr_cstring(&extra));
+    else
+        err = atf_report_add(report, ident, atf_dynstr_cstring(&result),
+                             atf_dynstr_cstring(&extra));
+
+    atf_dynstr_fini(&extra);
+out_result:
+    atf_dynstr_fini(&result);
+out:
+    return err;
+}
+
+/** Runs the body of a single test case under a timeout.
+ *
+ * The body runs in a subprocess in its own process group, which is killed
+ * as a whole if it does not finish within timeout seconds.  The result of
+ * the test case is written to resfile, replaced by a failure if it timed
+ * out unexpectedly.  ok is set to whether the body exited successfully or
+ * timed out as expected.  Unlike atf_runner_run, the test case is not
+ * isolated in a work directory of its own.
+ */
+atf_error_t
+atf_runner_run_body(atf_runner_part_t part, void *data, const char *ident,
+                    const unsigned int timeout, const char *resfile, bool *ok)
+{
+    atf_error_t err;
+    atf_fs_path_t chpath;
+    atf_dynstr_t result;
+    bool timed_out;
+    int channel, status;
+    pid_t pid;
+
+    err = channel_open(&channel);
+    if (atf_is_error(err))
+        goto out;
+    err = channel_path(channel, &chpath);
+    if (atf_is_error(err))
+        goto out_channel;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid = fork();
+    if (pid == -1) {
+        err = atf_libc_error(errno, "Failed to fork");
+        goto out_chpath;
+    } else if (pid == 0) {
+        (void)setpgid(0, 0);
+        part(data, ident, false, atf_fs_path_cstring(&chpath));
+        fflush(stdout);
+        fflush(stderr);
+        exit(EXIT_SUCCESS);
+    }
+    (void)setpgid(pid, pid);
+
+    err = atf_timeout_wait(pid, timeout, &status, &timed_out);
+    if (atf_is_error(err))
+        goto out_chpath;
+
+    if (timed_out)
+        err = timed_out_result(channel, timeout, &result);
+    else
+        err = channel_read(channel, &result);
+    if (atf_is_error(err))
+        goto out_chpath;
+
+    err = write_result(resfile, atf_dynstr_cstring(&result));
+    if (!atf_is_error(err)) {
+        if (timed_out)
+            *ok = strncmp(atf_dynstr_cstring(&result), "expected_timeout",
+                          16) == 0;
+        else
+            *ok = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    }
+    atf_dynstr_fini(&result);
+
+out_chpath:
+    atf_fs_path_fini(&chpath);
+out_channel:
+    close(channel);
+out:
+    return err;
+}
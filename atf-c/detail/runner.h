@@ -0,0 +1,84 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_RUNNER_H)
+#define ATF_C_DETAIL_RUNNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <atf-c/detail/list.h>
+#include <atf-c/error_fwd.h>
+
+struct atf_history;
+struct atf_report;
+
+/* ---------------------------------------------------------------------
+ * The "atf_runner" type.
+ * --------------------------------------------------------------------- */
+
+/* Executes the body (if the boolean is false) or the cleanup routine (if
+ * true) of the named test case.  Called from within a child process; the
+ * results file is only provided for the body. */
+typedef void (*atf_runner_part_t)(void *, const char *, const bool,
+                                  const char *);
+
+struct atf_runner {
+    atf_runner_part_t m_part;
+    void *m_data;
+
+    size_t m_jobs;
+    size_t m_reruns;
+    atf_list_t m_tcs;
+    struct atf_history *m_history;
+    struct atf_report *m_report;
+};
+typedef struct atf_runner atf_runner_t;
+
+/* Constructors/destructors. */
+atf_error_t atf_runner_init(atf_runner_t *, atf_runner_part_t, void *);
+void atf_runner_fini(atf_runner_t *);
+
+/* Modifiers. */
+atf_error_t atf_runner_add_tc(atf_runner_t *, const char *, const bool,
+                              const unsigned int);
+void atf_runner_set_history(atf_runner_t *, struct atf_history *);
+void atf_runner_set_jobs(atf_runner_t *, const size_t);
+void atf_runner_set_reruns(atf_runner_t *, const size_t);
+void atf_runner_set_report(atf_runner_t *, struct atf_report *);
+
+/* Operations. */
+atf_error_t atf_runner_run(const atf_runner_t *, const char *, bool *);
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+atf_error_t atf_runner_report_resfile(struct atf_report *, const char *,
+                                     const char *);
+atf_error_t atf_runner_run_body(atf_runner_part_t, void *, const char *,
+                                const unsigned int, const char *, bool *);
+
+#endif /* !defined(ATF_C_DETAIL_RUNNER_H) */
@@ -0,0 +1,509 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/runner.h"
+
+#include <sys/stat.h>
+
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/history.h"
+#include "atf-c/detail/report.h"
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/** Fake test case implementation whose behavior depends on its name. */
+static
+void
+fake_part(void *data, const char *ident, const bool cleanup,
+          const char *resfile)
+{
+    const char *shared = data;
+
+    if (cleanup) {
+        if (strcmp(ident, "cleanup_fail") == 0)
+            exit(EXIT_FAILURE);
+        atf_utils_create_file("cleanup_done", "yes\n");
+        return;
+    }
+
+    if (strcmp(ident, "pass") == 0) {
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "fail") == 0) {
+        atf_utils_create_file(resfile, "failed: Some reason\n");
+        exit(EXIT_FAILURE);
+    } else if (strcmp(ident, "multiline") == 0) {
+        atf_utils_create_file(resfile, "failed: First\nSecond\n");
+        exit(EXIT_FAILURE);
+    } else if (strcmp(ident, "crash") == 0) {
+        abort();
+    } else if (strcmp(ident, "exit_ok") == 0) {
+        atf_utils_create_file(resfile, "expected_exit(3): Go away\n");
+        exit(3);
+    } else if (strcmp(ident, "exit_bad") == 0) {
+        atf_utils_create_file(resfile, "expected_exit(3): Go away\n");
+        exit(4);
+    } else if (strcmp(ident, "cleanup_fail") == 0 ||
+               strcmp(ident, "cleanup_pass") == 0) {
+        atf_utils_create_file("cleanup_done", "no\n");
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "workdir") == 0) {
+        if (atf_utils_file_exists("cleanup_done")) {
+            atf_utils_create_file(resfile, "failed: Shared work dir\n");
+            exit(EXIT_FAILURE);
+        }
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "channel") == 0) {
+        if (strncmp(resfile, "/dev/fd/", 8) != 0) {
+            atf_utils_create_file(resfile, "failed: Not a channel\n");
+            exit(EXIT_FAILURE);
+        }
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "flaky") == 0) {
+        char path[1024];
+
+        snprintf(path, sizeof(path), "%s/flaky", shared);
+        if (!atf_utils_file_exists(path)) {
+            atf_utils_create_file(path, "\n");
+            atf_utils_create_file(resfile, "failed: First attempt\n");
+            exit(EXIT_FAILURE);
+        }
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "hang") == 0) {
+        for (;;)
+            pause();
+    } else if (strcmp(ident, "hang_announced") == 0) {
+        char path[1024];
+
+        snprintf(path, sizeof(path), "%s/hanging", shared);
+        atf_utils_create_file(path, "\n");
+        for (;;)
+            pause();
+    } else if (strcmp(ident, "after_hang_announced") == 0) {
+        char path[1024];
+        int i;
+
+        snprintf(path, sizeof(path), "%s/hanging", shared);
+        for (i = 0; i < 300 && !atf_utils_file_exists(path); i++)
+            usleep(10000);
+        atf_utils_create_file(resfile, "passed\n");
+        exit(EXIT_SUCCESS);
+    } else if (strcmp(ident, "hang_expected") == 0) {
+        atf_utils_create_file(resfile, "expected_timeout: Hangs\n");
+        for (;;)
+            pause();
+    } else if (strncmp(ident, "rendezvous", 10) == 0) {
+        char path[1024];
+        int i, j;
+
+        snprintf(path, sizeof(path), "%s/%s", shared, ident);
+        atf_utils_create_file(path, "\n");
+        for (i = 0; i < 300; i++) {
+            bool all = true;
+            for (j = 1; j <= 4; j++) {
+                snprintf(path, sizeof(path), "%s/rendezvous%d", shared, j);
+                all &= atf_utils_file_exists(path);
+            }
+            if (all) {
+                atf_utils_create_file(resfile, "passed\n");
+                exit(EXIT_SUCCESS);
+            }
+            usleep(100000);
+        }
+        atf_utils_create_file(resfile, "failed: Not run concurrently\n");
+        exit(EXIT_FAILURE);
+    }
+
+    exit(128);
+}
+
+static
+bool
+run_fake(const char *const *idents, const size_t jobs, const bool cleanup,
+         const char *shared, const unsigned int timeout)
+{
+    atf_runner_t runner;
+    bool all_ok;
+
+    RE(atf_runner_init(&runner, fake_part, (void *)(uintptr_t)shared));
+    if (jobs > 0)
+        atf_runner_set_jobs(&runner, jobs);
+    for (; *idents != NULL; idents++)
+        RE(atf_runner_add_tc(&runner, *idents, cleanup, timeout));
+    RE(atf_runner_run(&runner, "results", &all_ok));
+    atf_runner_fini(&runner);
+
+    atf_utils_cat_file("results", "results: ");
+    return all_ok;
+}
+
+/* ---------------------------------------------------------------------
+ * Test cases for the "atf_runner" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(run_results);
+ATF_TC_BODY(run_results, tc)
+{
+    const char *const idents[] = { "pass", "fail", "pass", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "pass: passed\nfail: failed: Some reason\npass: passed\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_all_ok);
+ATF_TC_BODY(run_all_ok, tc)
+{
+    const char *const idents[] = { "pass", "exit_ok", NULL };
+
+    ATF_REQUIRE(run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "pass: passed\nexit_ok: expected_exit(3): Go away\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_multiline_reason);
+ATF_TC_BODY(run_multiline_reason, tc)
+{
+    const char *const idents[] = { "multiline", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "multiline: failed: First<<NEWLINE>>Second\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_crash);
+ATF_TC_BODY(run_crash, tc)
+{
+    const char *const idents[] = { "crash", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_grep_file("^crash: broken: Premature exit; test "
+        "case received signal %d", "results", SIGABRT));
+}
+
+ATF_TC_WITHOUT_HEAD(run_expected_exit_mismatch);
+ATF_TC_BODY(run_expected_exit_mismatch, tc)
+{
+    const char *const idents[] = { "exit_bad", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_grep_file("^exit_bad: failed: .*exit with code 3 "
+        "but exited with code 4", "results"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_cleanup);
+ATF_TC_BODY(run_cleanup, tc)
+{
+    const char *const idents[] = { "cleanup_pass", "cleanup_fail", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, true, NULL, 0));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "cleanup_pass: passed\n"
+        "cleanup_fail: broken: Test case cleanup did not terminate "
+        "successfully\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_isolated_workdirs);
+ATF_TC_BODY(run_isolated_workdirs, tc)
+{
+    const char *const idents[] = { "cleanup_pass", "workdir", NULL };
+
+    ATF_REQUIRE(run_fake(idents, 0, true, NULL, 0));
+    ATF_REQUIRE(!atf_utils_file_exists("cleanup_done"));
+}
+
+ATF_TC(run_result_channel);
+ATF_TC_HEAD(run_result_channel, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that results travel through an "
+                      "inherited descriptor instead of a file");
+}
+ATF_TC_BODY(run_result_channel, tc)
+{
+    const char *const idents[] = { "channel", "channel", NULL };
+    bool ok;
+
+    ATF_REQUIRE(run_fake(idents, 0, false, NULL, 0));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "channel: passed\nchannel: passed\n"));
+
+    RE(atf_runner_run_body(fake_part, NULL, "channel", 0, "r1", &ok));
+    ATF_REQUIRE(ok);
+    ATF_REQUIRE(atf_utils_compare_file("r1", "passed\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_reruns);
+ATF_TC_BODY(run_reruns, tc)
+{
+    const char *const idents[] = { "pass", "flaky", "fail", NULL };
+    const char *const *ident;
+    atf_runner_t runner;
+    atf_report_t report;
+    char *shared;
+    bool all_ok;
+
+    ATF_REQUIRE(mkdir("shared", 0755) != -1);
+    shared = realpath("shared", NULL);
+    ATF_REQUIRE(shared != NULL);
+
+    RE(atf_report_open(&report, "report", "prog"));
+    RE(atf_runner_init(&runner, fake_part, shared));
+    atf_runner_set_reruns(&runner, 2);
+    atf_runner_set_report(&runner, &report);
+    for (ident = idents; *ident != NULL; ident++)
+        RE(atf_runner_add_tc(&runner, *ident, false, 0));
+    RE(atf_runner_run(&runner, "results", &all_ok));
+    atf_runner_fini(&runner);
+    RE(atf_report_close(&report));
+    free(shared);
+
+    atf_utils_cat_file("results", "results: ");
+    atf_utils_cat_file("report", "report: ");
+    ATF_REQUIRE(!all_ok);
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "pass: passed\nflaky: passed\nfail: failed: Some reason\n"));
+    ATF_REQUIRE(atf_utils_grep_file("\"pass\", .*\"rerun.passes\": 1, "
+        "\"rerun.failures\": 0, \"rerun.class\": \"stable\"", "report"));
+    ATF_REQUIRE(atf_utils_grep_file("\"flaky\", .*\"rerun.passes\": 1, "
+        "\"rerun.failures\": 1, \"rerun.class\": \"flaky\"", "report"));
+    ATF_REQUIRE(atf_utils_grep_file("\"fail\", .*\"rerun.passes\": 0, "
+        "\"rerun.failures\": 3, \"rerun.class\": \"deterministic\"",
+        "report"));
+}
+
+ATF_TC(run_parallel);
+ATF_TC_HEAD(run_parallel, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that test cases run concurrently "
+                      "when more than one job is requested");
+    atf_tc_set_md_var(tc, "timeout", "60");
+}
+ATF_TC_BODY(run_parallel, tc)
+{
+    const char *const idents[] = { "rendezvous1", "rendezvous2",
+                                   "rendezvous3", "rendezvous4", NULL };
+    char *shared;
+
+    ATF_REQUIRE(mkdir("shared", 0755) != -1);
+    shared = realpath("shared", NULL);
+    ATF_REQUIRE(shared != NULL);
+    ATF_REQUIRE(run_fake(idents, 4, false, shared, 0));
+    free(shared);
+    ATF_REQUIRE(atf_utils_grep_file("^rendezvous1: passed$", "results"));
+    ATF_REQUIRE(atf_utils_grep_file("^rendezvous4: passed$", "results"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_history_order);
+ATF_TC_BODY(run_history_order, tc)
+{
+    const char *const idents[] = { "pass", "fail", "exit_ok", "multiline",
+                                   NULL };
+    const char *const *ident;
+    atf_history_t history;
+    atf_runner_t runner;
+    bool all_ok;
+
+    RE(atf_history_init(&history));
+    RE(atf_history_set(&history, "pass", 10));
+    RE(atf_history_set(&history, "fail", 500));
+    RE(atf_history_set(&history, "multiline", 10));
+
+    RE(atf_runner_init(&runner, fake_part, NULL));
+    atf_runner_set_history(&runner, &history);
+    for (ident = idents; *ident != NULL; ident++)
+        RE(atf_runner_add_tc(&runner, *ident, false, 0));
+    RE(atf_runner_run(&runner, "results", &all_ok));
+    atf_runner_fini(&runner);
+    atf_history_fini(&history);
+
+    atf_utils_cat_file("results", "results: ");
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "exit_ok: expected_exit(3): Go away\n"
+        "fail: failed: Some reason\n"
+        "pass: passed\n"
+        "multiline: failed: First<<NEWLINE>>Second\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(run_history_record);
+ATF_TC_BODY(run_history_record, tc)
+{
+    atf_history_t history;
+    atf_runner_t runner;
+    unsigned long msecs;
+    bool all_ok;
+
+    RE(atf_history_init(&history));
+    RE(atf_history_set(&history, "pass", 123456));
+    RE(atf_history_set(&history, "other", 42));
+
+    RE(atf_runner_init(&runner, fake_part, NULL));
+    atf_runner_set_history(&runner, &history);
+    RE(atf_runner_add_tc(&runner, "pass", false, 0));
+    RE(atf_runner_add_tc(&runner, "fail", false, 0));
+    RE(atf_runner_run(&runner, "results", &all_ok));
+    atf_runner_fini(&runner);
+
+    ATF_REQUIRE_EQ(3, atf_history_size(&history));
+    ATF_REQUIRE(atf_history_get(&history, "pass", &msecs));
+    ATF_REQUIRE(msecs < 123456);
+    ATF_REQUIRE(atf_history_get(&history, "fail", &msecs));
+    ATF_REQUIRE(atf_history_get(&history, "other", &msecs));
+    ATF_REQUIRE_EQ(42, msecs);
+    atf_history_fini(&history);
+}
+
+ATF_TC(run_timeout);
+ATF_TC_HEAD(run_timeout, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that test case bodies are killed "
+                      "when they exceed their timeout");
+    atf_tc_set_md_var(tc, "timeout", "60");
+}
+ATF_TC_BODY(run_timeout, tc)
+{
+    const char *const idents[] = { "hang", "hang_expected", "pass", NULL };
+
+    ATF_REQUIRE(!run_fake(idents, 0, false, NULL, 1));
+    ATF_REQUIRE(atf_utils_compare_file("results",
+        "hang: failed: Test case timed out after 1 seconds\n"
+        "hang_expected: expected_timeout: Hangs\n"
+        "pass: passed\n"));
+}
+
+ATF_TC(run_body_timeout);
+ATF_TC_HEAD(run_body_timeout, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that a single test case body is "
+                      "killed when it exceeds its timeout");
+    atf_tc_set_md_var(tc, "timeout", "60");
+}
+ATF_TC_BODY(run_body_timeout, tc)
+{
+    bool ok;
+
+    RE(atf_runner_run_body(fake_part, NULL, "hang", 1, "r1", &ok));
+    ATF_REQUIRE(!ok);
+    ATF_REQUIRE(atf_utils_compare_file("r1", "failed: Test case timed out "
+                                       "after 1 seconds\n"));
+
+    RE(atf_runner_run_body(fake_part, NULL, "hang_expected", 1, "r2", &ok));
+    ATF_REQUIRE(ok);
+    ATF_REQUIRE(atf_utils_compare_file("r2", "expected_timeout: Hangs\n"));
+
+    RE(atf_runner_run_body(fake_part, NULL, "fail", 1, "r3", &ok));
+    ATF_REQUIRE(!ok);
+    ATF_REQUIRE(atf_utils_compare_file("r3", "failed: Some reason\n"));
+
+    RE(atf_runner_run_body(fake_part, NULL, "pass", 0, "r4", &ok));
+    ATF_REQUIRE(ok);
+    ATF_REQUIRE(atf_utils_compare_file("r4", "passed\n"));
+}
+
+ATF_TC(run_error_kills);
+ATF_TC_HEAD(run_error_kills, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that the test cases still running "
+                      "are killed when the runner bails out");
+    atf_tc_set_md_var(tc, "timeout", "60");
+}
+ATF_TC_BODY(run_error_kills, tc)
+{
+    atf_runner_t runner;
+    atf_error_t err;
+    struct pollfd pfd;
+    char *shared;
+    bool all_ok;
+    int fds[2];
+
+    if (!atf_utils_file_exists("/dev/full"))
+        atf_tc_skip("Requires /dev/full to fail writing the results");
+    ATF_REQUIRE(mkdir("shared", 0755) != -1);
+    shared = realpath("shared", NULL);
+    ATF_REQUIRE(shared != NULL);
+
+    /* The test cases inherit the write end of the pipe, so reading from it
+     * only returns EOF once all of them are gone. */
+    ATF_REQUIRE(pipe(fds) != -1);
+
+    RE(atf_runner_init(&runner, fake_part, (void *)(uintptr_t)shared));
+    atf_runner_set_jobs(&runner, 2);
+    RE(atf_runner_add_tc(&runner, "hang_announced", false, 0));
+    RE(atf_runner_add_tc(&runner, "after_hang_announced", false, 0));
+
+    /* Writing the first result fails, so the runner gives up. */
+    err = atf_runner_run(&runner, "/dev/full", &all_ok);
+    ATF_REQUIRE(atf_is_error(err));
+    atf_error_free(err);
+    atf_runner_fini(&runner);
+    free(shared);
+
+    close(fds[1]);
+    pfd.fd = fds[0];
+    pfd.events = POLLIN;
+    ATF_REQUIRE_MSG(poll(&pfd, 1, 10000) == 1, "Test case still running");
+    close(fds[0]);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, run_results);
+    ATF_TP_ADD_TC(tp, run_all_ok);
+    ATF_TP_ADD_TC(tp, run_multiline_reason);
+    ATF_TP_ADD_TC(tp, run_crash);
+    ATF_TP_ADD_TC(tp, run_expected_exit_mismatch);
+    ATF_TP_ADD_TC(tp, run_cleanup);
+    ATF_TP_ADD_TC(tp, run_isolated_workdirs);
+    ATF_TP_ADD_TC(tp, run_result_channel);
+    ATF_TP_ADD_TC(tp, run_reruns);
+    ATF_TP_ADD_TC(tp, run_parallel);
+    ATF_TP_ADD_TC(tp, run_history_order);
+    ATF_TP_ADD_TC(tp, run_history_record);
+    ATF_TP_ADD_TC(tp, run_timeout);
+    ATF_TP_ADD_TC(tp, run_body_timeout);
+    ATF_TP_ADD_TC(tp, run_error_kills);
+
+    return atf_no_error();
+}
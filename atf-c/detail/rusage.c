@@ -0,0 +1,128 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/rusage.h"
+
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Appends the "rusage.<who>.*" lines for the resource usage of the current
+ * process or of its waited-for children.  maxrss is in the units used by
+ * getrusage(2): kilobytes on most systems.
+ */
+static
+atf_error_t
+format_rusage(const int who, const char *name, atf_dynstr_t *out)
+{
+    struct rusage ru;
+
+    if (getrusage(who, &ru) == -1)
+        return atf_libc_error(errno, "Cannot get the resource usage");
+
+    return atf_dynstr_append_fmt(out,
+        "rusage.%s.utime: %ld.%06ld\n"
+        "rusage.%s.stime: %ld.%06ld\n"
+        "rusage.%s.maxrss: %ld\n"
+        "rusage.%s.minflt: %ld\n"
+        "rusage.%s.majflt: %ld\n"
+        "rusage.%s.nvcsw: %ld\n"
+        "rusage.%s.nivcsw: %ld\n",
+        name, (long)ru.ru_utime.tv_sec, (long)ru.ru_utime.tv_usec,
+        name, (long)ru.ru_stime.tv_sec, (long)ru.ru_stime.tv_usec,
+        name, ru.ru_maxrss, name, ru.ru_minflt, name, ru.ru_majflt,
+        name, ru.ru_nvcsw, name, ru.ru_nivcsw);
+}
+
+/*
+ * Appends the "io.*" lines with the I/O counters of the current process
+ * as found in /proc/self/io.  Nothing is appended on systems that do not
+ * provide this file or when it cannot be read.
+ */
+static
+atf_error_t
+format_io(atf_dynstr_t *out)
+{
+    static const char *const keys[] = {
+        "rchar", "wchar", "read_bytes", "write_bytes", NULL
+    };
+    atf_error_t err = atf_no_error();
+    char line[128], key[64];
+    unsigned long long value;
+    const char *const *k;
+    FILE *f;
+
+    f = fopen("/proc/self/io", "r");
+    if (f == NULL)
+        return atf_no_error();
+
+    while (!atf_is_error(err) && fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "%63[a-z_]: %llu", key, &value) != 2)
+            continue;
+        for (k = keys; *k != NULL; k++) {
+            if (strcmp(*k, key) == 0) {
+                err = atf_dynstr_append_fmt(out, "io.%s: %llu\n", key,
+                                            value);
+                break;
+            }
+        }
+    }
+
+    fclose(f);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Appends the resource usage of the current process, and of the children
+ * it has waited for, to out in the "key: value" lines of the extended
+ * results format.
+ */
+atf_error_t
+atf_rusage_format(atf_dynstr_t *out)
+{
+    atf_error_t err;
+
+    err = format_rusage(RUSAGE_SELF, "self", out);
+    if (!atf_is_error(err))
+        err = format_rusage(RUSAGE_CHILDREN, "children", out);
+    if (!atf_is_error(err))
+        err = format_io(out);
+    return err;
+}
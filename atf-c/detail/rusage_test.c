@@ -0,0 +1,129 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/rusage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* Extracts the value of the "key: value" line for key from text. */
+static
+long
+field_value(const char *text, const char *key)
+{
+    char prefix[64];
+    const char *p;
+
+    snprintf(prefix, sizeof(prefix), "\n%s: ", key);
+    p = strstr(text, prefix);
+    ATF_REQUIRE_MSG(p != NULL, "%s not found in '%s'", key, text);
+    return strtol(p + strlen(prefix), NULL, 10);
+}
+
+/* ---------------------------------------------------------------------
+ * Test cases for the free functions.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(format);
+ATF_TC_BODY(format, tc)
+{
+    atf_dynstr_t out;
+    const char *text;
+    char *buf;
+
+    /* Touch some memory so that the peak RSS is not negligible. */
+    buf = malloc(4 * 1024 * 1024);
+    ATF_REQUIRE(buf != NULL);
+    memset(buf, 'x', 4 * 1024 * 1024);
+
+    RE(atf_dynstr_init(&out));
+    RE(atf_dynstr_append_fmt(&out, "passed\n"));
+    RE(atf_rusage_format(&out));
+    text = atf_dynstr_cstring(&out);
+    printf("%s", text);
+
+    ATF_REQUIRE(atf_utils_grep_string("^passed\n"
+                                      "rusage\\.self\\.utime: [0-9]+\\.[0-9]{6}\n"
+                                      "rusage\\.self\\.stime: [0-9]+\\.[0-9]{6}\n",
+                                      text));
+    ATF_REQUIRE(field_value(text, "rusage.self.maxrss") > 0);
+    ATF_REQUIRE(field_value(text, "rusage.self.minflt") > 0);
+    (void)field_value(text, "rusage.self.majflt");
+    (void)field_value(text, "rusage.self.nvcsw");
+    (void)field_value(text, "rusage.self.nivcsw");
+    (void)field_value(text, "rusage.children.utime");
+    (void)field_value(text, "rusage.children.maxrss");
+
+    atf_dynstr_fini(&out);
+    free(buf);
+}
+
+ATF_TC_WITHOUT_HEAD(format_io);
+ATF_TC_BODY(format_io, tc)
+{
+    atf_dynstr_t out;
+    const char *text;
+
+    if (access("/proc/self/io", R_OK) == -1)
+        atf_tc_skip("/proc/self/io is not available");
+
+    atf_utils_create_file("data", "%s", "Some text to write\n");
+
+    RE(atf_dynstr_init(&out));
+    RE(atf_dynstr_append_fmt(&out, "passed\n"));
+    RE(atf_rusage_format(&out));
+    text = atf_dynstr_cstring(&out);
+    printf("%s", text);
+
+    ATF_REQUIRE(field_value(text, "io.wchar") >= 19);
+    (void)field_value(text, "io.rchar");
+    (void)field_value(text, "io.read_bytes");
+    (void)field_value(text, "io.write_bytes");
+
+    atf_dynstr_fini(&out);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, format);
+    ATF_TP_ADD_TC(tp, format_io);
+
+    return atf_no_error();
+}
@@ -0,0 +1,151 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/shard.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atf-c/detail/sanity.h"
+#include "atf-c/detail/text.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Computes the 32-bit FNV-1a hash of a test case name.
+ *
+ * The same hash is implemented by atf-sh, so it must never change: it is
+ * what keeps the shards of a program consistent across runs, machines and
+ * language bindings.
+ */
+static
+uint32_t
+hash_name(const char *name)
+{
+    uint32_t hash = UINT32_C(2166136261);
+
+    for (; *name != '\0'; name++) {
+        hash ^= (unsigned char)*name;
+        hash *= UINT32_C(16777619);
+    }
+    return hash;
+}
+
+static
+atf_error_t
+parse_ulong(const char *str, unsigned long *value)
+{
+    atf_error_t err;
+    long tmp;
+
+    err = atf_text_to_long(str, &tmp);
+    if (!atf_is_error(err)) {
+        if (tmp < 0)
+            err = atf_libc_error(EINVAL, "'%s' is negative", str);
+        else
+            *value = (unsigned long)tmp;
+    }
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_shard" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+void
+atf_shard_init(atf_shard_t *shard)
+{
+    shard->m_index = 0;
+    shard->m_count = 1;
+}
+
+/*
+ * Parses a shard specification of the form index/count, where index is
+ * zero-based and must be lower than count.
+ */
+atf_error_t
+atf_shard_init_str(atf_shard_t *shard, const char *str)
+{
+    atf_error_t err;
+    char *copy, *slash;
+    unsigned long pos = 0, count = 0;
+
+    copy = strdup(str);
+    if (copy == NULL)
+        return atf_no_memory_error();
+
+    slash = strchr(copy, '/');
+    if (slash == NULL) {
+        err = atf_libc_error(EINVAL, "Shard '%s' is not of the form "
+                             "index/count", str);
+        goto out;
+    }
+    *slash = '\0';
+
+    err = parse_ulong(copy, &pos);
+    if (atf_is_error(err))
+        goto out;
+    err = parse_ulong(slash + 1, &count);
+    if (atf_is_error(err))
+        goto out;
+
+    if (count == 0 || pos >= count) {
+        err = atf_libc_error(EINVAL, "Shard index must be lower than the "
+                             "shard count in '%s'", str);
+        goto out;
+    }
+
+    shard->m_index = pos;
+    shard->m_count = count;
+    INV(!atf_is_error(err));
+out:
+    free(copy);
+    return err;
+}
+
+/*
+ * Getters.
+ */
+
+bool
+atf_shard_contains(const atf_shard_t *shard, const char *name)
+{
+    return hash_name(name) % shard->m_count == shard->m_index;
+}
+
+bool
+atf_shard_is_all(const atf_shard_t *shard)
+{
+    return shard->m_count == 1;
+}
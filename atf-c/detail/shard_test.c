@@ -0,0 +1,139 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/shard.h"
+
+#include <stdio.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_shard" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(init);
+ATF_TC_BODY(init, tc)
+{
+    atf_shard_t shard;
+
+    atf_shard_init(&shard);
+    ATF_REQUIRE(atf_shard_is_all(&shard));
+    ATF_REQUIRE(atf_shard_contains(&shard, "foo"));
+    ATF_REQUIRE(atf_shard_contains(&shard, ""));
+}
+
+ATF_TC_WITHOUT_HEAD(init_str_ok);
+ATF_TC_BODY(init_str_ok, tc)
+{
+    atf_shard_t shard;
+
+    RE(atf_shard_init_str(&shard, "0/1"));
+    ATF_REQUIRE(atf_shard_is_all(&shard));
+
+    RE(atf_shard_init_str(&shard, "3/4"));
+    ATF_REQUIRE(!atf_shard_is_all(&shard));
+    ATF_REQUIRE_EQ(3, shard.m_index);
+    ATF_REQUIRE_EQ(4, shard.m_count);
+}
+
+ATF_TC_WITHOUT_HEAD(init_str_invalid);
+ATF_TC_BODY(init_str_invalid, tc)
+{
+    const char *const specs[] = { "", "1", "/", "1/", "/2", "a/2", "1/b",
+                                  "-1/2", "2/2", "0/0", "1/2/3", NULL };
+    const char *const *spec;
+
+    for (spec = specs; *spec != NULL; spec++) {
+        atf_shard_t shard;
+        atf_error_t err;
+
+        printf("Checking '%s'\n", *spec);
+        err = atf_shard_init_str(&shard, *spec);
+        ATF_REQUIRE(atf_is_error(err));
+        ATF_REQUIRE(atf_error_is(err, "libc"));
+        atf_error_free(err);
+    }
+}
+
+ATF_TC_WITHOUT_HEAD(contains_stable);
+ATF_TC_BODY(contains_stable, tc)
+{
+    atf_shard_t shard;
+
+    /* The 32-bit FNV-1a hash of "a" is 3826002220 and that of "foobar" is
+     * 3214735720; these must never change. */
+    RE(atf_shard_init_str(&shard, "20/100"));
+    ATF_REQUIRE(atf_shard_contains(&shard, "a"));
+    ATF_REQUIRE(atf_shard_contains(&shard, "foobar"));
+    RE(atf_shard_init_str(&shard, "21/100"));
+    ATF_REQUIRE(!atf_shard_contains(&shard, "a"));
+    ATF_REQUIRE(!atf_shard_contains(&shard, "foobar"));
+}
+
+ATF_TC_WITHOUT_HEAD(contains_partition);
+ATF_TC_BODY(contains_partition, tc)
+{
+    unsigned long counts[4] = { 0, 0, 0, 0 };
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        char name[32];
+        unsigned long j, found;
+
+        snprintf(name, sizeof(name), "test_case_%d", i);
+        found = 0;
+        for (j = 0; j < 4; j++) {
+            atf_shard_t shard = { j, 4 };
+
+            if (atf_shard_contains(&shard, name)) {
+                counts[j]++;
+                found++;
+            }
+        }
+        ATF_REQUIRE_EQ(1, found);
+    }
+
+    for (i = 0; i < 4; i++) {
+        printf("Shard %d has %lu test cases\n", i, counts[i]);
+        ATF_CHECK(counts[i] > 150);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, init);
+    ATF_TP_ADD_TC(tp, init_str_ok);
+    ATF_TP_ADD_TC(tp, init_str_invalid);
+    ATF_TP_ADD_TC(tp, contains_stable);
+    ATF_TP_ADD_TC(tp, contains_partition);
+
+    return atf_no_error();
+}
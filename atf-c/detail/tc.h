@@ -0,0 +1,48 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_TC_H)
+#define ATF_C_DETAIL_TC_H
+
+#include <atf-c/error_fwd.h>
+#include <atf-c/tc.h>
+
+struct atf_arena;
+struct atf_vars;
+
+/* Internal to atf-c and atf-c++; the config is shared, not copied. */
+atf_error_t atf_tc_init_vars(atf_tc_t *, const char *, atf_tc_head_t,
+                             atf_tc_body_t, atf_tc_cleanup_t,
+                             struct atf_vars *);
+/* Internal to atf-c; the test case is allocated from the arena. */
+atf_error_t atf_tc_init_arena(atf_tc_t *, const char *, atf_tc_head_t,
+                              atf_tc_body_t, atf_tc_cleanup_t,
+                              struct atf_vars *, struct atf_arena *);
+
+/* Internal to atf-c and atf-c++; see the extended results format. */
+void atf_tc_start_init_timing(void);
+atf_error_t atf_tc_cleanup_resfile(const atf_tc_t *, const char *);
+
+#endif /* !defined(ATF_C_DETAIL_TC_H) */
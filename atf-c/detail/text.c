@@ -83,8 +83,11 @@ atf_text_format_ap(char **dest, const char *fmt, va_list ap)
     va_copy(ap2, ap);
     err = atf_dynstr_init_ap(&tmp, fmt, ap2);
     va_end(ap2);
-    if (!atf_is_error(err))
+    if (!atf_is_error(err)) {
         *dest = atf_dynstr_fini_disown(&tmp);
+        if (*dest == NULL)
+            err = atf_no_memory_error();
+    }
 
     return err;
 }
@@ -114,12 +117,19 @@ atf_text_split(const char *str, const char *delim, atf_list_t *words)
         INV(ptr >= iter);
         if (ptr > iter) {
             atf_dynstr_t word;
+            char *wordstr;
 
             err = atf_dynstr_init_raw(&word, iter, ptr - iter);
             if (atf_is_error(err))
                 goto err_list;
 
-            err = atf_list_append(words, atf_dynstr_fini_disown(&word), true);
+            wordstr = atf_dynstr_fini_disown(&word);
+            if (wordstr == NULL) {
+                err = atf_no_memory_error();
+                goto err_list;
+            }
+
+            err = atf_list_append(words, wordstr, true);
             if (atf_is_error(err))
                 goto err_list;
         }
@@ -0,0 +1,270 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "atf-c/detail/timeout.h"
+
+#include <sys/types.h>
+#if defined(HAVE_SYS_TIMERFD_H) && HAVE_DECL_SYS_PIDFD_OPEN
+#   include <sys/syscall.h>
+#   include <sys/timerfd.h>
+#   define USE_PIDFD 1
+#endif
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "atf-c/defs.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+atf_error_t
+reap(const pid_t pid, int *status)
+{
+    while (waitpid(pid, status, 0) == -1) {
+        if (errno != EINTR)
+            return atf_libc_error(errno, "Failed to wait for process %d",
+                                  (int)pid);
+    }
+    return atf_no_error();
+}
+
+#if defined(USE_PIDFD)
+/** Waits for a process to exit or for a deadline to pass, whichever
+ * happens first, without reaping the process.
+ *
+ * supported is set to false if pidfd_open(2) or timerfd_create(2) are not
+ * usable, e.g. because the kernel is too old or a seccomp filter rejects
+ * them, in which case the caller must resort to another method. */
+static
+atf_error_t
+wait_pidfd(const pid_t pid, const unsigned int seconds, bool *expired,
+           bool *supported)
+{
+    atf_error_t err;
+    struct itimerspec its;
+    struct pollfd fds[2];
+    int pidfd, timerfd;
+
+    pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd == -1) {
+        *supported = false;
+        return atf_no_error();
+    }
+
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timerfd == -1) {
+        *supported = false;
+        err = atf_no_error();
+        goto out_pidfd;
+    }
+    *supported = true;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = seconds;
+    if (timerfd_settime(timerfd, 0, &its, NULL) == -1) {
+        err = atf_libc_error(errno, "Cannot arm timer");
+        goto out_timerfd;
+    }
+
+    fds[0].fd = pidfd;
+    fds[0].events = POLLIN;
+    fds[1].fd = timerfd;
+    fds[1].events = POLLIN;
+
+    err = atf_no_error();
+    while (poll(fds, 2, -1) == -1) {
+        if (errno != EINTR) {
+            err = atf_libc_error(errno, "Cannot wait for process %d",
+                                 (int)pid);
+            goto out_timerfd;
+        }
+    }
+    *expired = !(fds[0].revents & POLLIN) && (fds[1].revents & POLLIN);
+
+out_timerfd:
+    close(timerfd);
+out_pidfd:
+    close(pidfd);
+    return err;
+}
+#endif
+
+static int sigchld_fd = -1;
+
+static
+void
+sigchld_handler(const int signo ATF_DEFS_ATTRIBUTE_UNUSED)
+{
+    const int old_errno = errno;
+    if (write(sigchld_fd, "", 1) == -1) {
+        /* The pipe is full, so a wakeup is already pending. */
+    }
+    errno = old_errno;
+}
+
+static
+long
+msecs_until(const struct timespec *deadline)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (deadline->tv_sec - now.tv_sec) * 1000 +
+           (deadline->tv_nsec - now.tv_nsec) / 1000000;
+}
+
+/** Waits for a process to exit or for a deadline to pass, whichever
+ * happens first, reaping the process if it exited.
+ *
+ * Portable version that wakes up on SIGCHLD through a self-pipe. */
+static
+atf_error_t
+wait_sigchld(const pid_t pid, const unsigned int seconds, int *status,
+             bool *expired)
+{
+    atf_error_t err;
+    struct sigaction sa, old_sa;
+    struct timespec deadline;
+    int fds[2];
+
+    if (pipe(fds) == -1)
+        return atf_libc_error(errno, "Cannot create pipe");
+    (void)fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    (void)fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    sigchld_fd = fds[1];
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigchld_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_NOCLDSTOP;
+    if (sigaction(SIGCHLD, &sa, &old_sa) == -1) {
+        err = atf_libc_error(errno, "Cannot install SIGCHLD handler");
+        goto out_pipe;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += seconds;
+
+    err = atf_no_error();
+    *expired = false;
+    for (;;) {
+        struct pollfd pfd;
+        char buf[64];
+        long remaining;
+        pid_t ret;
+
+        ret = waitpid(pid, status, WNOHANG);
+        if (ret == pid)
+            break;
+        else if (ret == -1 && errno != EINTR) {
+            err = atf_libc_error(errno, "Failed to wait for process %d",
+                                 (int)pid);
+            break;
+        }
+
+        remaining = msecs_until(&deadline);
+        if (remaining <= 0) {
+            *expired = true;
+            break;
+        }
+
+        pfd.fd = fds[0];
+        pfd.events = POLLIN;
+        (void)poll(&pfd, 1, remaining > INT_MAX ? INT_MAX : (int)remaining);
+        while (read(fds[0], buf, sizeof(buf)) > 0)
+            continue;
+    }
+
+    (void)sigaction(SIGCHLD, &old_sa, NULL);
+out_pipe:
+    sigchld_fd = -1;
+    close(fds[0]);
+    close(fds[1]);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/** Waits for a process to terminate within a number of seconds.
+ *
+ * The process must be the leader of its own process group.  If it does
+ * not terminate in time, the whole process group is killed so that any
+ * subprocesses it spawned do not outlive it, and timed_out is set.  A
+ * timeout of 0 waits forever.  In all cases, the process is reaped and its
+ * exit status stored in status.
+ */
+atf_error_t
+atf_timeout_wait(const pid_t pid, const unsigned int seconds, int *status,
+                 bool *timed_out)
+{
+    atf_error_t err;
+    bool expired;
+
+    *timed_out = false;
+    if (seconds == 0)
+        return reap(pid, status);
+
+    expired = false;
+#if defined(USE_PIDFD)
+    {
+        bool supported;
+
+        err = wait_pidfd(pid, seconds, &expired, &supported);
+        if (atf_is_error(err))
+            return err;
+        if (supported) {
+            if (expired) {
+                (void)killpg(pid, SIGKILL);
+                *timed_out = true;
+            }
+            return reap(pid, status);
+        }
+    }
+#endif
+
+    err = wait_sigchld(pid, seconds, status, &expired);
+    if (atf_is_error(err) || !expired)
+        return err;
+
+    (void)killpg(pid, SIGKILL);
+    *timed_out = true;
+    return reap(pid, status);
+}
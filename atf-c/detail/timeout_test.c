@@ -0,0 +1,187 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/timeout.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/** Forks a child in its own process group that runs the given function. */
+static
+pid_t
+fork_leader(void (*hook)(void))
+{
+    pid_t pid;
+
+    pid = atf_utils_fork();
+    if (pid == 0) {
+        ATF_REQUIRE(setpgid(0, 0) != -1);
+        hook();
+        exit(EXIT_SUCCESS);
+    }
+    (void)setpgid(pid, pid);
+    return pid;
+}
+
+static
+void
+exit_three(void)
+{
+    exit(3);
+}
+
+static
+void
+hang(void)
+{
+    for (;;)
+        pause();
+}
+
+/* Write end of a pipe that stays open for as long as any of the processes
+ * spawned by hang_with_child are alive. */
+static int alive_fd = -1;
+
+static
+void
+hang_with_child(void)
+{
+    pid_t pid;
+
+    pid = fork();
+    ATF_REQUIRE(pid != -1);
+    if (pid == 0)
+        hang();
+    close(alive_fd);
+    hang();
+}
+
+/* ---------------------------------------------------------------------
+ * Test cases for the free functions.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(wait_no_timeout);
+ATF_TC_BODY(wait_no_timeout, tc)
+{
+    bool timed_out;
+    int status;
+    pid_t pid;
+
+    pid = fork_leader(exit_three);
+    RE(atf_timeout_wait(pid, 0, &status, &timed_out));
+    ATF_REQUIRE(!timed_out);
+    ATF_REQUIRE(WIFEXITED(status));
+    ATF_REQUIRE_EQ(3, WEXITSTATUS(status));
+}
+
+ATF_TC_WITHOUT_HEAD(wait_in_time);
+ATF_TC_BODY(wait_in_time, tc)
+{
+    bool timed_out;
+    int status;
+    pid_t pid;
+
+    pid = fork_leader(exit_three);
+    RE(atf_timeout_wait(pid, 60, &status, &timed_out));
+    ATF_REQUIRE(!timed_out);
+    ATF_REQUIRE(WIFEXITED(status));
+    ATF_REQUIRE_EQ(3, WEXITSTATUS(status));
+}
+
+ATF_TC(wait_expired);
+ATF_TC_HEAD(wait_expired, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that a process that does not "
+                      "terminate in time is killed");
+    atf_tc_set_md_var(tc, "timeout", "30");
+}
+ATF_TC_BODY(wait_expired, tc)
+{
+    bool timed_out;
+    int status;
+    pid_t pid;
+
+    pid = fork_leader(hang);
+    RE(atf_timeout_wait(pid, 1, &status, &timed_out));
+    ATF_REQUIRE(timed_out);
+    ATF_REQUIRE(WIFSIGNALED(status));
+    ATF_REQUIRE_EQ(SIGKILL, WTERMSIG(status));
+}
+
+ATF_TC(wait_kills_group);
+ATF_TC_HEAD(wait_kills_group, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that the subprocesses of a process "
+                      "that does not terminate in time are killed too");
+    atf_tc_set_md_var(tc, "timeout", "30");
+}
+ATF_TC_BODY(wait_kills_group, tc)
+{
+    bool timed_out;
+    char buf;
+    int fds[2];
+    int status;
+    pid_t pid;
+
+    ATF_REQUIRE(pipe(fds) != -1);
+    alive_fd = fds[1];
+    pid = fork_leader(hang_with_child);
+    close(fds[1]);
+
+    RE(atf_timeout_wait(pid, 1, &status, &timed_out));
+    ATF_REQUIRE(timed_out);
+
+    /* The read only returns once the grandchild has died too. */
+    ATF_REQUIRE_EQ(0, read(fds[0], &buf, 1));
+    close(fds[0]);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, wait_no_timeout);
+    ATF_TP_ADD_TC(tp, wait_in_time);
+    ATF_TP_ADD_TC(tp, wait_expired);
+    ATF_TP_ADD_TC(tp, wait_kills_group);
+
+    return atf_no_error();
+}
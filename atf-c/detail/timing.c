@@ -0,0 +1,129 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/timing.h"
+
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+void
+now(struct timespec *ts)
+{
+    (void)clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+static
+long
+usecs_of(const struct timespec *ts)
+{
+    return ts->tv_nsec / 1000;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_timing" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+void
+atf_timing_init(atf_timing_t *t)
+{
+    t->m_started = false;
+    t->m_stopped = false;
+}
+
+/*
+ * Getters.
+ */
+
+bool
+atf_timing_is_running(const atf_timing_t *t)
+{
+    return t->m_started && !t->m_stopped;
+}
+
+/*
+ * Modifiers.
+ */
+
+void
+atf_timing_start(atf_timing_t *t)
+{
+    now(&t->m_start);
+    t->m_started = true;
+    t->m_stopped = false;
+}
+
+void
+atf_timing_stop(atf_timing_t *t)
+{
+    PRE(t->m_started);
+
+    now(&t->m_end);
+    t->m_stopped = true;
+}
+
+/*
+ * Operations.
+ */
+
+/*
+ * Appends the "time.<phase>.start" and "time.<phase>.duration" lines of the
+ * extended results format to out, both in seconds with microsecond
+ * precision.  Nothing is appended for phases that never started.
+ */
+atf_error_t
+atf_timing_format(const atf_timing_t *t, const char *phase, atf_dynstr_t *out)
+{
+    struct timespec end, duration;
+
+    if (!t->m_started)
+        return atf_no_error();
+
+    if (t->m_stopped)
+        end = t->m_end;
+    else
+        now(&end);
+
+    duration.tv_sec = end.tv_sec - t->m_start.tv_sec;
+    duration.tv_nsec = end.tv_nsec - t->m_start.tv_nsec;
+    if (duration.tv_nsec < 0) {
+        duration.tv_sec--;
+        duration.tv_nsec += 1000000000;
+    }
+
+    return atf_dynstr_append_fmt(out, "time.%s.start: %ld.%06ld\n"
+                                 "time.%s.duration: %ld.%06ld\n",
+                                 phase, (long)t->m_start.tv_sec,
+                                 usecs_of(&t->m_start), phase,
+                                 (long)duration.tv_sec, usecs_of(&duration));
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#if !defined(ATF_C_DETAIL_TIMING_H)
+#define ATF_C_DETAIL_TIMING_H
+
+#include <stdbool.h>
+#include <time.h>
+
+#include <atf-c/detail/dynstr.h>
+#include <atf-c/error_fwd.h>
+
+/* ---------------------------------------------------------------------
+ * The "atf_timing" type.
+ * --------------------------------------------------------------------- */
+
+/* The interval of the monotonic clock during which a phase of a test case
+ * (init, head, body or cleanup) ran.  A phase that has been started but
+ * not stopped yet is considered to last until the current time. */
+struct atf_timing {
+    bool m_started;
+    bool m_stopped;
+    struct timespec m_start;
+    struct timespec m_end;
+};
+typedef struct atf_timing atf_timing_t;
+
+/* Constructors/destructors. */
+void atf_timing_init(atf_timing_t *);
+
+/* Getters. */
+bool atf_timing_is_running(const atf_timing_t *);
+
+/* Modifiers. */
+void atf_timing_start(atf_timing_t *);
+void atf_timing_stop(atf_timing_t *);
+
+/* Operations. */
+atf_error_t atf_timing_format(const atf_timing_t *, const char *,
+                              atf_dynstr_t *);
+
+#endif /* !defined(ATF_C_DETAIL_TIMING_H) */
@@ -0,0 +1,146 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/timing.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* Extracts the value of the "time.<phase>.<field>" line from text. */
+static
+double
+field_value(const char *text, const char *phase, const char *field)
+{
+    char key[64];
+    const char *p;
+    double value;
+
+    snprintf(key, sizeof(key), "time.%s.%s: ", phase, field);
+    p = strstr(text, key);
+    ATF_REQUIRE_MSG(p != NULL, "%s not found in '%s'", key, text);
+    ATF_REQUIRE_EQ(1, sscanf(p + strlen(key), "%lf", &value));
+    return value;
+}
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_timing" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(format_not_started);
+ATF_TC_BODY(format_not_started, tc)
+{
+    atf_timing_t t;
+    atf_dynstr_t out;
+
+    atf_timing_init(&t);
+    ATF_REQUIRE(!atf_timing_is_running(&t));
+
+    RE(atf_dynstr_init(&out));
+    RE(atf_timing_format(&t, "body", &out));
+    ATF_REQUIRE_EQ(0, atf_dynstr_length(&out));
+    atf_dynstr_fini(&out);
+}
+
+ATF_TC_WITHOUT_HEAD(format_stopped);
+ATF_TC_BODY(format_stopped, tc)
+{
+    atf_timing_t t;
+    atf_dynstr_t out;
+    const char *text;
+
+    atf_timing_init(&t);
+    atf_timing_start(&t);
+    ATF_REQUIRE(atf_timing_is_running(&t));
+    usleep(100000);
+    atf_timing_stop(&t);
+    ATF_REQUIRE(!atf_timing_is_running(&t));
+
+    RE(atf_dynstr_init(&out));
+    RE(atf_timing_format(&t, "head", &out));
+    text = atf_dynstr_cstring(&out);
+    printf("%s", text);
+    ATF_REQUIRE(atf_utils_grep_string("^time\\.head\\.start: [0-9]+\\.[0-9]{6}\n"
+                                      "time\\.head\\.duration: [0-9]+\\.[0-9]{6}\n$",
+                                      text));
+    ATF_REQUIRE(field_value(text, "head", "duration") >= 0.1);
+    ATF_REQUIRE(field_value(text, "head", "duration") < 10.0);
+
+    /* A stopped phase keeps its duration. */
+    usleep(100000);
+    atf_dynstr_clear(&out);
+    RE(atf_timing_format(&t, "head", &out));
+    ATF_REQUIRE(field_value(atf_dynstr_cstring(&out), "head", "duration")
+                < 0.2);
+    atf_dynstr_fini(&out);
+}
+
+ATF_TC_WITHOUT_HEAD(format_running);
+ATF_TC_BODY(format_running, tc)
+{
+    atf_timing_t t;
+    atf_dynstr_t out;
+    double start, first;
+
+    atf_timing_init(&t);
+    atf_timing_start(&t);
+
+    RE(atf_dynstr_init(&out));
+    RE(atf_timing_format(&t, "body", &out));
+    start = field_value(atf_dynstr_cstring(&out), "body", "start");
+    first = field_value(atf_dynstr_cstring(&out), "body", "duration");
+
+    usleep(100000);
+    atf_dynstr_clear(&out);
+    RE(atf_timing_format(&t, "body", &out));
+    ATF_REQUIRE_EQ(start, field_value(atf_dynstr_cstring(&out), "body",
+                                      "start"));
+    ATF_REQUIRE(field_value(atf_dynstr_cstring(&out), "body", "duration")
+                >= first + 0.1);
+    ATF_REQUIRE(atf_timing_is_running(&t));
+    atf_dynstr_fini(&out);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, format_not_started);
+    ATF_TP_ADD_TC(tp, format_stopped);
+    ATF_TP_ADD_TC(tp, format_running);
+
+    return atf_no_error();
+}
@@ -27,8 +27,13 @@
 #include "config.h"
 #endif
 
+#include <sys/types.h>
+#include <sys/wait.h>
+
 #include <ctype.h>
+#include <errno.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,9 +41,18 @@
 
 #include "atf-c/detail/dynstr.h"
 #include "atf-c/detail/env.h"
+#include "atf-c/detail/filter.h"
 #include "atf-c/detail/fs.h"
+#include "atf-c/detail/history.h"
+#include "atf-c/detail/report.h"
 #include "atf-c/detail/map.h"
+#include "atf-c/detail/runner.h"
+#include "atf-c/detail/shard.h"
 #include "atf-c/detail/sanity.h"
+#include "atf-c/detail/tc.h"
+#include "atf-c/detail/text.h"
+#include "atf-c/detail/trace.h"
+#include "atf-c/detail/zygote.h"
 #include "atf-c/error.h"
 #include "atf-c/tc.h"
 #include "atf-c/tp.h"
@@ -130,6 +144,20 @@ print_warning(const char *message)
     fprintf(stderr, "%s: WARNING: %s\n", progname, message);
 }
 
+/** Reports a non-fatal error as a warning and frees it. */
+static
+void
+print_error_as_warning(const char *prefix, atf_error_t err)
+{
+    char buf[4096];
+
+    PRE(atf_is_error(err));
+
+    atf_error_format(err, buf, sizeof(buf));
+    atf_error_free(err);
+    fprintf(stderr, "%s: WARNING: %s: %s\n", progname, prefix, buf);
+}
+
 /* ---------------------------------------------------------------------
  * Options handling.
  * --------------------------------------------------------------------- */
@@ -139,6 +167,14 @@ struct params {
     atf_fs_path_t m_srcdir;
     char *m_tcname;
     enum tc_part m_tcpart;
+    size_t m_jobs;
+    size_t m_reruns;
+    char **m_tcnames;
+    int m_ntcnames;
+    const char *m_zygote;
+    bool m_timeouts;
+    atf_shard_t m_shard;
+    atf_filter_t m_filter;
     atf_fs_path_t m_resfile;
     atf_map_t m_config;
 };
@@ -170,6 +206,13 @@ params_init(struct params *p, const char *argv0)
     p->m_do_list = false;
     p->m_tcname = NULL;
     p->m_tcpart = BODY;
+    p->m_jobs = 0;
+    p->m_reruns = 0;
+    p->m_tcnames = NULL;
+    p->m_ntcnames = 0;
+    p->m_zygote = NULL;
+    p->m_timeouts = false;
+    atf_shard_init(&p->m_shard);
 
     err = argv0_to_dir(argv0, &p->m_srcdir);
     if (atf_is_error(err))
@@ -181,13 +224,21 @@ params_init(struct params *p, const char *argv0)
         return err;
     }
 
-    err = atf_map_init(&p->m_config);
+    err = atf_filter_init(&p->m_filter);
     if (atf_is_error(err)) {
         atf_fs_path_fini(&p->m_resfile);
         atf_fs_path_fini(&p->m_srcdir);
         return err;
     }
 
+    err = atf_map_init_interned(&p->m_config, NULL);
+    if (atf_is_error(err)) {
+        atf_filter_fini(&p->m_filter);
+        atf_fs_path_fini(&p->m_resfile);
+        atf_fs_path_fini(&p->m_srcdir);
+        return err;
+    }
+
     return err;
 }
 
@@ -196,6 +247,7 @@ void
 params_fini(struct params *p)
 {
     atf_map_fini(&p->m_config);
+    atf_filter_fini(&p->m_filter);
     atf_fs_path_fini(&p->m_resfile);
     atf_fs_path_fini(&p->m_srcdir);
     if (p->m_tcname != NULL)
@@ -224,6 +276,83 @@ out:
     return err;
 }
 
+static
+atf_error_t
+parse_jflag(const char *arg, size_t *jobs)
+{
+    atf_error_t err;
+    long value;
+
+    err = atf_text_to_long(arg, &value);
+    if (atf_is_error(err)) {
+        atf_error_free(err);
+        return usage_error("-j requires a non-negative integer");
+    }
+
+    if (value < 0)
+        return usage_error("-j requires a non-negative integer");
+    else if (value == 0) {
+        value = sysconf(_SC_NPROCESSORS_ONLN);
+        if (value < 1)
+            value = 1;
+    }
+
+    *jobs = (size_t)value;
+    return atf_no_error();
+}
+
+static
+atf_error_t
+parse_Rflag(const char *arg, size_t *reruns)
+{
+    atf_error_t err;
+    long value;
+
+    err = atf_text_to_long(arg, &value);
+    if (atf_is_error(err)) {
+        atf_error_free(err);
+        return usage_error("-R requires a positive integer");
+    }
+
+    if (value < 1)
+        return usage_error("-R requires a positive integer");
+
+    *reruns = (size_t)value;
+    return atf_no_error();
+}
+
+static
+atf_error_t
+parse_Fflag(const char *arg, atf_filter_t *filter)
+{
+    atf_error_t err;
+
+    err = atf_filter_add(filter, arg);
+    if (atf_is_error(err) && atf_error_is(err, "libc")) {
+        char buf[1024];
+
+        snprintf(buf, sizeof(buf), "%s", atf_libc_error_msg(err));
+        atf_error_free(err);
+        return usage_error("%s", buf);
+    }
+    return err;
+}
+
+static
+atf_error_t
+parse_Sflag(const char *arg, atf_shard_t *shard)
+{
+    atf_error_t err;
+
+    err = atf_shard_init_str(shard, arg);
+    if (atf_is_error(err)) {
+        atf_error_free(err);
+        return usage_error("-S requires an argument of the form index/count "
+                           "with index lower than count");
+    }
+    return err;
+}
+
 static
 atf_error_t
 replace_path_param(atf_fs_path_t *param, const char *value)
@@ -240,16 +369,52 @@ replace_path_param(atf_fs_path_t *param, const char *value)
     return err;
 }
 
+/* ---------------------------------------------------------------------
+ * Test case selection.
+ * --------------------------------------------------------------------- */
+
+static
+const char *
+lookup_md_var(const void *data, const char *name)
+{
+    const atf_tc_t *tc = data;
+
+    return atf_tc_has_md_var(tc, name) ? atf_tc_get_md_var(tc, name) : NULL;
+}
+
+/** Returns true if no test cases are excluded by -S nor -F. */
+static
+bool
+selects_all(const struct params *p)
+{
+    return atf_shard_is_all(&p->m_shard) && atf_filter_is_empty(&p->m_filter);
+}
+
+/** Returns true if the test case is in the shard and matches the filter.
+ *
+ * The shard only depends on the name of the test case, so it is checked
+ * first to avoid evaluating the head of the test cases in other shards. */
+static
+bool
+is_selected(const struct params *p, const atf_tc_t *tc)
+{
+    const char *ident = atf_tc_get_ident(tc);
+
+    return atf_shard_contains(&p->m_shard, ident) &&
+        atf_filter_matches(&p->m_filter, ident, lookup_md_var, tc);
+}
+
 /* ---------------------------------------------------------------------
  * Test case listing.
  * --------------------------------------------------------------------- */
 
 static
 void
-list_tcs(const atf_tp_t *tp)
+list_tcs(const atf_tp_t *tp, const struct params *p)
 {
     const atf_tc_t **tcs;
     const atf_tc_t *const *tcsptr;
+    bool first = true;
 
     printf("Content-Type: application/X-atf-tp; version=\"1\"\n\n");
 
@@ -257,13 +422,18 @@ list_tcs(const atf_tp_t *tp)
     INV(tcs != NULL);  /* Should be checked. */
     for (tcsptr = tcs; *tcsptr != NULL; tcsptr++) {
         const atf_tc_t *tc = *tcsptr;
-        char **vars = atf_tc_get_md_vars(tc);
+        char **vars;
         char **ptr;
 
+        if (!is_selected(p, tc))
+            continue;
+
+        vars = atf_tc_get_md_vars(tc);
         INV(vars != NULL);  /* Should be checked. */
 
-        if (tcsptr != tcs)  /* Not first. */
+        if (!first)
             printf("\n");
+        first = false;
 
         for (ptr = vars; *ptr != NULL; ptr += 2) {
             if (strcmp(*ptr, "ident") == 0) {
@@ -334,8 +504,28 @@ process_params(int argc, char **argv, struct params *p)
     old_opterr = opterr;
     opterr = 0;
     while (!atf_is_error(err) &&
-           (ch = getopt(argc, argv, GETOPT_POSIX ":lr:s:v:")) != -1) {
+           (ch = getopt(argc, argv, GETOPT_POSIX ":F:R:S:Tj:lr:s:v:z:")) != -1) {
         switch (ch) {
+        case 'F':
+            err = parse_Fflag(optarg, &p->m_filter);
+            break;
+
+        case 'R':
+            err = parse_Rflag(optarg, &p->m_reruns);
+            break;
+
+        case 'S':
+            err = parse_Sflag(optarg, &p->m_shard);
+            break;
+
+        case 'T':
+            p->m_timeouts = true;
+            break;
+
+        case 'j':
+            err = parse_jflag(optarg, &p->m_jobs);
+            break;
+
         case 'l':
             p->m_do_list = true;
             break;
@@ -352,6 +542,10 @@ process_params(int argc, char **argv, struct params *p)
             err = parse_vflag(optarg, &p->m_config);
             break;
 
+        case 'z':
+            p->m_zygote = optarg;
+            break;
+
         case ':':
             err = usage_error("Option -%c requires an argument.", optopt);
             break;
@@ -371,18 +565,37 @@ process_params(int argc, char **argv, struct params *p)
     optreset = 1;
 #endif
 
-    if (!atf_is_error(err)) {
-        if (p->m_do_list) {
+    if (!atf_is_error(err) && p->m_reruns > 0 && p->m_jobs == 0)
+        err = usage_error("Cannot use -R without -j");
+    else if (!atf_is_error(err)) {
+        if (p->m_zygote != NULL) {
+            if (p->m_do_list || p->m_jobs > 0 || p->m_timeouts ||
+                !selects_all(p))
+                err = usage_error("Cannot use -z with -j, -l, -F, -S or -T");
+            else if (argc > 0)
+                err = usage_error("Cannot provide test case names with -z");
+        } else if (p->m_do_list) {
             if (argc > 0)
                 err = usage_error("Cannot provide test case names with -l");
+            else if (p->m_jobs > 0)
+                err = usage_error("Cannot use -j with -l");
+        } else if (p->m_jobs > 0) {
+            p->m_tcnames = argv;
+            p->m_ntcnames = argc;
         } else {
             if (argc == 0)
                 err = usage_error("Must provide a test case name");
-            else if (argc == 1)
+            else if (argc == 1 && selects_all(p))
                 err = handle_tcarg(argv[0], &p->m_tcname, &p->m_tcpart);
-            else if (argc > 1) {
-                err = usage_error("Cannot provide more than one test case "
-                                  "name");
+            else {
+                /* A filtered run may skip the test case, so it always goes
+                 * through the batch mode and its results file template. */
+                if (strstr(atf_fs_path_cstring(&p->m_resfile), "%s") == NULL)
+                    err = usage_error("Must provide a results file template "
+                                      "containing %%s when running more than "
+                                      "one test case or with -F or -S");
+                p->m_tcnames = argv;
+                p->m_ntcnames = argc;
             }
         }
     }
@@ -478,11 +691,102 @@ out:
     return err;
 }
 
+/** Computes the results file of a test case.
+ *
+ * The first occurrence of %s in the results file given by the user, if any,
+ * is replaced by the name of the test case. */
+static
+atf_error_t
+expand_resfile(const atf_fs_path_t *template, const char *tcname,
+               atf_fs_path_t *resfile)
+{
+    const char *str = atf_fs_path_cstring(template);
+    const char *pos = strstr(str, "%s");
+
+    if (pos == NULL)
+        return atf_fs_path_copy(resfile, template);
+    else
+        return atf_fs_path_init_fmt(resfile, "%.*s%s%s", (int)(pos - str),
+                                    str, tcname, pos + 2);
+}
+
+static
+void
+warn_if_unsupervised(void)
+{
+    if (!atf_env_has("__RUNNING_INSIDE_ATF_RUN") || strcmp(atf_env_get(
+        "__RUNNING_INSIDE_ATF_RUN"), "internal-yes-value") != 0)
+    {
+        print_warning("Running test cases outside of kyua(1) is unsupported");
+        print_warning("No isolation nor timeout control is being applied; you "
+                      "may get unexpected failures; see atf-test-case(4)");
+    }
+}
+
+static
+void
+run_tc_part(void *data, const char *tcname, const bool cleanup,
+            const char *resfile)
+{
+    const atf_tp_t *tp = data;
+    atf_error_t err;
+
+    /* Only the work done in this child counts towards its initialization. */
+    atf_tc_start_init_timing();
+
+    if (cleanup)
+        err = atf_tc_cleanup_resfile(atf_tp_get_tc(tp, tcname), resfile);
+    else
+        err = atf_tp_run(tp, tcname, resfile);
+
+    if (atf_is_error(err)) {
+        print_error(err);
+        atf_error_free(err);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/** Returns the value of the timeout property of a test case in seconds. */
+static
+unsigned int
+tc_timeout(const atf_tc_t *tc)
+{
+    atf_error_t err;
+    long timeout;
+
+    if (!atf_tc_has_md_var(tc, "timeout"))
+        return 0;
+    err = atf_text_to_long(atf_tc_get_md_var(tc, "timeout"), &timeout);
+    if (atf_is_error(err)) {
+        atf_error_free(err);
+        return 0;
+    }
+    return timeout < 0 ? 0 : (unsigned int)timeout;
+}
+
+/** Runs the body of a test case in a subprocess honoring its timeout. */
+static
+atf_error_t
+run_body_with_timeout(const atf_tp_t *tp, const char *tcname,
+                      const char *resfile, int *exitcode)
+{
+    atf_error_t err;
+    bool ok;
+
+    err = atf_runner_run_body(run_tc_part, (void *)(uintptr_t)tp, tcname,
+                              tc_timeout(atf_tp_get_tc(tp, tcname)), resfile,
+                              &ok);
+    if (!atf_is_error(err))
+        *exitcode = ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    return err;
+}
+
 static
 atf_error_t
 run_tc(const atf_tp_t *tp, struct params *p, int *exitcode)
 {
     atf_error_t err;
+    atf_fs_path_t resfile;
 
     err = atf_no_error();
 
@@ -491,17 +795,22 @@ run_tc(const atf_tp_t *tp, struct params *p, int *exitcode)
         goto out;
     }
 
-    if (!atf_env_has("__RUNNING_INSIDE_ATF_RUN") || strcmp(atf_env_get(
-        "__RUNNING_INSIDE_ATF_RUN"), "internal-yes-value") != 0)
-    {
-        print_warning("Running test cases outside of kyua(1) is unsupported");
-        print_warning("No isolation nor timeout control is being applied; you "
-                      "may get unexpected failures; see atf-test-case(4)");
-    }
+    warn_if_unsupervised();
 
     switch (p->m_tcpart) {
     case BODY:
-        err = atf_tp_run(tp, p->m_tcname, atf_fs_path_cstring(&p->m_resfile));
+        err = expand_resfile(&p->m_resfile, p->m_tcname, &resfile);
+        if (atf_is_error(err))
+            goto out;
+        if (p->m_timeouts) {
+            err = run_body_with_timeout(tp, p->m_tcname,
+                                        atf_fs_path_cstring(&resfile),
+                                        exitcode);
+            atf_fs_path_fini(&resfile);
+            break;
+        }
+        err = atf_tp_run(tp, p->m_tcname, atf_fs_path_cstring(&resfile));
+        atf_fs_path_fini(&resfile);
         if (atf_is_error(err)) {
             /* TODO: Handle error */
             *exitcode = EXIT_FAILURE;
@@ -513,7 +822,12 @@ run_tc(const atf_tp_t *tp, struct params *p, int *exitcode)
         break;
 
     case CLEANUP:
-        err = atf_tp_cleanup(tp, p->m_tcname);
+        err = expand_resfile(&p->m_resfile, p->m_tcname, &resfile);
+        if (atf_is_error(err))
+            goto out;
+        err = atf_tc_cleanup_resfile(atf_tp_get_tc(tp, p->m_tcname),
+                                     atf_fs_path_cstring(&resfile));
+        atf_fs_path_fini(&resfile);
         if (atf_is_error(err)) {
             /* TODO: Handle error */
             *exitcode = EXIT_FAILURE;
@@ -533,6 +847,313 @@ out:
     return err;
 }
 
+static
+atf_error_t
+add_runner_tc(atf_runner_t *runner, const atf_tc_t *tc, const bool timeouts)
+{
+    const bool has_cleanup = atf_tc_has_md_var(tc, "has.cleanup") &&
+        strcmp(atf_tc_get_md_var(tc, "has.cleanup"), "true") == 0;
+
+    return atf_runner_add_tc(runner, atf_tc_get_ident(tc), has_cleanup,
+                             timeouts ? tc_timeout(tc) : 0);
+}
+
+/** Computes the path to the history of test case durations.
+ *
+ * The history lives next to the test program unless ATF_HISTORY_FILE names
+ * another file.  Returns false if ATF_HISTORY_FILE is empty, which disables
+ * the history, in which case path is left uninitialized. */
+static
+atf_error_t
+history_path(const struct params *p, atf_fs_path_t *path, bool *enabled)
+{
+    atf_map_citer_t iter;
+
+    *enabled = true;
+    if (atf_env_has("ATF_HISTORY_FILE")) {
+        const char *value = atf_env_get("ATF_HISTORY_FILE");
+
+        *enabled = value[0] != '\0';
+        return *enabled ? atf_fs_path_init_fmt(path, "%s", value) :
+            atf_no_error();
+    }
+
+    iter = atf_map_find_c(&p->m_config, "srcdir");
+    INV(!atf_equal_map_citer_map_citer(iter, atf_map_end_c(&p->m_config)));
+    return atf_fs_path_init_fmt(path, "%s/%s.history",
+                                (const char *)atf_map_citer_data(iter),
+                                progname);
+}
+
+static
+bool
+is_permission_error(const atf_error_t err)
+{
+    if (!atf_error_is(err, "libc"))
+        return false;
+    return atf_libc_error_code(err) == EACCES ||
+        atf_libc_error_code(err) == EPERM ||
+        atf_libc_error_code(err) == EROFS;
+}
+
+/** Closes the report of a run, keeping the first error of the run. */
+static
+void
+close_report(atf_report_t *report, atf_error_t *err)
+{
+    atf_error_t cerr;
+
+    cerr = atf_report_close(report);
+    if (!atf_is_error(*err))
+        *err = cerr;
+    else if (atf_is_error(cerr))
+        atf_error_free(cerr);
+}
+
+/** Runs several test cases of the program, each in a forked child.
+ *
+ * If no test case names were given, all test cases are run.  Either way,
+ * the slowest test cases according to the durations recorded by previous
+ * runs start first, and the history is updated afterwards.  Problems with
+ * the history file are only reported as warnings as it does not affect the
+ * results. */
+static
+atf_error_t
+run_tcs(const atf_tp_t *tp, struct params *p, int *exitcode)
+{
+    atf_error_t err;
+    atf_runner_t runner;
+    atf_history_t history;
+    atf_fs_path_t histpath;
+    atf_report_t report;
+    bool all_ok, use_history, use_report;
+    int i;
+
+    err = history_path(p, &histpath, &use_history);
+    if (atf_is_error(err))
+        goto out;
+
+    err = atf_history_init(&history);
+    if (atf_is_error(err))
+        goto out_histpath;
+    if (use_history) {
+        atf_error_t herr = atf_history_load(&history,
+                                            atf_fs_path_cstring(&histpath));
+        if (atf_is_error(herr))
+            print_error_as_warning("Cannot load test case durations", herr);
+    }
+
+    err = atf_runner_init(&runner, run_tc_part, (void *)(uintptr_t)tp);
+    if (atf_is_error(err))
+        goto out_history;
+    atf_runner_set_jobs(&runner, p->m_jobs);
+    atf_runner_set_reruns(&runner, p->m_reruns);
+    if (use_history)
+        atf_runner_set_history(&runner, &history);
+
+    err = atf_report_open_from_env(&report, progname, &use_report);
+    if (atf_is_error(err))
+        goto out_runner;
+    if (use_report)
+        atf_runner_set_report(&runner, &report);
+
+    if (p->m_ntcnames == 0) {
+        const atf_tc_t **tcs, *const *tcsptr;
+
+        tcs = atf_tp_get_tcs(tp);
+        if (tcs == NULL) {
+            err = atf_no_memory_error();
+            goto out_report;
+        }
+        for (tcsptr = tcs; !atf_is_error(err) && *tcsptr != NULL; tcsptr++) {
+            if (is_selected(p, *tcsptr))
+                err = add_runner_tc(&runner, *tcsptr, p->m_timeouts);
+        }
+        free(tcs);
+    } else {
+        for (i = 0; !atf_is_error(err) && i < p->m_ntcnames; i++) {
+            const char *tcname = p->m_tcnames[i];
+
+            if (strchr(tcname, ':') != NULL)
+                err = usage_error("Cannot select test case parts when running "
+                                  "more than one test case");
+            else if (!atf_tp_has_tc(tp, tcname))
+                err = usage_error("Unknown test case `%s'", tcname);
+            else if (is_selected(p, atf_tp_get_tc(tp, tcname)))
+                err = add_runner_tc(&runner, atf_tp_get_tc(tp, tcname),
+                                    p->m_timeouts);
+        }
+    }
+    if (atf_is_error(err))
+        goto out_report;
+
+    err = atf_runner_run(&runner, atf_fs_path_cstring(&p->m_resfile), &all_ok);
+    if (!atf_is_error(err))
+        *exitcode = all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (!atf_is_error(err) && use_history) {
+        atf_error_t herr = atf_history_save(&history,
+                                            atf_fs_path_cstring(&histpath));
+        if (atf_is_error(herr) && is_permission_error(herr))
+            atf_error_free(herr);  /* E.g. an installed, read-only test. */
+        else if (atf_is_error(herr))
+            print_error_as_warning("Cannot save test case durations", herr);
+    }
+
+out_report:
+    if (use_report)
+        close_report(&report, &err);
+out_runner:
+    atf_runner_fini(&runner);
+out_history:
+    atf_history_fini(&history);
+out_histpath:
+    if (use_history)
+        atf_fs_path_fini(&histpath);
+out:
+    return err;
+}
+
+/** Runs a single test case part in a forked child and waits for it.
+ *
+ * ok is set to false if the child did not exit successfully.  If report is
+ * not NULL, the result of the body is added to it. */
+static
+atf_error_t
+run_batch_tc(const atf_tp_t *tp, const char *tcname, const enum tc_part part,
+             const struct params *p, atf_report_t *report, bool *ok)
+{
+    atf_error_t err;
+    atf_fs_path_t resfile;
+    pid_t pid;
+    int status;
+
+    err = expand_resfile(&p->m_resfile, tcname, &resfile);
+    if (atf_is_error(err))
+        goto out;
+
+    if (part == BODY && p->m_timeouts) {
+        err = run_body_with_timeout(tp, tcname, atf_fs_path_cstring(&resfile),
+                                    &status);
+        if (!atf_is_error(err) && status != EXIT_SUCCESS)
+            *ok = false;
+        goto out_report;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid = fork();
+    if (pid == -1) {
+        err = atf_libc_error(errno, "Failed to fork");
+        goto out_resfile;
+    } else if (pid == 0) {
+        run_tc_part((void *)(uintptr_t)tp, tcname, part == CLEANUP,
+                    atf_fs_path_cstring(&resfile));
+        exit(EXIT_SUCCESS);
+    }
+
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            err = atf_libc_error(errno, "Failed to wait for test case");
+            goto out_resfile;
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        *ok = false;
+
+out_report:
+    if (!atf_is_error(err) && part == BODY && report != NULL)
+        err = atf_runner_report_resfile(report, tcname,
+                                        atf_fs_path_cstring(&resfile));
+out_resfile:
+    atf_fs_path_fini(&resfile);
+out:
+    return err;
+}
+
+/** Runs several test cases, one after the other, each in a forked child.
+ *
+ * Every test case writes its result to the file obtained by expanding the
+ * results file template with its name. */
+static
+atf_error_t
+run_batch(const atf_tp_t *tp, struct params *p, int *exitcode)
+{
+    atf_error_t err;
+    atf_report_t report;
+    char **tcnames;
+    enum tc_part *tcparts;
+    bool ok, use_report;
+    int i;
+
+    tcnames = calloc(p->m_ntcnames, sizeof(char *));
+    tcparts = calloc(p->m_ntcnames, sizeof(enum tc_part));
+    if (tcnames == NULL || tcparts == NULL) {
+        err = atf_no_memory_error();
+        goto out;
+    }
+
+    err = atf_no_error();
+    for (i = 0; !atf_is_error(err) && i < p->m_ntcnames; i++) {
+        tcparts[i] = BODY;
+        err = handle_tcarg(p->m_tcnames[i], &tcnames[i], &tcparts[i]);
+        if (!atf_is_error(err) && !atf_tp_has_tc(tp, tcnames[i]))
+            err = usage_error("Unknown test case `%s'", tcnames[i]);
+    }
+    if (atf_is_error(err))
+        goto out;
+
+    warn_if_unsupervised();
+
+    err = atf_report_open_from_env(&report, progname, &use_report);
+    if (atf_is_error(err))
+        goto out;
+
+    ok = true;
+    for (i = 0; !atf_is_error(err) && i < p->m_ntcnames; i++) {
+        if (is_selected(p, atf_tp_get_tc(tp, tcnames[i])))
+            err = run_batch_tc(tp, tcnames[i], tcparts[i], p,
+                               use_report ? &report : NULL, &ok);
+    }
+    if (use_report)
+        close_report(&report, &err);
+    if (!atf_is_error(err))
+        *exitcode = ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+out:
+    if (tcnames != NULL) {
+        for (i = 0; i < p->m_ntcnames; i++)
+            free(tcnames[i]);
+    }
+    free(tcnames);
+    free(tcparts);
+    return err;
+}
+
+static
+bool
+zygote_has_tc(void *data, const char *tcname)
+{
+    const atf_tp_t *tp = data;
+
+    return atf_tp_has_tc(tp, tcname);
+}
+
+/** Serves requests to run test cases until the client asks to quit. */
+static
+atf_error_t
+serve_tcs(const atf_tp_t *tp, struct params *p, int *exitcode)
+{
+    atf_error_t err;
+
+    err = atf_zygote_serve(p->m_zygote, zygote_has_tc, run_tc_part,
+                           (void *)(uintptr_t)tp);
+    if (!atf_is_error(err))
+        *exitcode = EXIT_SUCCESS;
+    return err;
+}
+
 static
 atf_error_t
 controlled_main(int argc, char **argv,
@@ -542,6 +1163,7 @@ controlled_main(int argc, char **argv,
     atf_error_t err;
     struct params p;
     atf_tp_t tp;
+    atf_trace_span_t span;
     char **raw_config;
 
     err = process_params(argc, argv, &p);
@@ -557,6 +1179,7 @@ controlled_main(int argc, char **argv,
         err = atf_no_memory_error();
         goto out_p;
     }
+    atf_trace_begin(&span);
     err = atf_tp_init(&tp, (const char* const*)raw_config);
     atf_utils_free_charpp(raw_config);
     if (atf_is_error(err))
@@ -565,11 +1188,18 @@ controlled_main(int argc, char **argv,
     err = add_tcs_hook(&tp);
     if (atf_is_error(err))
         goto out_tp;
+    atf_trace_end(&span, "tp", "register", progname);
 
     if (p.m_do_list) {
-        list_tcs(&tp);
+        list_tcs(&tp, &p);
         INV(!atf_is_error(err));
         *exitcode = EXIT_SUCCESS;
+    } else if (p.m_zygote != NULL) {
+        err = serve_tcs(&tp, &p, exitcode);
+    } else if (p.m_jobs > 0) {
+        err = run_tcs(&tp, &p, exitcode);
+    } else if (p.m_ntcnames > 0) {
+        err = run_batch(&tp, &p, exitcode);
     } else {
         err = run_tc(&tp, &p, exitcode);
     }
@@ -588,6 +1218,8 @@ atf_tp_main(int argc, char **argv, atf_error_t (*add_tcs_hook)(atf_tp_t *))
     atf_error_t err;
     int exitcode;
 
+    atf_tc_start_init_timing();
+
     progname = strrchr(argv[0], '/');
     if (progname == NULL)
         progname = argv[0];
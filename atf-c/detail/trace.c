@@ -0,0 +1,241 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/trace.h"
+
+#include <sys/types.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Events are kept in a buffer and appended to the trace file when the
+ * buffer fills up and when the process exits, so that recording an event
+ * costs a clock read and a formatted copy.  The file uses the JSON array
+ * flavor of the Chrome trace event format, which tolerates the missing
+ * closing bracket and trailing comma: every process appends its events,
+ * one per line, under an exclusive lock, and the first one to find the
+ * file empty writes the opening bracket.  Tracing is best effort, so
+ * errors writing the file are ignored.
+ */
+
+#define BUFFER_SIZE 65536
+#define EVENT_SIZE 1024
+
+static enum { UNKNOWN, DISABLED, ENABLED } State = UNKNOWN;
+static bool Registered = false;
+static const char *Path;
+static char Buffer[BUFFER_SIZE];
+static size_t Length;
+static pid_t Owner;
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+long long
+now_usecs(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static
+void
+flush_at_exit(void)
+{
+    atf_trace_flush();
+}
+
+static
+bool
+enabled(void)
+{
+    if (State == UNKNOWN)
+        atf_trace_open(getenv("ATF_TRACE_FILE"));
+    return State == ENABLED;
+}
+
+/*
+ * Drops the events inherited from the parent of a forked process, which
+ * the parent itself will write.
+ */
+static
+void
+claim_buffer(void)
+{
+    const pid_t pid = getpid();
+
+    if (pid != Owner) {
+        Owner = pid;
+        Length = 0;
+    }
+}
+
+/*
+ * Formats str as a JSON string at the end of buf, truncating it to fit.
+ * Returns the new length of buf.
+ */
+static
+size_t
+format_string(char *buf, size_t len, const size_t size, const char *str)
+{
+    buf[len++] = '"';
+    for (; *str != '\0' && len < size - 8; str++) {
+        const unsigned char ch = (unsigned char)*str;
+
+        if (ch == '"' || ch == '\\') {
+            buf[len++] = '\\';
+            buf[len++] = ch;
+        } else if (ch < 0x20)
+            len += snprintf(buf + len, size - len, "\\u%04x", ch);
+        else
+            buf[len++] = ch;
+    }
+    buf[len++] = '"';
+    buf[len] = '\0';
+    return len;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_trace_span" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Modifiers.
+ */
+
+void
+atf_trace_begin(atf_trace_span_t *s)
+{
+    s->m_start = enabled() ? now_usecs() : -1;
+}
+
+/*
+ * Records a complete event for the given span, named name under the
+ * category cat, with detail, if not NULL, as its only argument.
+ */
+void
+atf_trace_end(const atf_trace_span_t *s, const char *cat, const char *name,
+              const char *detail)
+{
+    char event[EVENT_SIZE];
+    size_t len;
+
+    if (s->m_start < 0)
+        return;
+
+    claim_buffer();
+
+    len = snprintf(event, sizeof(event), "{\"name\": ");
+    len = format_string(event, len, sizeof(event) / 4, name);
+    len += snprintf(event + len, sizeof(event) - len, ", \"cat\": ");
+    len = format_string(event, len, sizeof(event) / 2, cat);
+    len += snprintf(event + len, sizeof(event) - len, ", \"ph\": \"X\", "
+                    "\"ts\": %lld, \"dur\": %lld, \"pid\": %ld, "
+                    "\"tid\": %ld", s->m_start, now_usecs() - s->m_start,
+                    (long)Owner, (long)Owner);
+    if (detail != NULL) {
+        len += snprintf(event + len, sizeof(event) - len,
+                        ", \"args\": {\"detail\": ");
+        len = format_string(event, len, sizeof(event) - 8, detail);
+        len += snprintf(event + len, sizeof(event) - len, "}");
+    }
+    len += snprintf(event + len, sizeof(event) - len, "},\n");
+
+    if (Length + len > sizeof(Buffer))
+        atf_trace_flush();
+    memcpy(Buffer + Length, event, len);
+    Length += len;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Sends the events of this process to the given trace file, which is not
+ * copied, or disables tracing if path is NULL or empty.  Tracing is
+ * otherwise configured from ATF_TRACE_FILE the first time it is used.
+ */
+void
+atf_trace_open(const char *path)
+{
+    Path = path;
+    State = path == NULL || path[0] == '\0' ? DISABLED : ENABLED;
+    Owner = getpid();
+    Length = 0;
+    if (State == ENABLED && !Registered) {
+        (void)atexit(flush_at_exit);
+        Registered = true;
+    }
+}
+
+/*
+ * Appends the events recorded by this process to the trace file.
+ */
+void
+atf_trace_flush(void)
+{
+    static char Header[] = "[\n";
+    struct iovec iov[2];
+    struct stat sb;
+    int count = 0, fd;
+
+    if (State != ENABLED)
+        return;
+    claim_buffer();
+    if (Length == 0)
+        return;
+
+    fd = open(Path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+        return;
+    if (flock(fd, LOCK_EX) != -1) {
+        if (fstat(fd, &sb) != -1 && sb.st_size == 0) {
+            iov[count].iov_base = Header;
+            iov[count++].iov_len = sizeof(Header) - 1;
+        }
+        iov[count].iov_base = Buffer;
+        iov[count++].iov_len = Length;
+
+        while (writev(fd, iov, count) == -1 && errno == EINTR)
+            continue; /* Retry. */
+    }
+    close(fd);
+    Length = 0;
+}
@@ -0,0 +1,160 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/trace.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+/* Counts the lines of a file that are exactly line. */
+static
+size_t
+count_lines(const char *path, const char *line)
+{
+    char buf[1024];
+    size_t count = 0;
+    FILE *f;
+
+    f = fopen(path, "r");
+    ATF_REQUIRE(f != NULL);
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        buf[strcspn(buf, "\n")] = '\0';
+        if (strcmp(buf, line) == 0)
+            count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/* Records a complete event of the given name. */
+static
+void
+record(const char *name, const char *detail)
+{
+    atf_trace_span_t s;
+
+    atf_trace_begin(&s);
+    ATF_REQUIRE(s.m_start >= 0);
+    atf_trace_end(&s, "test", name, detail);
+}
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_trace_span" type.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(disabled);
+ATF_TC_BODY(disabled, tc)
+{
+    atf_trace_span_t s;
+
+    atf_trace_open(NULL);
+    atf_trace_begin(&s);
+    ATF_REQUIRE(s.m_start < 0);
+    atf_trace_end(&s, "test", "event", NULL);
+    atf_trace_flush();
+
+    atf_trace_open("");
+    atf_trace_begin(&s);
+    ATF_REQUIRE(s.m_start < 0);
+}
+
+ATF_TC_WITHOUT_HEAD(events);
+ATF_TC_BODY(events, tc)
+{
+    atf_trace_open("trace");
+    record("first", NULL);
+    record("second", "a \"quoted\"\nline");
+    ATF_REQUIRE(!atf_utils_file_exists("trace"));
+    atf_trace_flush();
+    atf_trace_open(NULL);
+
+    atf_utils_cat_file("trace", "trace: ");
+    ATF_REQUIRE_EQ(1, count_lines("trace", "["));
+    ATF_REQUIRE(atf_utils_grep_file("^\\{\"name\": \"first\", \"cat\": "
+        "\"test\", \"ph\": \"X\", \"ts\": [0-9]+, \"dur\": [0-9]+, "
+        "\"pid\": %d, \"tid\": %d\\},$", "trace", getpid(), getpid()));
+    ATF_REQUIRE(atf_utils_grep_file("\"name\": \"second\", .*\"args\": "
+        "\\{\"detail\": \"a \\\\\"quoted\\\\\"\\\\u000aline\"\\}\\},$",
+        "trace"));
+}
+
+ATF_TC_WITHOUT_HEAD(several_processes);
+ATF_TC_BODY(several_processes, tc)
+{
+    pid_t pid;
+    int status;
+
+    atf_trace_open("trace");
+    record("parent", NULL);
+
+    pid = fork();
+    ATF_REQUIRE(pid != -1);
+    if (pid == 0) {
+        record("child", NULL);
+        exit(EXIT_SUCCESS);
+    }
+    ATF_REQUIRE(waitpid(pid, &status, 0) != -1);
+    ATF_REQUIRE(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+    /* The child only wrote its own event, after the opening bracket. */
+    ATF_REQUIRE_EQ(1, count_lines("trace", "["));
+    ATF_REQUIRE(atf_utils_grep_file("\"child\", .*\"pid\": %d,", "trace",
+                                    pid));
+    ATF_REQUIRE(!atf_utils_grep_file("\"parent\"", "trace"));
+
+    atf_trace_flush();
+    atf_trace_open(NULL);
+
+    atf_utils_cat_file("trace", "trace: ");
+    ATF_REQUIRE(atf_utils_grep_file("\"parent\", .*\"pid\": %d,", "trace",
+                                    getpid()));
+    ATF_REQUIRE_EQ(1, count_lines("trace", "["));
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, disabled);
+    ATF_TP_ADD_TC(tp, events);
+    ATF_TP_ADD_TC(tp, several_processes);
+
+    return atf_no_error();
+}
@@ -0,0 +1,220 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/vars.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+struct vars_entry {
+    const char *m_key;
+    const char *m_value;
+    size_t m_pos;
+};
+
+/*
+ * The whole table lives in a single allocation: the header is followed
+ * by the entries, sorted by key, and then by the text of all keys and
+ * values.
+ */
+struct atf_vars {
+    size_t m_refs;
+    size_t m_size;
+    struct vars_entry m_entries[];
+};
+
+/*
+ * Orders entries by key and, for equal keys, by their position in the
+ * original array so that later definitions can override earlier ones.
+ */
+static
+int
+compare_entries(const void *a, const void *b)
+{
+    const struct vars_entry *e1 = a;
+    const struct vars_entry *e2 = b;
+    const int cmp = strcmp(e1->m_key, e2->m_key);
+
+    if (cmp != 0)
+        return cmp;
+    else if (e1->m_pos < e2->m_pos)
+        return -1;
+    else if (e1->m_pos > e2->m_pos)
+        return 1;
+    else
+        return 0;
+}
+
+static
+int
+compare_key(const void *key, const void *entry)
+{
+    return strcmp(key, ((const struct vars_entry *)entry)->m_key);
+}
+
+static
+char *
+copy_text(char *dest, const char *src)
+{
+    const size_t len = strlen(src) + 1;
+
+    memcpy(dest, src, len);
+    return dest + len;
+}
+
+/* ---------------------------------------------------------------------
+ * The "atf_vars" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors/destructors.
+ */
+
+atf_error_t
+atf_vars_new(atf_vars_t **out, const char *const *array)
+{
+    atf_vars_t *vars;
+    const char *const *ptr;
+    size_t i, j, n, textlen;
+    char *text;
+
+    n = 0;
+    textlen = 0;
+    for (ptr = array; ptr != NULL && *ptr != NULL; ptr += 2) {
+        if (*(ptr + 1) == NULL)
+            return atf_libc_error(EINVAL, "List too short; no value for "
+                "key '%s' provided", *ptr);  /* XXX: Not really libc_error */
+        textlen += strlen(*ptr) + 1 + strlen(*(ptr + 1)) + 1;
+        n++;
+    }
+
+    vars = malloc(sizeof(*vars) + sizeof(struct vars_entry) * n + textlen);
+    if (vars == NULL)
+        return atf_no_memory_error();
+    vars->m_refs = 1;
+
+    text = (char *)&vars->m_entries[n];
+    for (i = 0; i < n; i++) {
+        struct vars_entry *entry = &vars->m_entries[i];
+
+        entry->m_key = text;
+        text = copy_text(text, array[i * 2]);
+        entry->m_value = text;
+        text = copy_text(text, array[i * 2 + 1]);
+        entry->m_pos = i;
+    }
+    qsort(vars->m_entries, n, sizeof(struct vars_entry), compare_entries);
+
+    /* Keep only the last definition of every key. */
+    j = 0;
+    for (i = 0; i < n; i++) {
+        if (i + 1 < n && strcmp(vars->m_entries[i].m_key,
+                                vars->m_entries[i + 1].m_key) == 0)
+            continue;
+        vars->m_entries[j++] = vars->m_entries[i];
+    }
+    vars->m_size = j;
+
+    *out = vars;
+    return atf_no_error();
+}
+
+atf_vars_t *
+atf_vars_ref(atf_vars_t *vars)
+{
+    PRE(vars->m_refs > 0);
+    vars->m_refs++;
+    return vars;
+}
+
+void
+atf_vars_unref(atf_vars_t *vars)
+{
+    PRE(vars->m_refs > 0);
+    vars->m_refs--;
+    if (vars->m_refs == 0)
+        free(vars);
+}
+
+/*
+ * Getters.
+ */
+
+/*
+ * Returns the value of the given variable, or NULL if it is not defined.
+ */
+const char *
+atf_vars_get(const atf_vars_t *vars, const char *key)
+{
+    const struct vars_entry *entry;
+
+    entry = bsearch(key, vars->m_entries, vars->m_size,
+                    sizeof(struct vars_entry), compare_key);
+    return entry == NULL ? NULL : entry->m_value;
+}
+
+size_t
+atf_vars_size(const atf_vars_t *vars)
+{
+    return vars->m_size;
+}
+
+char **
+atf_vars_to_charpp(const atf_vars_t *vars)
+{
+    char **array;
+    size_t i;
+
+    array = malloc(sizeof(char *) * (vars->m_size * 2 + 1));
+    if (array == NULL)
+        goto out;
+
+    for (i = 0; i < vars->m_size * 2 + 1; i++)
+        array[i] = NULL;
+
+    for (i = 0; i < vars->m_size; i++) {
+        array[i * 2] = strdup(vars->m_entries[i].m_key);
+        array[i * 2 + 1] = strdup(vars->m_entries[i].m_value);
+        if (array[i * 2] == NULL || array[i * 2 + 1] == NULL) {
+            free(array[i * 2]);
+            array[i * 2] = NULL;
+            atf_utils_free_charpp(array);
+            array = NULL;
+            goto out;
+        }
+    }
+
+out:
+    return array;
+}
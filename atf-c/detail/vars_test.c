@@ -0,0 +1,151 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/vars.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Tests for the "atf_vars" type.
+ * --------------------------------------------------------------------- */
+
+/*
+ * Constructors and destructors.
+ */
+
+ATF_TC_WITHOUT_HEAD(vars_new_null);
+ATF_TC_BODY(vars_new_null, tc)
+{
+    atf_vars_t *vars;
+
+    RE(atf_vars_new(&vars, NULL));
+    ATF_REQUIRE_EQ(0, atf_vars_size(vars));
+    ATF_REQUIRE(atf_vars_get(vars, "foo") == NULL);
+    atf_vars_unref(vars);
+}
+
+ATF_TC_WITHOUT_HEAD(vars_new_some);
+ATF_TC_BODY(vars_new_some, tc)
+{
+    const char *const array[] = { "K1", "V1", "K2", "", "K0", "V0", NULL };
+    atf_vars_t *vars;
+
+    RE(atf_vars_new(&vars, array));
+    ATF_REQUIRE_EQ(3, atf_vars_size(vars));
+    ATF_REQUIRE_STREQ("V0", atf_vars_get(vars, "K0"));
+    ATF_REQUIRE_STREQ("V1", atf_vars_get(vars, "K1"));
+    ATF_REQUIRE_STREQ("", atf_vars_get(vars, "K2"));
+    ATF_REQUIRE(atf_vars_get(vars, "K3") == NULL);
+    atf_vars_unref(vars);
+}
+
+ATF_TC_WITHOUT_HEAD(vars_new_duplicates);
+ATF_TC_BODY(vars_new_duplicates, tc)
+{
+    const char *const array[] = { "K1", "first", "K2", "V2", "K1", "second",
+                                  "K1", "third", NULL };
+    atf_vars_t *vars;
+
+    RE(atf_vars_new(&vars, array));
+    ATF_REQUIRE_EQ(2, atf_vars_size(vars));
+    ATF_REQUIRE_STREQ("third", atf_vars_get(vars, "K1"));
+    ATF_REQUIRE_STREQ("V2", atf_vars_get(vars, "K2"));
+    atf_vars_unref(vars);
+}
+
+ATF_TC_WITHOUT_HEAD(vars_new_short);
+ATF_TC_BODY(vars_new_short, tc)
+{
+    const char *const array[] = { "K1", "V1", "K2", NULL };
+    atf_error_t err;
+    atf_vars_t *vars;
+
+    err = atf_vars_new(&vars, array);
+    ATF_REQUIRE(atf_is_error(err));
+    ATF_REQUIRE(atf_error_is(err, "libc"));
+    atf_error_free(err);
+}
+
+ATF_TC_WITHOUT_HEAD(vars_ref);
+ATF_TC_BODY(vars_ref, tc)
+{
+    const char *const array[] = { "K1", "V1", NULL };
+    atf_vars_t *vars, *vars2;
+
+    RE(atf_vars_new(&vars, array));
+    vars2 = atf_vars_ref(vars);
+    ATF_REQUIRE(vars == vars2);
+    atf_vars_unref(vars);
+    ATF_REQUIRE_STREQ("V1", atf_vars_get(vars2, "K1"));
+    atf_vars_unref(vars2);
+}
+
+/*
+ * Getters.
+ */
+
+ATF_TC_WITHOUT_HEAD(to_charpp);
+ATF_TC_BODY(to_charpp, tc)
+{
+    const char *const array[] = { "K2", "V2", "K1", "V1", NULL };
+    atf_vars_t *vars;
+    char **result;
+
+    RE(atf_vars_new(&vars, array));
+    result = atf_vars_to_charpp(vars);
+    ATF_REQUIRE(result != NULL);
+    ATF_REQUIRE_STREQ("K1", result[0]);
+    ATF_REQUIRE_STREQ("V1", result[1]);
+    ATF_REQUIRE_STREQ("K2", result[2]);
+    ATF_REQUIRE_STREQ("V2", result[3]);
+    ATF_REQUIRE(result[4] == NULL);
+    atf_utils_free_charpp(result);
+    atf_vars_unref(vars);
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    /* Constructors and destructors. */
+    ATF_TP_ADD_TC(tp, vars_new_null);
+    ATF_TP_ADD_TC(tp, vars_new_some);
+    ATF_TP_ADD_TC(tp, vars_new_duplicates);
+    ATF_TP_ADD_TC(tp, vars_new_short);
+    ATF_TP_ADD_TC(tp, vars_ref);
+
+    /* Getters. */
+    ATF_TP_ADD_TC(tp, to_charpp);
+
+    return atf_no_error();
+}
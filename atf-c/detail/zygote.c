@@ -0,0 +1,381 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/zygote.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "atf-c/defs.h"
+#include "atf-c/detail/dynstr.h"
+#include "atf-c/detail/sanity.h"
+#include "atf-c/error.h"
+
+/*
+ * The zygote keeps an already-initialized test program resident and forks
+ * a child for every test case that it is asked to run, saving the cost of
+ * executing and initializing the test program once per test case.
+ *
+ * The protocol is line-based.  Each request is one of:
+ *
+ *     run <tcname>[:body|:cleanup] <resfile>
+ *     quit
+ *
+ * and every "run" request is answered, once the child terminates, with one
+ * of:
+ *
+ *     exit <code>
+ *     signal <signo>
+ *     error <message>
+ *
+ * The results file is optional when running a cleanup routine.
+ */
+
+struct command {
+    const char *m_tcname;
+    bool m_cleanup;
+    const char *m_resfile;
+};
+
+/* The socket accepting connections, if any, which test cases must not
+ * inherit. */
+static int listen_fd = -1;
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+atf_error_t
+reply(const int fd, const char *fmt, ...)
+{
+    atf_error_t err;
+    atf_dynstr_t line;
+    const char *ptr;
+    size_t len;
+    va_list ap;
+
+    va_start(ap, fmt);
+    err = atf_dynstr_init_ap(&line, fmt, ap);
+    va_end(ap);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_dynstr_append_fmt(&line, "\n");
+    ptr = atf_dynstr_cstring(&line);
+    len = atf_dynstr_length(&line);
+    while (!atf_is_error(err) && len > 0) {
+        const ssize_t cnt = write(fd, ptr, len);
+        if (cnt == -1) {
+            if (errno != EINTR)
+                err = atf_libc_error(errno, "Cannot send zygote reply");
+        } else {
+            ptr += cnt;
+            len -= cnt;
+        }
+    }
+
+    atf_dynstr_fini(&line);
+    return err;
+}
+
+/** Splits a request into its fields.
+ *
+ * The line is modified in place and the returned command points into it.
+ * Returns NULL on success or a static string describing the syntax error.
+ */
+static
+const char *
+parse_run(char *args, struct command *cmd)
+{
+    char *saveptr, *tcarg, *part, *extra;
+
+    tcarg = strtok_r(args, " ", &saveptr);
+    if (tcarg == NULL)
+        return "Missing test case name";
+    cmd->m_resfile = strtok_r(NULL, " ", &saveptr);
+    extra = strtok_r(NULL, " ", &saveptr);
+    if (extra != NULL)
+        return "Too many arguments";
+
+    cmd->m_tcname = tcarg;
+    cmd->m_cleanup = false;
+    part = strchr(tcarg, ':');
+    if (part != NULL) {
+        *part++ = '\0';
+        if (strcmp(part, "cleanup") == 0)
+            cmd->m_cleanup = true;
+        else if (strcmp(part, "body") != 0)
+            return "Invalid test case part";
+    }
+
+    if (!cmd->m_cleanup && cmd->m_resfile == NULL)
+        return "Missing results file";
+
+    return NULL;
+}
+
+static
+atf_error_t
+run_command(const struct command *cmd, const int infd, const int outfd,
+            atf_runner_part_t part, void *data, int *status)
+{
+    pid_t pid;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid = fork();
+    if (pid == -1)
+        return atf_libc_error(errno, "Failed to fork");
+    else if (pid == 0) {
+        const int fd = open("/dev/null", O_RDONLY);
+        if (fd != -1 && fd != STDIN_FILENO) {
+            (void)dup2(fd, STDIN_FILENO);
+            close(fd);
+        }
+        if (infd != STDIN_FILENO)
+            close(infd);
+        if (outfd != infd)
+            close(outfd);
+        if (listen_fd != -1)
+            close(listen_fd);
+        signal(SIGPIPE, SIG_DFL);
+
+        part(data, cmd->m_tcname, cmd->m_cleanup, cmd->m_resfile);
+        fflush(stdout);
+        fflush(stderr);
+        exit(EXIT_SUCCESS);
+    }
+
+    while (waitpid(pid, status, 0) == -1) {
+        if (errno != EINTR)
+            return atf_libc_error(errno, "Failed to wait for test case");
+    }
+    return atf_no_error();
+}
+
+static
+atf_error_t
+handle_request(char *line, const int infd, const int outfd,
+               atf_zygote_has_tc_t has_tc, atf_runner_part_t part,
+               void *data)
+{
+    atf_error_t err;
+    struct command cmd;
+    const char *syntax_error;
+    int status;
+
+    if (strcmp(line, "run") != 0 && strncmp(line, "run ", 4) != 0)
+        return reply(outfd, "error Unknown request `%s'", line);
+
+    syntax_error = parse_run(line + 3, &cmd);
+    if (syntax_error != NULL)
+        return reply(outfd, "error %s", syntax_error);
+
+    if (!has_tc(data, cmd.m_tcname))
+        return reply(outfd, "error Unknown test case `%s'", cmd.m_tcname);
+
+    err = run_command(&cmd, infd, outfd, part, data, &status);
+    if (atf_is_error(err)) {
+        char buf[1024];
+        atf_error_format(err, buf, sizeof(buf));
+        atf_error_free(err);
+        return reply(outfd, "error %s", buf);
+    }
+
+    if (WIFEXITED(status))
+        return reply(outfd, "exit %d", WEXITSTATUS(status));
+    else {
+        INV(WIFSIGNALED(status));
+        return reply(outfd, "signal %d", WTERMSIG(status));
+    }
+}
+
+static
+atf_error_t
+serve_socket(const char *path, atf_zygote_has_tc_t has_tc,
+             atf_runner_part_t part, void *data)
+{
+    atf_error_t err;
+    struct sockaddr_un addr;
+    bool quit;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return atf_libc_error(ENAMETOOLONG, "Cannot use socket %s", path);
+
+#if defined(SOCK_CLOEXEC)
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+        return atf_libc_error(errno, "Cannot create socket");
+#else
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+        return atf_libc_error(errno, "Cannot create socket");
+    (void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        err = atf_libc_error(errno, "Cannot bind to %s", path);
+        goto out_fd;
+    }
+    if (listen(fd, 1) == -1) {
+        err = atf_libc_error(errno, "Cannot listen on %s", path);
+        goto out_unlink;
+    }
+
+    listen_fd = fd;
+    err = atf_no_error();
+    quit = false;
+    while (!atf_is_error(err) && !quit) {
+        const int conn = accept(fd, NULL, NULL);
+        if (conn == -1) {
+            if (errno != EINTR)
+                err = atf_libc_error(errno, "Cannot accept connection");
+            continue;
+        }
+
+        err = atf_zygote_serve_fds(conn, conn, has_tc, part, data, &quit);
+        close(conn);
+    }
+    listen_fd = -1;
+
+out_unlink:
+    unlink(path);
+out_fd:
+    close(fd);
+    return err;
+}
+
+/* ---------------------------------------------------------------------
+ * Free functions.
+ * --------------------------------------------------------------------- */
+
+/** Processes requests from infd until EOF or a "quit" request.
+ *
+ * Replies are written to outfd, which may be the same descriptor as infd.
+ * quit is set if the session ended due to an explicit request.
+ */
+atf_error_t
+atf_zygote_serve_fds(const int infd, const int outfd,
+                     atf_zygote_has_tc_t has_tc, atf_runner_part_t part,
+                     void *data, bool *quit)
+{
+    atf_error_t err;
+    FILE *in;
+    char *line;
+    size_t linesize;
+    ssize_t len;
+    int fd;
+
+    fd = dup(infd);
+    if (fd == -1)
+        return atf_libc_error(errno, "Cannot duplicate zygote input");
+    in = fdopen(fd, "r");
+    if (in == NULL) {
+        close(fd);
+        return atf_libc_error(errno, "Cannot open zygote input");
+    }
+
+    err = atf_no_error();
+    *quit = false;
+    line = NULL;
+    linesize = 0;
+    while (!atf_is_error(err) && (len = getline(&line, &linesize, in)) != -1) {
+        if (len > 0 && line[len - 1] == '\n')
+            line[--len] = '\0';
+
+        if (len == 0)
+            continue;
+        else if (strcmp(line, "quit") == 0) {
+            *quit = true;
+            break;
+        } else
+            err = handle_request(line, fd, outfd, has_tc, part, data);
+    }
+    free(line);
+    fclose(in);
+
+    return err;
+}
+
+/** Serves requests on the given endpoint until told to quit.
+ *
+ * If the endpoint is "-", requests are read from stdin and replies written
+ * to stdout; the output of the test cases is sent to stderr in that case
+ * so that it does not interfere with the replies.  Otherwise, the endpoint
+ * is the path to a Unix socket that is created to accept connections, which
+ * are served one at a time.
+ */
+atf_error_t
+atf_zygote_serve(const char *endpoint, atf_zygote_has_tc_t has_tc,
+                 atf_runner_part_t part, void *data)
+{
+    atf_error_t err;
+    void (*old_sigpipe)(int);
+
+    old_sigpipe = signal(SIGPIPE, SIG_IGN);
+
+    if (strcmp(endpoint, "-") == 0) {
+        bool quit;
+        int outfd;
+
+        fflush(stdout);
+        outfd = dup(STDOUT_FILENO);
+        if (outfd == -1) {
+            err = atf_libc_error(errno, "Cannot duplicate stdout");
+            goto out;
+        }
+        if (dup2(STDERR_FILENO, STDOUT_FILENO) == -1) {
+            err = atf_libc_error(errno, "Cannot redirect stdout");
+            close(outfd);
+            goto out;
+        }
+
+        err = atf_zygote_serve_fds(STDIN_FILENO, outfd, has_tc, part, data,
+                                   &quit);
+        close(outfd);
+    } else
+        err = serve_socket(endpoint, has_tc, part, data);
+
+out:
+    signal(SIGPIPE, old_sigpipe);
+    return err;
+}
@@ -0,0 +1,257 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+#include "atf-c/detail/zygote.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atf-c.h>
+
+#include "atf-c/detail/test_helpers.h"
+#include "atf-c/utils.h"
+
+/* ---------------------------------------------------------------------
+ * Auxiliary functions.
+ * --------------------------------------------------------------------- */
+
+static
+bool
+fake_has_tc(void *data ATF_DEFS_ATTRIBUTE_UNUSED, const char *ident)
+{
+    return strcmp(ident, "pass") == 0 || strcmp(ident, "fail") == 0 ||
+           strcmp(ident, "crash") == 0 || strcmp(ident, "counter") == 0 ||
+           strcmp(ident, "sockets") == 0;
+}
+
+/** Fake test case implementation whose behavior depends on its name. */
+static
+void
+fake_part(void *data ATF_DEFS_ATTRIBUTE_UNUSED, const char *ident,
+          const bool cleanup, const char *resfile)
+{
+    static int counter = 0;
+
+    if (cleanup) {
+        atf_utils_create_file("cleanup_done", "%s\n", ident);
+        return;
+    }
+
+    if (strcmp(ident, "pass") == 0) {
+        atf_utils_create_file(resfile, "passed\n");
+    } else if (strcmp(ident, "fail") == 0) {
+        atf_utils_create_file(resfile, "failed: Some reason\n");
+        exit(EXIT_FAILURE);
+    } else if (strcmp(ident, "crash") == 0) {
+        abort();
+    } else if (strcmp(ident, "counter") == 0) {
+        /* Modifications must not leak from one run to the next. */
+        counter++;
+        atf_utils_create_file(resfile, "passed: %d\n", counter);
+    } else if (strcmp(ident, "sockets") == 0) {
+        /* Neither the connection nor the listening socket may leak. */
+        struct stat sb;
+        int fd, sockets = 0;
+
+        for (fd = 0; fd < 256; fd++)
+            if (fstat(fd, &sb) != -1 && S_ISSOCK(sb.st_mode))
+                sockets++;
+        atf_utils_create_file(resfile, "passed: %d\n", sockets);
+    }
+}
+
+static
+bool
+serve_file(const char *requests)
+{
+    bool quit;
+    int infd, outfd;
+
+    atf_utils_create_file("requests", "%s", requests);
+    infd = open("requests", O_RDONLY);
+    ATF_REQUIRE(infd != -1);
+    outfd = open("replies", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ATF_REQUIRE(outfd != -1);
+    RE(atf_zygote_serve_fds(infd, outfd, fake_has_tc, fake_part, NULL,
+                            &quit));
+    close(outfd);
+    close(infd);
+
+    atf_utils_cat_file("replies", "replies: ");
+    return quit;
+}
+
+/* ---------------------------------------------------------------------
+ * Test cases for the free functions.
+ * --------------------------------------------------------------------- */
+
+ATF_TC_WITHOUT_HEAD(serve_fds_results);
+ATF_TC_BODY(serve_fds_results, tc)
+{
+    ATF_REQUIRE(!serve_file("run pass r1\nrun fail:body r2\nrun crash r3\n"));
+
+    ATF_REQUIRE(atf_utils_compare_file("replies", "exit 0\nexit 1\n"
+                                       "signal 6\n"));
+    ATF_REQUIRE(atf_utils_compare_file("r1", "passed\n"));
+    ATF_REQUIRE(atf_utils_compare_file("r2", "failed: Some reason\n"));
+    ATF_REQUIRE(!atf_utils_file_exists("r3"));
+}
+
+ATF_TC_WITHOUT_HEAD(serve_fds_cleanup);
+ATF_TC_BODY(serve_fds_cleanup, tc)
+{
+    ATF_REQUIRE(!serve_file("run pass:cleanup\n"));
+
+    ATF_REQUIRE(atf_utils_compare_file("replies", "exit 0\n"));
+    ATF_REQUIRE(atf_utils_compare_file("cleanup_done", "pass\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(serve_fds_isolation);
+ATF_TC_BODY(serve_fds_isolation, tc)
+{
+    ATF_REQUIRE(!serve_file("run counter r1\nrun counter r2\n"));
+
+    ATF_REQUIRE(atf_utils_compare_file("replies", "exit 0\nexit 0\n"));
+    ATF_REQUIRE(atf_utils_compare_file("r1", "passed: 1\n"));
+    ATF_REQUIRE(atf_utils_compare_file("r2", "passed: 1\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(serve_fds_errors);
+ATF_TC_BODY(serve_fds_errors, tc)
+{
+    ATF_REQUIRE(!serve_file("\nfoo\nrun\nrun pass\nrun pass:foo r\n"
+                            "run pass r extra\nrun unknown r\nrun pass r\n"));
+
+    ATF_REQUIRE(atf_utils_compare_file("replies",
+        "error Unknown request `foo'\n"
+        "error Missing test case name\n"
+        "error Missing results file\n"
+        "error Invalid test case part\n"
+        "error Too many arguments\n"
+        "error Unknown test case `unknown'\n"
+        "exit 0\n"));
+}
+
+ATF_TC_WITHOUT_HEAD(serve_fds_quit);
+ATF_TC_BODY(serve_fds_quit, tc)
+{
+    ATF_REQUIRE(serve_file("run pass r1\nquit\nrun pass r2\n"));
+
+    ATF_REQUIRE(atf_utils_compare_file("replies", "exit 0\n"));
+    ATF_REQUIRE(atf_utils_file_exists("r1"));
+    ATF_REQUIRE(!atf_utils_file_exists("r2"));
+}
+
+ATF_TC(serve_socket);
+ATF_TC_HEAD(serve_socket, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Checks that requests are served over "
+                      "consecutive connections to a Unix socket");
+    atf_tc_set_md_var(tc, "timeout", "60");
+}
+ATF_TC_BODY(serve_socket, tc)
+{
+    const char *const sessions[] = { "run pass r1\nrun sockets r3\n",
+                                     "run fail r2\nquit\n", NULL };
+    const char *const *session;
+    struct sockaddr_un addr;
+    pid_t pid;
+    int status;
+
+    pid = atf_utils_fork();
+    if (pid == 0) {
+        atf_error_t err = atf_zygote_serve("socket", fake_has_tc, fake_part,
+                                           NULL);
+        exit(atf_is_error(err) ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, "socket");
+    for (session = sessions; *session != NULL; session++) {
+        char buf[64];
+        ssize_t cnt;
+        size_t len;
+        int fd, tries;
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        ATF_REQUIRE(fd != -1);
+        for (tries = 0; connect(fd, (struct sockaddr *)&addr,
+                                sizeof(addr)) == -1; tries++) {
+            ATF_REQUIRE_MSG(tries < 300, "Cannot connect: %s",
+                            strerror(errno));
+            usleep(100000);
+        }
+
+        ATF_REQUIRE(write(fd, *session, strlen(*session)) ==
+                    (ssize_t)strlen(*session));
+        shutdown(fd, SHUT_WR);
+        len = 0;
+        while ((cnt = read(fd, buf + len, sizeof(buf) - 1 - len)) > 0)
+            len += cnt;
+        buf[len] = '\0';
+        close(fd);
+
+        if (session == sessions)
+            ATF_REQUIRE_STREQ("exit 0\nexit 0\n", buf);
+        else
+            ATF_REQUIRE_STREQ("exit 1\n", buf);
+    }
+
+    ATF_REQUIRE(waitpid(pid, &status, 0) != -1);
+    ATF_REQUIRE(WIFEXITED(status));
+    ATF_REQUIRE_EQ(EXIT_SUCCESS, WEXITSTATUS(status));
+    ATF_REQUIRE(atf_utils_file_exists("r1"));
+    ATF_REQUIRE(atf_utils_file_exists("r2"));
+    ATF_REQUIRE(atf_utils_compare_file("r3", "passed: 0\n"));
+    ATF_REQUIRE(!atf_utils_file_exists("socket"));
+}
+
+/* ---------------------------------------------------------------------
+ * Main.
+ * --------------------------------------------------------------------- */
+
+ATF_TP_ADD_TCS(tp)
+{
+    ATF_TP_ADD_TC(tp, serve_fds_results);
+    ATF_TP_ADD_TC(tp, serve_fds_cleanup);
+    ATF_TP_ADD_TC(tp, serve_fds_isolation);
+    ATF_TP_ADD_TC(tp, serve_fds_errors);
+    ATF_TP_ADD_TC(tp, serve_fds_quit);
+    ATF_TP_ADD_TC(tp, serve_socket);
+
+    return atf_no_error();
+}
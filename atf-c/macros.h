@@ -113,42 +113,34 @@
 #define ATF_TP_ADD_TC(tp, tc) \
     do { \
         atf_error_t atfu_err; \
-        char **atfu_config = atf_tp_get_config(tp); \
-        if (atfu_config == NULL) \
-            return atf_no_memory_error(); \
-        atfu_err = atf_tc_init_pack(&atfu_ ## tc ## _tc, \
-                                    &atfu_ ## tc ## _tc_pack, \
-                                    (const char *const *)atfu_config); \
-        atf_utils_free_charpp(atfu_config); \
-        if (atf_is_error(atfu_err)) \
-            return atfu_err; \
-        atfu_err = atf_tp_add_tc(tp, &atfu_ ## tc ## _tc); \
+        atfu_err = atf_tp_add_tc_pack(tp, &atfu_ ## tc ## _tc, \
+                                      &atfu_ ## tc ## _tc_pack); \
         if (atf_is_error(atfu_err)) \
             return atfu_err; \
     } while (0)
 
 #define ATF_REQUIRE_MSG(expression, fmt, ...) \
     do { \
-        if (!(expression)) \
+        if (ATF_DEFS_UNLIKELY(!(expression))) \
             atf_tc_fail_requirement(__FILE__, __LINE__, fmt, ##__VA_ARGS__); \
     } while(0)
 
 #define ATF_CHECK_MSG(expression, fmt, ...) \
     do { \
-        if (!(expression)) \
+        if (ATF_DEFS_UNLIKELY(!(expression))) \
             atf_tc_fail_check(__FILE__, __LINE__, fmt, ##__VA_ARGS__); \
     } while(0)
 
 #define ATF_REQUIRE(expression) \
     do { \
-        if (!(expression)) \
+        if (ATF_DEFS_UNLIKELY(!(expression))) \
             atf_tc_fail_requirement(__FILE__, __LINE__, "%s", \
                                     #expression " not met"); \
     } while(0)
 
 #define ATF_CHECK(expression) \
     do { \
-        if (!(expression)) \
+        if (ATF_DEFS_UNLIKELY(!(expression))) \
             atf_tc_fail_check(__FILE__, __LINE__, "%s", \
                               #expression " not met"); \
     } while(0)
@@ -541,6 +541,107 @@ ATF_TC_BODY(check_match, tc)
     do_check_eq_tests(tests);
 }
 
+/* ---------------------------------------------------------------------
+ * Test cases for repeated failures of the ATF_CHECK_* macros.
+ * --------------------------------------------------------------------- */
+
+H_DEF(check_repeated, {
+    int i;
+    for (i = 0; i < 1000; i++)
+        ATF_CHECK_EQ(i, -1);
+    ATF_CHECK_MSG(false, "last check");
+})
+
+static
+size_t
+count_matching_lines(const char *file, const char *regex)
+{
+    char *line = NULL;
+    size_t size = 0, count = 0;
+    FILE *f;
+
+    ATF_REQUIRE((f = fopen(file, "r")) != NULL);
+    while (getline(&line, &size, f) != -1) {
+        line[strcspn(line, "\n")] = '\0';
+        if (atf_utils_grep_string("%s", line, regex))
+            count++;
+    }
+    free(line);
+    fclose(f);
+    return count;
+}
+
+ATF_TC(check_repeated);
+ATF_TC_HEAD(check_repeated, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Tests that repeated failures of a "
+                      "check are counted but only printed a few times");
+}
+ATF_TC_BODY(check_repeated, tc)
+{
+    init_and_run_h_tc("h_check_repeated",
+        ATF_TC_HEAD_NAME(h_check_repeated), ATF_TC_BODY_NAME(h_check_repeated));
+
+    ATF_REQUIRE(exists("after"));
+    ATF_REQUIRE(atf_utils_grep_file("^failed: 1001 checks failed", "result"));
+    ATF_CHECK_EQ(11, count_matching_lines("error", "^\\*\\*\\* Check failed"));
+    ATF_CHECK(atf_utils_grep_file("Check failed: .*macros_test.c:[0-9]+: "
+        "last check$", "error"));
+    ATF_CHECK(atf_utils_grep_file("^\\*\\*\\* 990 more check failures at "
+        ".*macros_test.c:[0-9]+ were not shown$", "error"));
+    ATF_CHECK_EQ(1, count_matching_lines("error", "more check failures"));
+}
+
+H_DEF(check_repeated_nonfatal, {
+    int i;
+    for (i = 0; i < 12; i++)
+        atf_tc_fail_nonfatal("failure %d", i);
+})
+
+H_DEF(check_repeated_exit, {
+    int i;
+    for (i = 0; i < 12; i++)
+        ATF_CHECK(false);
+    atf_tc_expect_exit(EXIT_SUCCESS, "Exits on its own");
+    exit(EXIT_SUCCESS);
+})
+
+ATF_TC(check_repeated_exit);
+ATF_TC_HEAD(check_repeated_exit, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Tests that repeated failures of a "
+                      "check are summarized when the body calls exit");
+}
+ATF_TC_BODY(check_repeated_exit, tc)
+{
+    init_and_run_h_tc("h_check_repeated_exit",
+        ATF_TC_HEAD_NAME(h_check_repeated_exit),
+        ATF_TC_BODY_NAME(h_check_repeated_exit));
+
+    ATF_CHECK_EQ(10, count_matching_lines("error", "^\\*\\*\\* Check failed"));
+    ATF_CHECK(atf_utils_grep_file("^\\*\\*\\* 2 more check failures at "
+        ".*macros_test.c:[0-9]+ were not shown$", "error"));
+}
+
+ATF_TC(check_repeated_nonfatal);
+ATF_TC_HEAD(check_repeated_nonfatal, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Tests that failures raised without a "
+                      "source location are never rate-limited");
+}
+ATF_TC_BODY(check_repeated_nonfatal, tc)
+{
+    init_and_run_h_tc("h_check_repeated_nonfatal",
+        ATF_TC_HEAD_NAME(h_check_repeated_nonfatal),
+        ATF_TC_BODY_NAME(h_check_repeated_nonfatal));
+
+    ATF_REQUIRE(exists("after"));
+    ATF_REQUIRE(atf_utils_grep_file("^failed: 12 checks failed", "result"));
+    ATF_CHECK_EQ(12, count_matching_lines("error", "^\\*\\*\\* Check failed"));
+    ATF_CHECK(atf_utils_grep_file("failure 11$", "error"));
+    ATF_CHECK_EQ(0, count_matching_lines("error", "more check failures"));
+}
+
 /* ---------------------------------------------------------------------
  * Test cases for the ATF_REQUIRE and ATF_REQUIRE_MSG macros.
  * --------------------------------------------------------------------- */
@@ -876,6 +977,9 @@ ATF_TP_ADD_TCS(tp)
     ATF_TP_ADD_TC(tp, check_streq);
     ATF_TP_ADD_TC(tp, check_errno);
     ATF_TP_ADD_TC(tp, check_match);
+    ATF_TP_ADD_TC(tp, check_repeated);
+    ATF_TP_ADD_TC(tp, check_repeated_nonfatal);
+    ATF_TP_ADD_TC(tp, check_repeated_exit);
 
     ATF_TP_ADD_TC(tp, require);
     ATF_TP_ADD_TC(tp, require_eq);
@@ -31,6 +31,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -40,17 +41,32 @@
 #include <unistd.h>
 
 #include "atf-c/defs.h"
+#include "atf-c/detail/arena.h"
+#include "atf-c/detail/dynstr.h"
 #include "atf-c/detail/env.h"
 #include "atf-c/detail/fs.h"
 #include "atf-c/detail/map.h"
+#include "atf-c/detail/rusage.h"
 #include "atf-c/detail/sanity.h"
+#include "atf-c/detail/tc.h"
 #include "atf-c/detail/text.h"
+#include "atf-c/detail/timing.h"
+#include "atf-c/detail/trace.h"
+#include "atf-c/detail/vars.h"
 #include "atf-c/error.h"
 
 /* ---------------------------------------------------------------------
  * Auxiliary functions.
  * --------------------------------------------------------------------- */
 
+/*
+ * Number of messages printed for the failed checks of a single source
+ * location.  Further failures at that location are only counted and
+ * summarized when the test case finishes, so that a check failing inside a
+ * long loop does not flood the output.
+ */
+#define CHECK_MESSAGES_PER_SITE 10
+
 enum expect_type {
     EXPECT_PASS,
     EXPECT_FAIL,
@@ -60,11 +76,23 @@ enum expect_type {
     EXPECT_TIMEOUT,
 };
 
+struct check_site {
+    char *file;
+    size_t line;
+    size_t count;
+};
+
+/* Process that registered report_current_check_sites with atexit(3), or 0
+ * if no check failure has been suppressed yet. */
+static pid_t Check_sites_pid = 0;
+
 struct context {
     const atf_tc_t *tc;
     const char *resfile;
     int resfilefd;
     size_t fail_count;
+    atf_timing_t body_timing;
+    atf_trace_span_t body_span;
 
     enum expect_type expect;
     atf_dynstr_t expect_reason;
@@ -72,16 +100,24 @@ struct context {
     size_t expect_fail_count;
     int expect_exitcode;
     int expect_signo;
+
+    struct check_site *check_sites;
+    size_t check_sites_count;
+    size_t check_sites_size;
+    size_t check_sites_last;
 };
 
+static int resfile_fd(const char *);
 static void context_init(struct context *, const atf_tc_t *, const char *);
 static void context_set_resfile(struct context *, const char *);
 static void context_close_resfile(struct context *);
 static void check_fatal_error(atf_error_t);
 static void report_fatal_error(const char *, ...)
     ATF_DEFS_ATTRIBUTE_NORETURN;
+static bool extended_results(void);
+static atf_error_t format_extended(const struct context *, atf_dynstr_t *);
 static atf_error_t write_resfile(const int, const char *, const int,
-                                 const atf_dynstr_t *);
+                                 const atf_dynstr_t *, const atf_dynstr_t *);
 static void create_resfile(struct context *, const char *, const int,
                            atf_dynstr_t *);
 static void error_in_expect(struct context *, const char *, ...)
@@ -91,6 +127,11 @@ static void expected_failure(struct context *, atf_dynstr_t *)
     ATF_DEFS_ATTRIBUTE_NORETURN;
 static void fail_requirement(struct context *, atf_dynstr_t *)
     ATF_DEFS_ATTRIBUTE_NORETURN;
+static struct check_site *find_check_site(struct context *, const char *,
+                                          const size_t);
+static bool count_check(struct context *, const char *, const size_t);
+static void report_check_sites(struct context *);
+static void report_current_check_sites(void);
 static void fail_check(struct context *, atf_dynstr_t *);
 static void pass(struct context *)
     ATF_DEFS_ATTRIBUTE_NORETURN;
@@ -100,15 +141,45 @@ static void format_reason_ap(atf_dynstr_t *, const char *, const size_t,
                              const char *, va_list);
 static void format_reason_fmt(atf_dynstr_t *, const char *, const size_t,
                               const char *, ...);
-static void errno_test(struct context *, const char *, const size_t,
-                       const int, const char *, const bool,
-                       void (*)(struct context *, atf_dynstr_t *));
+static bool errno_test(const char *, const size_t, const int, const char *,
+                       const bool, atf_dynstr_t *);
 static atf_error_t check_prog_in_dir(const char *, void *);
 static atf_error_t check_prog(struct context *, const char *);
 
 /* No prototype in header for this one, it's a little sketchy (internal). */
 void atf_tc_set_resultsfile(const char *);
 
+/** Returns the descriptor that a results file path refers to, if any.
+ *
+ * /dev/stdout, /dev/stderr and /dev/fd/N are used through the descriptors
+ * that the process already has instead of being opened.  This lets a runner
+ * hand an inherited descriptor to a test case as its results file.  Returns
+ * -1 for any other path.
+ */
+static int
+resfile_fd(const char *resfile)
+{
+    const char *digits;
+    char *end;
+    long fd;
+
+    if (strcmp(resfile, "/dev/stdout") == 0)
+        return STDOUT_FILENO;
+    else if (strcmp(resfile, "/dev/stderr") == 0)
+        return STDERR_FILENO;
+    else if (strncmp(resfile, "/dev/fd/", 8) != 0)
+        return -1;
+
+    digits = resfile + 8;
+    if (*digits < '0' || *digits > '9')
+        return -1;
+    errno = 0;
+    fd = strtol(digits, &end, 10);
+    if (errno != 0 || *end != '\0' || fd > INT_MAX)
+        return -1;
+    return (int)fd;
+}
+
 static void
 context_init(struct context *ctx, const atf_tc_t *tc, const char *resfile)
 {
@@ -117,26 +188,37 @@ context_init(struct context *ctx, const atf_tc_t *tc, const char *resfile)
     ctx->resfilefd = -1;
     context_set_resfile(ctx, resfile);
     ctx->fail_count = 0;
+    atf_timing_init(&ctx->body_timing);
+    ctx->body_span.m_start = -1;
     ctx->expect = EXPECT_PASS;
     check_fatal_error(atf_dynstr_init(&ctx->expect_reason));
     ctx->expect_previous_fail_count = 0;
     ctx->expect_fail_count = 0;
     ctx->expect_exitcode = 0;
     ctx->expect_signo = 0;
+    ctx->check_sites = NULL;
+    ctx->check_sites_count = 0;
+    ctx->check_sites_size = 0;
+    ctx->check_sites_last = 0;
 }
 
 static void
 context_set_resfile(struct context *ctx, const char *resfile)
 {
     atf_error_t err;
+    const int fd = resfile_fd(resfile);
 
     context_close_resfile(ctx);
     ctx->resfile = resfile;
-    if (strcmp(resfile, "/dev/stdout") == 0)
-        ctx->resfilefd = STDOUT_FILENO;
-    else if (strcmp(resfile, "/dev/stderr") == 0)
-        ctx->resfilefd = STDERR_FILENO;
-    else
+    if (fd == STDOUT_FILENO || fd == STDERR_FILENO)
+        ctx->resfilefd = fd;
+    else if (fd != -1) {
+        /* Keep the caller's descriptor open when we close ours, but discard
+         * its contents as opening the file would. */
+        ctx->resfilefd = fcntl(fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+        if (ctx->resfilefd != -1 && ftruncate(ctx->resfilefd, 0) != -1)
+            (void)lseek(ctx->resfilefd, 0, SEEK_SET);
+    } else
         ctx->resfilefd = open(resfile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
             S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
     if (ctx->resfilefd == -1) {
@@ -186,21 +268,36 @@ report_fatal_error(const char *msg, ...)
     abort();
 }
 
+/** Returns whether results files use the extended format.
+ *
+ * The extended format follows the result line with "key: value" lines that
+ * describe how the test case ran, such as the timing of its phases and the
+ * resources it used.  It is only used on request because runtime engines
+ * expect a single line.
+ */
+static bool
+extended_results(void)
+{
+    return atf_env_has("ATF_RESULTS_FORMAT") &&
+        strcmp(atf_env_get("ATF_RESULTS_FORMAT"), "extended") == 0;
+}
+
 /** Writes to a results file.
  *
- * The results file is supposed to be already open.
+ * The results file is supposed to be already open.  extra, if not NULL,
+ * holds the additional lines of the extended results format.
  *
  * This function returns an error code instead of exiting in case of error
  * because the caller needs to clean up the reason object before terminating.
  */
 static atf_error_t
 write_resfile(const int fd, const char *result, const int arg,
-              const atf_dynstr_t *reason)
+              const atf_dynstr_t *reason, const atf_dynstr_t *extra)
 {
     static char NL[] = "\n", CS[] = ": ";
     char buf[64];
     const char *r;
-    struct iovec iov[5];
+    struct iovec iov[6];
     ssize_t ret;
     int count = 0;
 
@@ -223,11 +320,16 @@ write_resfile(const int fd, const char *result, const int arg,
         iov[count].iov_base = UNCONST(r);
         iov[count++].iov_len = strlen(r);
     }
-#undef UNCONST
 
     iov[count].iov_base = NL;
     iov[count++].iov_len = sizeof(NL) - 1;
 
+    if (extra != NULL) {
+        iov[count].iov_base = UNCONST(atf_dynstr_cstring(extra));
+        iov[count++].iov_len = atf_dynstr_length(extra);
+    }
+#undef UNCONST
+
     while ((ret = writev(fd, iov, count)) == -1 && errno == EINTR)
         continue; /* Retry. */
     if (ret != -1)
@@ -250,6 +352,27 @@ create_resfile(struct context *ctx, const char *result, const int arg,
                atf_dynstr_t *reason)
 {
     atf_error_t err;
+    atf_dynstr_t extra;
+    bool has_extra = false;
+
+    /* The body is over once it has a result. */
+    atf_trace_end(&ctx->body_span, "tc", "body", atf_tc_get_ident(ctx->tc));
+    ctx->body_span.m_start = -1;
+
+    if (extended_results()) {
+        err = atf_dynstr_init(&extra);
+        if (!atf_is_error(err)) {
+            has_extra = true;
+            err = format_extended(ctx, &extra);
+        }
+        if (atf_is_error(err)) {
+            if (reason != NULL)
+                atf_dynstr_fini(reason);
+            if (has_extra)
+                atf_dynstr_fini(&extra);
+            check_fatal_error(err);
+        }
+    }
 
     /*
      * We'll attempt to truncate the results file, but only if it's not pointed
@@ -262,10 +385,13 @@ create_resfile(struct context *ctx, const char *result, const int arg,
     if (ctx->resfilefd != STDOUT_FILENO && ctx->resfilefd != STDERR_FILENO &&
         ftruncate(ctx->resfilefd, 0) != -1)
         lseek(ctx->resfilefd, 0, SEEK_SET);
-    err = write_resfile(ctx->resfilefd, result, arg, reason);
+    err = write_resfile(ctx->resfilefd, result, arg, reason,
+                        has_extra ? &extra : NULL);
 
     if (reason != NULL)
         atf_dynstr_fini(reason);
+    if (has_extra)
+        atf_dynstr_fini(&extra);
 
     check_fatal_error(err);
 }
@@ -319,6 +445,7 @@ validate_expect(struct context *ctx)
 static void
 expected_failure(struct context *ctx, atf_dynstr_t *reason)
 {
+    report_check_sites(ctx);
     check_fatal_error(atf_dynstr_prepend_fmt(reason, "%s: ",
         atf_dynstr_cstring(&ctx->expect_reason)));
     create_resfile(ctx, "expected_failure", -1, reason);
@@ -329,6 +456,7 @@ expected_failure(struct context *ctx, atf_dynstr_t *reason)
 static void
 fail_requirement(struct context *ctx, atf_dynstr_t *reason)
 {
+    report_check_sites(ctx);
     if (ctx->expect == EXPECT_FAIL) {
         expected_failure(ctx, reason);
     } else if (ctx->expect == EXPECT_PASS) {
@@ -342,6 +470,117 @@ fail_requirement(struct context *ctx, atf_dynstr_t *reason)
     UNREACHABLE;
 }
 
+static struct check_site *
+find_check_site(struct context *ctx, const char *file, const size_t line)
+{
+    struct check_site *site;
+    size_t i;
+
+    PRE(file != NULL);
+
+#define SAME_SITE(s) ((s)->line == line && strcmp((s)->file, file) == 0)
+
+    /* Failures tend to repeat at the same site, e.g. inside a loop. */
+    if (ctx->check_sites_count > 0 &&
+        SAME_SITE(&ctx->check_sites[ctx->check_sites_last]))
+        return &ctx->check_sites[ctx->check_sites_last];
+
+    for (i = 0; i < ctx->check_sites_count; i++) {
+        if (SAME_SITE(&ctx->check_sites[i])) {
+            ctx->check_sites_last = i;
+            return &ctx->check_sites[i];
+        }
+    }
+#undef SAME_SITE
+
+    if (ctx->check_sites_count == ctx->check_sites_size) {
+        const size_t size = ctx->check_sites_size == 0 ?
+            8 : ctx->check_sites_size * 2;
+        struct check_site *sites;
+
+        sites = realloc(ctx->check_sites, size * sizeof(*sites));
+        if (sites == NULL)
+            check_fatal_error(atf_no_memory_error());
+        ctx->check_sites = sites;
+        ctx->check_sites_size = size;
+    }
+
+    site = &ctx->check_sites[ctx->check_sites_count];
+    if ((site->file = strdup(file)) == NULL)
+        check_fatal_error(atf_no_memory_error());
+    site->line = line;
+    site->count = 0;
+    ctx->check_sites_last = ctx->check_sites_count++;
+    return site;
+}
+
+/** Records a failed check raised at the given source location.
+ *
+ * Returns true if the failure has to be reported through fail_check, or
+ * false if the location already printed as many messages as allowed, in
+ * which case the caller can skip formatting the message altogether.
+ * Failures without a location (file is NULL) are unrelated to each other,
+ * so they are always reported.
+ */
+static bool
+count_check(struct context *ctx, const char *file, const size_t line)
+{
+    struct check_site *site;
+
+    if (ctx->expect != EXPECT_PASS && ctx->expect != EXPECT_FAIL)
+        return true;  /* Let fail_check raise the error. */
+
+    if (ctx->expect == EXPECT_FAIL)
+        ctx->expect_fail_count++;
+    else
+        ctx->fail_count++;
+
+    if (file == NULL)
+        return true;
+
+    site = find_check_site(ctx, file, line);
+    site->count++;
+
+    /* The body may also end through exit(3), e.g. under
+     * atf_tc_expect_exit, without going through report_check_sites. */
+    if (site->count > CHECK_MESSAGES_PER_SITE &&
+        Check_sites_pid != getpid()) {
+        if (Check_sites_pid != 0 || atexit(report_current_check_sites) == 0)
+            Check_sites_pid = getpid();
+    }
+    return site->count <= CHECK_MESSAGES_PER_SITE;
+}
+
+/** Prints how many failed checks were not reported and releases the sites.
+ *
+ * Called right before the test case terminates, and again at exit in case
+ * the body terminated on its own; the second call finds no sites left.
+ */
+static void
+report_check_sites(struct context *ctx)
+{
+    size_t i;
+
+    for (i = 0; i < ctx->check_sites_count; i++) {
+        const struct check_site *site = &ctx->check_sites[i];
+
+        if (site->count > CHECK_MESSAGES_PER_SITE) {
+            const size_t hidden = site->count - CHECK_MESSAGES_PER_SITE;
+
+            fprintf(stderr, "*** %zd more check failures at %s:%zd were "
+                "not shown\n", hidden, site->file, site->line);
+        }
+        free(site->file);
+    }
+
+    free(ctx->check_sites);
+    ctx->check_sites = NULL;
+    ctx->check_sites_count = 0;
+    ctx->check_sites_size = 0;
+    ctx->check_sites_last = 0;
+}
+
+/** Prints a failed check previously recorded with count_check. */
 static void
 fail_check(struct context *ctx, atf_dynstr_t *reason)
 {
@@ -349,10 +588,8 @@ fail_check(struct context *ctx, atf_dynstr_t *reason)
         fprintf(stderr, "*** Expected check failure: %s: %s\n",
             atf_dynstr_cstring(&ctx->expect_reason),
             atf_dynstr_cstring(reason));
-        ctx->expect_fail_count++;
     } else if (ctx->expect == EXPECT_PASS) {
         fprintf(stderr, "*** Check failed: %s\n", atf_dynstr_cstring(reason));
-        ctx->fail_count++;
     } else {
         error_in_expect(ctx, "Test case raised a failure but was not "
             "expecting one; reason was %s", atf_dynstr_cstring(reason));
@@ -364,6 +601,7 @@ fail_check(struct context *ctx, atf_dynstr_t *reason)
 static void
 pass(struct context *ctx)
 {
+    report_check_sites(ctx);
     if (ctx->expect == EXPECT_FAIL) {
         error_in_expect(ctx, "Test case was expecting a failure but got "
             "a pass instead");
@@ -381,6 +619,7 @@ pass(struct context *ctx)
 static void
 skip(struct context *ctx, atf_dynstr_t *reason)
 {
+    report_check_sites(ctx);
     create_resfile(ctx, "skipped", -1, reason);
     context_close_resfile(ctx);
     exit(EXIT_SUCCESS);
@@ -435,29 +674,28 @@ format_reason_fmt(atf_dynstr_t *out_reason,
     va_end(ap);
 }
 
-static void
-errno_test(struct context *ctx, const char *file, const size_t line,
-           const int exp_errno, const char *expr_str,
-           const bool expr_result,
-           void (*fail_func)(struct context *, atf_dynstr_t *))
+/** Checks the outcome of an expression and the errno value it left.
+ *
+ * Returns true and initializes out_reason if the check failed.
+ */
+static bool
+errno_test(const char *file, const size_t line, const int exp_errno,
+           const char *expr_str, const bool expr_result,
+           atf_dynstr_t *out_reason)
 {
     const int actual_errno = errno;
 
     if (expr_result) {
-        if (exp_errno != actual_errno) {
-            atf_dynstr_t reason;
+        if (exp_errno == actual_errno)
+            return false;
 
-            format_reason_fmt(&reason, file, line, "Expected errno %d, got %d, "
-                "in %s", exp_errno, actual_errno, expr_str);
-            fail_func(ctx, &reason);
-        }
+        format_reason_fmt(out_reason, file, line, "Expected errno %d, got %d, "
+            "in %s", exp_errno, actual_errno, expr_str);
     } else {
-        atf_dynstr_t reason;
-
-        format_reason_fmt(&reason, file, line, "Expected true value in %s",
+        format_reason_fmt(out_reason, file, line, "Expected true value in %s",
             expr_str);
-        fail_func(ctx, &reason);
     }
+    return true;
 }
 
 struct prog_found_pair {
@@ -567,15 +805,103 @@ out:
 
 struct atf_tc_impl {
     const char *m_ident;
+    atf_tc_t *m_self;
 
     atf_map_t m_vars;
-    atf_map_t m_config;
+    atf_vars_t *m_config;
 
     atf_tc_head_t m_head;
     atf_tc_body_t m_body;
     atf_tc_cleanup_t m_cleanup;
+
+    atf_timing_t m_head_timing;
+
+    /* Owner of this structure and of the metadata, or NULL if they come
+     * from the heap. */
+    atf_arena_t *m_arena;
 };
 
+/*
+ * The initialization of the process that runs a test case, which lasts
+ * from the start of the test program, or from the fork of the child that
+ * runs the test case, until the test case starts.
+ */
+static atf_timing_t Init_Timing;
+
+static void
+stop_init_timing(void)
+{
+    if (atf_timing_is_running(&Init_Timing))
+        atf_timing_stop(&Init_Timing);
+}
+
+/*
+ * Formats the lines that follow the result in the extended results format:
+ * the timings of the phases run so far and the resource usage of the
+ * process, taken when the body of the test case finishes.
+ */
+static atf_error_t
+format_extended(const struct context *ctx, atf_dynstr_t *out)
+{
+    atf_error_t err;
+
+    err = atf_timing_format(&Init_Timing, "init", out);
+    if (!atf_is_error(err))
+        err = atf_timing_format(&ctx->tc->pimpl->m_head_timing, "head", out);
+    if (!atf_is_error(err))
+        err = atf_timing_format(&ctx->body_timing, "body", out);
+    if (!atf_is_error(err))
+        err = atf_rusage_format(out);
+    return err;
+}
+
+/*
+ * Runs the head of the test case if it has not been run yet.
+ *
+ * Heads are not run on construction so that a test program does not pay
+ * for evaluating the heads of all of its test cases when it only runs one
+ * of them.  Instead, any access to the metadata of the test case triggers
+ * its evaluation on demand.  The head is cleared before calling it so
+ * that it can freely query and modify the properties of the test case.
+ */
+static void
+run_head(const atf_tc_t *tc)
+{
+    struct atf_tc_impl *impl = tc->pimpl;
+    const atf_tc_head_t head = impl->m_head;
+    atf_trace_span_t span;
+
+    if (head == NULL)
+        return;
+    impl->m_head = NULL;
+
+    stop_init_timing();
+    atf_trace_begin(&span);
+    atf_timing_start(&impl->m_head_timing);
+    /* XXX Should the head be able to return error codes? */
+    head(impl->m_self);
+    atf_timing_stop(&impl->m_head_timing);
+    atf_trace_end(&span, "tc", "head", impl->m_ident);
+
+    if (strcmp(atf_tc_get_md_var(tc, "ident"), impl->m_ident) != 0) {
+        report_fatal_error("Test case head modified the read-only 'ident' "
+            "property");
+        UNREACHABLE;
+    }
+}
+
+/*
+ * Runs the head of the test case before querying the given property.
+ * The 'ident' property is read-only, so the head cannot affect it and
+ * does not need to be evaluated to look it up.
+ */
+static void
+run_head_for(const atf_tc_t *tc, const char *name)
+{
+    if (strcmp(name, "ident") != 0)
+        run_head(tc);
+}
+
 /*
  * Constructors/destructors.
  */
@@ -586,25 +912,61 @@ atf_tc_init(atf_tc_t *tc, const char *ident, atf_tc_head_t head,
             const char *const *config)
 {
     atf_error_t err;
+    atf_vars_t *vars;
+
+    err = atf_vars_new(&vars, config);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_tc_init_vars(tc, ident, head, body, cleanup, vars);
+    atf_vars_unref(vars);
+    return err;
+}
+
+/*
+ * Same as atf_tc_init but takes a reference to an already-built config
+ * table instead of copying it, so that all the test cases of a program
+ * can share the same one.
+ */
+atf_error_t
+atf_tc_init_vars(atf_tc_t *tc, const char *ident, atf_tc_head_t head,
+                 atf_tc_body_t body, atf_tc_cleanup_t cleanup,
+                 struct atf_vars *config)
+{
+    return atf_tc_init_arena(tc, ident, head, body, cleanup, config, NULL);
+}
+
+/*
+ * Same as atf_tc_init_vars but, if arena is not NULL, allocates the test
+ * case and its metadata from it.  The arena must outlive the test case.
+ */
+atf_error_t
+atf_tc_init_arena(atf_tc_t *tc, const char *ident, atf_tc_head_t head,
+                  atf_tc_body_t body, atf_tc_cleanup_t cleanup,
+                  struct atf_vars *config, struct atf_arena *arena)
+{
+    atf_error_t err;
 
-    tc->pimpl = malloc(sizeof(struct atf_tc_impl));
+    if (arena != NULL)
+        tc->pimpl = atf_arena_alloc(arena, sizeof(struct atf_tc_impl));
+    else
+        tc->pimpl = malloc(sizeof(struct atf_tc_impl));
     if (tc->pimpl == NULL) {
         err = atf_no_memory_error();
         goto err;
     }
 
     tc->pimpl->m_ident = ident;
-    tc->pimpl->m_head = head;
+    tc->pimpl->m_self = tc;
+    tc->pimpl->m_head = NULL;
     tc->pimpl->m_body = body;
     tc->pimpl->m_cleanup = cleanup;
+    tc->pimpl->m_arena = arena;
+    atf_timing_init(&tc->pimpl->m_head_timing);
 
-    err = atf_map_init_charpp(&tc->pimpl->m_config, config);
-    if (atf_is_error(err))
-        goto err;
-
-    err = atf_map_init(&tc->pimpl->m_vars);
+    err = atf_map_init_interned(&tc->pimpl->m_vars, arena);
     if (atf_is_error(err))
-        goto err_vars;
+        goto err_impl;
 
     err = atf_tc_set_md_var(tc, "ident", ident);
     if (atf_is_error(err))
@@ -616,23 +978,19 @@ atf_tc_init(atf_tc_t *tc, const char *ident, atf_tc_head_t head,
             goto err_map;
     }
 
-    /* XXX Should the head be able to return error codes? */
-    if (tc->pimpl->m_head != NULL)
-        tc->pimpl->m_head(tc);
+    tc->pimpl->m_config = atf_vars_ref(config);
 
-    if (strcmp(atf_tc_get_md_var(tc, "ident"), ident) != 0) {
-        report_fatal_error("Test case head modified the read-only 'ident' "
-            "property");
-        UNREACHABLE;
-    }
+    /* Deferred until the metadata is first needed; see run_head. */
+    tc->pimpl->m_head = head;
 
     INV(!atf_is_error(err));
     return err;
 
 err_map:
     atf_map_fini(&tc->pimpl->m_vars);
-err_vars:
-    atf_map_fini(&tc->pimpl->m_config);
+err_impl:
+    if (arena == NULL)
+        free(tc->pimpl);
 err:
     return err;
 }
@@ -649,7 +1007,9 @@ void
 atf_tc_fini(atf_tc_t *tc)
 {
     atf_map_fini(&tc->pimpl->m_vars);
-    free(tc->pimpl);
+    atf_vars_unref(tc->pimpl->m_config);
+    if (tc->pimpl->m_arena == NULL)
+        free(tc->pimpl);
 }
 
 /*
@@ -666,11 +1026,9 @@ const char *
 atf_tc_get_config_var(const atf_tc_t *tc, const char *name)
 {
     const char *val;
-    atf_map_citer_t iter;
 
     PRE(atf_tc_has_config_var(tc, name));
-    iter = atf_map_find_c(&tc->pimpl->m_config, name);
-    val = atf_map_citer_data(iter);
+    val = atf_vars_get(tc->pimpl->m_config, name);
     INV(val != NULL);
 
     return val;
@@ -760,6 +1118,7 @@ atf_tc_get_md_var(const atf_tc_t *tc, const char *name)
     const char *val;
     atf_map_citer_t iter;
 
+    run_head_for(tc, name);
     PRE(atf_tc_has_md_var(tc, name));
     iter = atf_map_find_c(&tc->pimpl->m_vars, name);
     val = atf_map_citer_data(iter);
@@ -771,17 +1130,14 @@ atf_tc_get_md_var(const atf_tc_t *tc, const char *name)
 char **
 atf_tc_get_md_vars(const atf_tc_t *tc)
 {
+    run_head(tc);
     return atf_map_to_charpp(&tc->pimpl->m_vars);
 }
 
 bool
 atf_tc_has_config_var(const atf_tc_t *tc, const char *name)
 {
-    atf_map_citer_t end, iter;
-
-    iter = atf_map_find_c(&tc->pimpl->m_config, name);
-    end = atf_map_end_c(&tc->pimpl->m_config);
-    return !atf_equal_map_citer_map_citer(iter, end);
+    return atf_vars_get(tc->pimpl->m_config, name) != NULL;
 }
 
 bool
@@ -789,6 +1145,8 @@ atf_tc_has_md_var(const atf_tc_t *tc, const char *name)
 {
     atf_map_citer_t end, iter;
 
+    run_head_for(tc, name);
+
     iter = atf_map_find_c(&tc->pimpl->m_vars, name);
     end = atf_map_end_c(&tc->pimpl->m_vars);
     return !atf_equal_map_citer_map_citer(iter, end);
@@ -805,6 +1163,29 @@ atf_tc_set_md_var(atf_tc_t *tc, const char *name, const char *fmt, ...)
     char *value;
     va_list ap;
 
+    /* Ensure that the head does not later override this value. */
+    run_head_for(tc, name);
+
+    if (tc->pimpl->m_arena != NULL) {
+        atf_dynstr_t tmp;
+
+        /* Values replaced later on stay in the arena until it goes away,
+         * which is fine for the handful of times a property changes. */
+        va_start(ap, fmt);
+        err = atf_dynstr_init_ap(&tmp, fmt, ap);
+        va_end(ap);
+        if (atf_is_error(err))
+            return err;
+
+        value = atf_arena_strdup(tc->pimpl->m_arena,
+                                 atf_dynstr_cstring(&tmp));
+        atf_dynstr_fini(&tmp);
+        if (value == NULL)
+            return atf_no_memory_error();
+
+        return atf_map_insert(&tc->pimpl->m_vars, name, value, false);
+    }
+
     va_start(ap, fmt);
     err = atf_text_format_ap(&value, fmt, ap);
     va_end(ap);
@@ -869,7 +1250,10 @@ _atf_tc_fail_nonfatal(struct context *ctx, const char *fmt, va_list ap)
     format_reason_ap(&reason, NULL, 0, fmt, ap2);
     va_end(ap2);
 
-    fail_check(ctx, &reason);
+    if (count_check(ctx, NULL, 0))
+        fail_check(ctx, &reason);
+    else
+        atf_dynstr_fini(&reason);
 }
 
 static void
@@ -879,6 +1263,9 @@ _atf_tc_fail_check(struct context *ctx, const char *file, const size_t line,
     va_list ap2;
     atf_dynstr_t reason;
 
+    if (!count_check(ctx, file, line))
+        return;
+
     va_copy(ap2, ap);
     format_reason_ap(&reason, file, line, fmt, ap2);
     va_end(ap2);
@@ -932,7 +1319,14 @@ _atf_tc_check_errno(struct context *ctx, const char *file, const size_t line,
                     const int exp_errno, const char *expr_str,
                     const bool expr_result)
 {
-    errno_test(ctx, file, line, exp_errno, expr_str, expr_result, fail_check);
+    atf_dynstr_t reason;
+
+    if (errno_test(file, line, exp_errno, expr_str, expr_result, &reason)) {
+        if (count_check(ctx, file, line))
+            fail_check(ctx, &reason);
+        else
+            atf_dynstr_fini(&reason);
+    }
 }
 
 static void
@@ -940,8 +1334,10 @@ _atf_tc_require_errno(struct context *ctx, const char *file, const size_t line,
                       const int exp_errno, const char *expr_str,
                       const bool expr_result)
 {
-    errno_test(ctx, file, line, exp_errno, expr_str, expr_result,
-        fail_requirement);
+    atf_dynstr_t reason;
+
+    if (errno_test(file, line, exp_errno, expr_str, expr_result, &reason))
+        fail_requirement(ctx, &reason);
 }
 
 static void
@@ -1046,11 +1442,24 @@ _atf_tc_set_resultsfile(struct context *ctx, const char *file)
 
 static struct context Current;
 
+static
+void
+report_current_check_sites(void)
+{
+    if (getpid() == Check_sites_pid)
+        report_check_sites(&Current);
+}
+
 atf_error_t
 atf_tc_run(const atf_tc_t *tc, const char *resfile)
 {
+    run_head(tc);
+    stop_init_timing();
+
     context_init(&Current, tc, resfile);
 
+    atf_trace_begin(&Current.body_span);
+    atf_timing_start(&Current.body_timing);
     tc->pimpl->m_body(tc);
 
     validate_expect(&Current);
@@ -1077,9 +1486,77 @@ atf_tc_run(const atf_tc_t *tc, const char *resfile)
 atf_error_t
 atf_tc_cleanup(const atf_tc_t *tc)
 {
+    return atf_tc_cleanup_resfile(tc, NULL);
+}
+
+/*
+ * Starts measuring the initialization phase reported by the extended
+ * results format.  Called when the test program starts and again in every
+ * child forked to run a test case.
+ */
+void
+atf_tc_start_init_timing(void)
+{
+    atf_timing_start(&Init_Timing);
+}
+
+/*
+ * Runs the cleanup routine of a test case.  If resfile is not NULL and the
+ * extended results format is enabled, the timing of the cleanup routine is
+ * appended to the results file written by the body of the test case.
+ */
+atf_error_t
+atf_tc_cleanup_resfile(const atf_tc_t *tc, const char *resfile)
+{
+    atf_error_t err;
+    atf_timing_t timing;
+    atf_dynstr_t extra;
+    atf_trace_span_t span;
+    bool opened = false;
+    int fd;
+
+    run_head(tc);
+    stop_init_timing();
+
+    atf_trace_begin(&span);
+    atf_timing_start(&timing);
     if (tc->pimpl->m_cleanup != NULL)
         tc->pimpl->m_cleanup(tc);
-    return atf_no_error(); /* XXX */
+    atf_timing_stop(&timing);
+    atf_trace_end(&span, "tc", "cleanup", atf_tc_get_ident(tc));
+
+    if (resfile == NULL || !extended_results())
+        return atf_no_error();
+
+    err = atf_dynstr_init(&extra);
+    if (atf_is_error(err))
+        return err;
+    err = atf_timing_format(&timing, "cleanup", &extra);
+    if (atf_is_error(err))
+        goto out_extra;
+
+    fd = resfile_fd(resfile);
+    if (fd == -1) {
+        opened = true;
+        fd = open(resfile, O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd == -1) {
+            err = atf_libc_error(errno, "Cannot open results file '%s'",
+                                 resfile);
+            goto out_extra;
+        }
+    } else if (fd != STDOUT_FILENO && fd != STDERR_FILENO)
+        (void)lseek(fd, 0, SEEK_END);
+
+    if (write(fd, atf_dynstr_cstring(&extra), atf_dynstr_length(&extra))
+        == -1)
+        err = atf_libc_error(errno, "Cannot write to results file '%s'",
+                             resfile);
+    if (opened)
+        close(fd);
+
+out_extra:
+    atf_dynstr_fini(&extra);
+    return err;
 }
 
 /* ---------------------------------------------------------------------
@@ -124,8 +124,10 @@ void atf_tc_expect_timeout(const char *, ...)
 
 /* To be run from test case bodies only; internal to macros.h. */
 void atf_tc_fail_check(const char *, const size_t, const char *, ...)
+    ATF_DEFS_ATTRIBUTE_COLD
     ATF_DEFS_ATTRIBUTE_FORMAT_PRINTF(3, 4);
 void atf_tc_fail_requirement(const char *, const size_t, const char *, ...)
+    ATF_DEFS_ATTRIBUTE_COLD
     ATF_DEFS_ATTRIBUTE_FORMAT_PRINTF(3, 4)
     ATF_DEFS_ATTRIBUTE_NORETURN;
 void atf_tc_check_errno(const char *, const size_t, const int,
@@ -27,18 +27,25 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 #include <unistd.h>
 
+#include "atf-c/detail/arena.h"
 #include "atf-c/detail/fs.h"
-#include "atf-c/detail/map.h"
+#include "atf-c/detail/index.h"
+#include "atf-c/detail/list.h"
 #include "atf-c/detail/sanity.h"
+#include "atf-c/detail/tc.h"
+#include "atf-c/detail/vars.h"
 #include "atf-c/error.h"
 #include "atf-c/tc.h"
 
 struct atf_tp_impl {
     atf_list_t m_tcs;
-    atf_map_t m_config;
+    atf_index_t m_index;
+    atf_vars_t *m_config;
+
+    /* Backs the test cases added with atf_tp_add_tc_pack. */
+    atf_arena_t m_arena;
 };
 
 /* ---------------------------------------------------------------------
@@ -49,19 +56,7 @@ static
 const atf_tc_t *
 find_tc(const atf_tp_t *tp, const char *ident)
 {
-    const atf_tc_t *tc;
-    atf_list_citer_t iter;
-
-    tc = NULL;
-    atf_list_for_each_c(iter, &tp->pimpl->m_tcs) {
-        const atf_tc_t *tc2;
-        tc2 = atf_list_citer_data(iter);
-        if (strcmp(atf_tc_get_ident(tc2), ident) == 0) {
-            tc = tc2;
-            break;
-        }
-    }
-    return tc;
+    return atf_index_get(&tp->pimpl->m_index, ident);
 }
 
 /* ---------------------------------------------------------------------
@@ -87,12 +82,20 @@ atf_tp_init(atf_tp_t *tp, const char *const *config)
     if (atf_is_error(err))
         goto out;
 
-    err = atf_map_init_charpp(&tp->pimpl->m_config, config);
+    err = atf_index_init(&tp->pimpl->m_index);
     if (atf_is_error(err)) {
         atf_list_fini(&tp->pimpl->m_tcs);
         goto out;
     }
 
+    err = atf_vars_new(&tp->pimpl->m_config, config);
+    if (atf_is_error(err)) {
+        atf_index_fini(&tp->pimpl->m_index);
+        atf_list_fini(&tp->pimpl->m_tcs);
+        goto out;
+    }
+
+    err = atf_arena_init(&tp->pimpl->m_arena);
     INV(!atf_is_error(err));
 out:
     return err;
@@ -103,14 +106,17 @@ atf_tp_fini(atf_tp_t *tp)
 {
     atf_list_iter_t iter;
 
-    atf_map_fini(&tp->pimpl->m_config);
-
     atf_list_for_each(iter, &tp->pimpl->m_tcs) {
         atf_tc_t *tc = atf_list_iter_data(iter);
         atf_tc_fini(tc);
     }
     atf_list_fini(&tp->pimpl->m_tcs);
+    atf_index_fini(&tp->pimpl->m_index);
 
+    atf_vars_unref(tp->pimpl->m_config);
+
+    /* Releases all the test cases added from packs at once. */
+    atf_arena_fini(&tp->pimpl->m_arena);
     free(tp->pimpl);
 }
 
@@ -121,7 +127,7 @@ atf_tp_fini(atf_tp_t *tp)
 char **
 atf_tp_get_config(const atf_tp_t *tp)
 {
-    return atf_map_to_charpp(&tp->pimpl->m_config);
+    return atf_vars_to_charpp(tp->pimpl->m_config);
 }
 
 bool
@@ -180,12 +186,43 @@ atf_tp_add_tc(atf_tp_t *tp, atf_tc_t *tc)
     PRE(find_tc(tp, atf_tc_get_ident(tc)) == NULL);
 
     err = atf_list_append(&tp->pimpl->m_tcs, tc, false);
+    if (atf_is_error(err))
+        return err;
+
+    /* The index cannot drop entries, so it is updated last and the list
+     * is rolled back if it fails: the caller may finalize tc then. */
+    err = atf_index_insert(&tp->pimpl->m_index, atf_tc_get_ident(tc), tc);
+    if (atf_is_error(err)) {
+        atf_list_remove_last(&tp->pimpl->m_tcs);
+        return err;
+    }
 
     POST(find_tc(tp, atf_tc_get_ident(tc)) != NULL);
 
     return err;
 }
 
+/*
+ * Initializes the given test case from its pack, sharing the config of
+ * the test program with it, and adds it to the test program.
+ */
+atf_error_t
+atf_tp_add_tc_pack(atf_tp_t *tp, atf_tc_t *tc, const atf_tc_pack_t *pack)
+{
+    atf_error_t err;
+
+    err = atf_tc_init_arena(tc, pack->m_ident, pack->m_head, pack->m_body,
+                            pack->m_cleanup, tp->pimpl->m_config,
+                            &tp->pimpl->m_arena);
+    if (atf_is_error(err))
+        return err;
+
+    err = atf_tp_add_tc(tp, tc);
+    if (atf_is_error(err))
+        atf_tc_fini(tc);
+    return err;
+}
+
 /* ---------------------------------------------------------------------
  * Free functions.
  * --------------------------------------------------------------------- */
@@ -31,6 +31,7 @@
 #include <atf-c/error_fwd.h>
 
 struct atf_tc;
+struct atf_tc_pack;
 
 /* ---------------------------------------------------------------------
  * The "atf_tp" type.
@@ -54,6 +55,8 @@ const struct atf_tc **atf_tp_get_tcs(const atf_tp_t *);
 
 /* Modifiers. */
 atf_error_t atf_tp_add_tc(atf_tp_t *, struct atf_tc *);
+atf_error_t atf_tp_add_tc_pack(atf_tp_t *, struct atf_tc *,
+                               const struct atf_tc_pack *);
 
 /* ---------------------------------------------------------------------
  * Free functions.
@@ -40,6 +40,7 @@
 #include <atf-c.h>
 
 #include "atf-c/detail/dynstr.h"
+#include "atf-c/detail/trace.h"
 
 /* No prototype in header for this one, it's a little sketchy (internal). */
 void atf_tc_set_resultsfile(const char *);
@@ -255,9 +256,14 @@ atf_utils_file_exists(const char *path)
 pid_t
 atf_utils_fork(void)
 {
+    atf_trace_span_t span;
+    atf_trace_begin(&span);
+
     const pid_t pid = fork();
     if (pid == -1)
         atf_tc_fail("fork failed");
+    else if (pid > 0)
+        atf_trace_end(&span, "utils", "fork", NULL);
 
     if (pid == 0) {
         atf_dynstr_t out_name;
@@ -377,7 +383,7 @@ atf_utils_readline(const int fd)
 
     while ((cnt = read(fd, &ch, sizeof(ch))) == sizeof(ch) &&
            ch != '\n') {
-        error = atf_dynstr_append_fmt(&temp, "%c", ch);
+        error = atf_dynstr_append_mem(&temp, &ch, sizeof(ch));
         ATF_REQUIRE(!atf_is_error(error));
     }
     ATF_REQUIRE(cnt != -1);
@@ -385,8 +391,11 @@ atf_utils_readline(const int fd)
     if (cnt == 0 && atf_dynstr_length(&temp) == 0) {
         atf_dynstr_fini(&temp);
         return NULL;
-    } else
-        return atf_dynstr_fini_disown(&temp);
+    } else {
+        char *line = atf_dynstr_fini_disown(&temp);
+        ATF_REQUIRE(line != NULL);
+        return line;
+    }
 }
 
 /** Redirects a file descriptor to a file.
@@ -427,8 +436,12 @@ void
 atf_utils_wait(const pid_t pid, const int exitstatus, const char *expout,
                const char *experr)
 {
+    atf_trace_span_t span;
+    atf_trace_begin(&span);
+
     int status;
     ATF_REQUIRE(waitpid(pid, &status, 0) != -1);
+    atf_trace_end(&span, "utils", "wait", NULL);
 
     atf_dynstr_t out_name;
     init_out_filename(&out_name, pid, "out", true);
@@ -44,6 +44,10 @@ extern "C" {
 #include <memory>
 #include <utility>
 
+extern "C" {
+#include "atf-c/detail/trace.h"
+}
+
 #include "atf-c++/check.hpp"
 #include "atf-c++/detail/application.hpp"
 #include "atf-c++/detail/env.hpp"
@@ -118,7 +122,8 @@ public:
         const atf::fs::path file = atf::fs::path(
             atf::env::get("TMPDIR", "/tmp")) / pattern;
 
-        std::vector<char> buf(file.str().begin(), file.str().end());
+        const std::string str = file.str();
+        std::vector<char> buf(str.begin(), str.end());
         buf.push_back('\0');
 
         m_fd = ::mkstemp(buf.data());
@@ -901,7 +906,9 @@ atf_check::main(void)
         throw atf::application::usage_error("No command specified");
 
     int status = EXIT_FAILURE;
+    atf_trace_span_t span;
 
+    atf_trace_begin(&span);
     if (m_status_checks.empty())
         m_status_checks.push_back(status_check(sc_exit, false, EXIT_SUCCESS));
     else if (m_status_checks.size() > 1) {
@@ -932,6 +939,7 @@ atf_check::main(void)
         }
     } while (m_rflag && status == EXIT_FAILURE);
 
+    atf_trace_end(&span, "atf-check", "run", m_argv[0]);
     return status;
 }
 
@@ -0,0 +1,131 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+/* Runs a command several times and prints the median of its wall times. */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static
+int
+compare_doubles(const void *a, const void *b)
+{
+    const double da = *(const double *)a;
+    const double db = *(const double *)b;
+
+    return da < db ? -1 : (da > db);
+}
+
+static
+double
+usecs_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e6 +
+           (now.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+/* Runs the command once with its output discarded and returns how long it
+ * took in microseconds, or a negative value if it did not succeed. */
+static
+double
+run_once(char *const *argv)
+{
+    struct timespec start;
+    pid_t pid;
+    int status;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    pid = fork();
+    if (pid == -1)
+        return -1;
+    else if (pid == 0) {
+        const int fd = open("/dev/null", O_WRONLY);
+        if (fd != -1) {
+            (void)dup2(fd, STDOUT_FILENO);
+            (void)dup2(fd, STDERR_FILENO);
+        }
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+
+    while (waitpid(pid, &status, 0) == -1)
+        if (errno != EINTR)
+            return -1;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        return -1;
+    return usecs_since(&start);
+}
+
+int
+main(int argc, char **argv)
+{
+    double *times;
+    long i, repeat;
+
+    if (argc < 3 || (repeat = strtol(argv[1], NULL, 10)) < 1) {
+        fprintf(stderr, "Usage: %s repeat command [arg ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    times = malloc(repeat * sizeof(*times));
+    if (times == NULL) {
+        fprintf(stderr, "%s: Not enough memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Warm up the page cache and the dynamic linker. */
+    if (run_once(&argv[2]) < 0) {
+        fprintf(stderr, "%s: %s did not exit successfully\n", argv[0],
+                argv[2]);
+        free(times);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < repeat; i++) {
+        times[i] = run_once(&argv[2]);
+        if (times[i] < 0) {
+            fprintf(stderr, "%s: %s did not exit successfully\n", argv[0],
+                    argv[2]);
+            free(times);
+            return EXIT_FAILURE;
+        }
+    }
+
+    qsort(times, repeat, sizeof(*times), compare_doubles);
+    printf("%.1f\n", times[repeat / 2]);
+    free(times);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#! /bin/sh
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Runs the benchmarks of the framework overhead and prints one JSON
+# record per measurement, which is also appended to the given output file.
+#
+# Usage: bench.sh bench_dir output
+#
+# The programs are expected in bench_dir.  The environment may set:
+#   ATF_SH: the atf-sh interpreter; the atf-sh benchmarks are skipped if
+#       it does not exist, as they need an installed atf-sh.
+#   BENCH_REPEAT: how many times to run each program (default 20).
+#   BENCH_TCS: the numbers of empty test cases to register in the startup
+#       and -l benchmarks (default "1 10 100 1000").
+#   BENCH_VERSION: the version of the framework being measured.
+
+set -e
+
+Prog_Name=${0##*/}
+
+# Prints an error message and exits.
+err() {
+    echo "${Prog_Name}: ${*}" 1>&2
+    exit 1
+}
+
+# Prints a record and adds it to the output.
+#
+# Usage: emit bench tcs value unit
+emit() {
+    if [ -n "${2}" ]; then
+        tcs=", \"tcs\": ${2}"
+    else
+        tcs=
+    fi
+    echo "{\"version\": \"${Version}\", \"bench\": \"${1}\"${tcs}," \
+        "\"value\": ${3}, \"unit\": \"${4}\"}" | tee -a "${Output}"
+}
+
+# Prints the median wall time of a command in microseconds.
+median() {
+    "${Dir}/bench-timer" "${Repeat}" "${@}" || err "Failed to run ${*}"
+}
+
+# Measures the startup and -l time of a program as a function of the
+# number of test cases that it registers.
+#
+# Usage: bench_startup lang program
+bench_startup() {
+    for n in ${Tcs}; do
+        emit "${1}.list" "${n}" "$(BENCH_TCS=${n} median "${2}" -l)" us
+        emit "${1}.startup" "${n}" "$(BENCH_TCS=${n} median "${2}" \
+            -s "${Dir}" -r /dev/null empty)" us
+    done
+}
+
+# Runs a test case that measures something itself and prints the result.
+#
+# Usage: bench_self bench unit program test_case
+bench_self() {
+    value=$("${3}" -s "${Dir}" -r /dev/null "${4}") || \
+        err "Failed to run ${3}:${4}"
+    emit "${1}" "" "${value}" "${2}"
+}
+
+main() {
+    [ ${#} -eq 2 ] || err "Usage: ${Prog_Name} bench_dir output"
+    Dir=$(cd "${1}" && pwd)
+    Output=${2}
+    Repeat=${BENCH_REPEAT:-20}
+    Tcs=${BENCH_TCS:-"1 10 100 1000"}
+    Version=${BENCH_VERSION:-unknown}
+    unset BENCH_TCS ATF_TRACE_FILE ATF_REPORT_FILE ATF_RESULTS_FORMAT
+
+    # Silence the warnings about running test cases outside of a runner.
+    __RUNNING_INSIDE_ATF_RUN=internal-yes-value
+    export __RUNNING_INSIDE_ATF_RUN
+
+    case "${Output}" in
+        /*) ;;
+        *) Output="$(pwd)/${Output}" ;;
+    esac
+
+    work=$(mktemp -d "${TMPDIR:-/tmp}/atf-bench.XXXXXX")
+    trap "rm -rf '${work}'" EXIT
+    cd "${work}"
+
+    bench_startup c "${Dir}/bench_c"
+    bench_self c.check_exec us "${Dir}/bench_c" check_exec
+    bench_self c.macros.check ns "${Dir}/bench_c" macros_check
+    bench_self c.macros.require_eq ns "${Dir}/bench_c" macros_require_eq
+
+    bench_startup c++ "${Dir}/bench_cpp"
+    bench_self c++.check_exec us "${Dir}/bench_cpp" check_exec
+    bench_self c++.macros.require_eq ns "${Dir}/bench_cpp" macros_require_eq
+
+    if [ ! -x "${ATF_SH:-}" ]; then
+        echo "${Prog_Name}: Skipping the atf-sh benchmarks; install" \
+            "atf-sh first" 1>&2
+        return 0
+    fi
+    bench_startup sh "${Dir}/bench_sh"
+    iterations=20
+    with=$(median "${Dir}/bench_sh" -s "${Dir}" -r /dev/null \
+        -v iterations=${iterations} atf_check)
+    without=$(median "${Dir}/bench_sh" -s "${Dir}" -r /dev/null \
+        -v iterations=${iterations} plain)
+    emit sh.atf_check "" "$(echo "${with} ${without} ${iterations}" | \
+        awk '{ printf "%.1f", ($1 - $2) / $3 }')" us
+}
+
+main "${@}"
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -0,0 +1,167 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+/*
+ * Benchmarks for libatf-c.  Besides the test cases below, the program
+ * registers as many empty test cases as the BENCH_TCS environment variable
+ * says, so that its startup and -l times can be measured as a function of
+ * the number of test cases.  The other benchmarks print the average cost
+ * of what they measure to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <atf-c.h>
+
+#include "atf-c/check.h"
+
+static
+double
+nsecs_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e9 + (now.tv_nsec - start->tv_nsec);
+}
+
+static
+long
+iterations(const atf_tc_t *tc, const char *dflt)
+{
+    return strtol(atf_tc_get_config_var_wd(tc, "iterations", dflt), NULL, 10);
+}
+
+ATF_TC_WITHOUT_HEAD(empty);
+ATF_TC_BODY(empty, tc)
+{
+}
+
+ATF_TC(check_exec);
+ATF_TC_HEAD(check_exec, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Cost of atf_check_exec_array");
+}
+ATF_TC_BODY(check_exec, tc)
+{
+    const char *argv[] = { "true", NULL };
+    const long n = iterations(tc, "200");
+    struct timespec start;
+    long i;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < n; i++) {
+        atf_check_result_t result;
+
+        ATF_REQUIRE(!atf_is_error(atf_check_exec_array(argv, &result)));
+        ATF_REQUIRE(atf_check_result_exited(&result));
+        atf_check_result_fini(&result);
+    }
+    printf("%.1f\n", nsecs_since(&start) / n / 1e3);
+}
+
+ATF_TC(macros_check);
+ATF_TC_HEAD(macros_check, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Cost of a passing ATF_CHECK");
+}
+ATF_TC_BODY(macros_check, tc)
+{
+    const long n = iterations(tc, "10000000");
+    struct timespec start;
+    volatile long i;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < n; i++)
+        ATF_CHECK(i >= 0);
+    printf("%.2f\n", nsecs_since(&start) / n);
+}
+
+ATF_TC(macros_require_eq);
+ATF_TC_HEAD(macros_require_eq, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Cost of a passing ATF_REQUIRE_EQ");
+}
+ATF_TC_BODY(macros_require_eq, tc)
+{
+    const long n = iterations(tc, "10000000");
+    struct timespec start;
+    volatile long i;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < n; i++)
+        ATF_REQUIRE_EQ(i, i);
+    printf("%.2f\n", nsecs_since(&start) / n);
+}
+
+/* Registers the given number of empty test cases, which live for as long
+ * as the program. */
+static
+atf_error_t
+add_empty_tcs(atf_tp_t *tp, const long count)
+{
+    struct atf_tc_pack *packs;
+    atf_tc_t *tcs;
+    long i;
+
+    tcs = calloc(count, sizeof(*tcs));
+    packs = calloc(count, sizeof(*packs));
+    if (tcs == NULL || packs == NULL) {
+        free(tcs);
+        free(packs);
+        return atf_no_memory_error();
+    }
+
+    for (i = 0; i < count; i++) {
+        atf_error_t err;
+        char *ident;
+
+        ident = malloc(32);
+        if (ident == NULL)
+            return atf_no_memory_error();
+        snprintf(ident, 32, "empty%ld", i);
+        packs[i].m_ident = ident;
+        packs[i].m_body = ATF_TC_BODY_NAME(empty);
+        err = atf_tp_add_tc_pack(tp, &tcs[i], &packs[i]);
+        if (atf_is_error(err))
+            return err;
+    }
+    return atf_no_error();
+}
+
+ATF_TP_ADD_TCS(tp)
+{
+    const char *count = getenv("BENCH_TCS");
+
+    ATF_TP_ADD_TC(tp, empty);
+    ATF_TP_ADD_TC(tp, check_exec);
+    ATF_TP_ADD_TC(tp, macros_check);
+    ATF_TP_ADD_TC(tp, macros_require_eq);
+
+    return count == NULL ? atf_no_error() :
+        add_empty_tcs(tp, strtol(count, NULL, 10));
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2026 The NetBSD Foundation, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+// CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+// INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+// IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+// IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+// IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Benchmarks for libatf-c++.  Besides the test cases below, the program
+// registers as many empty test cases as the BENCH_TCS environment variable
+// says, so that its startup and -l times can be measured as a function of
+// the number of test cases.  The other benchmarks print the average cost
+// of what they measure to stdout.
+
+extern "C" {
+#include <time.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <atf-c++.hpp>
+
+#include "atf-c++/check.hpp"
+#include "atf-c++/detail/process.hpp"
+
+namespace {
+
+double
+nsecs_since(const struct timespec& start)
+{
+    struct timespec now;
+
+    (void)::clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1e9 + (now.tv_nsec - start.tv_nsec);
+}
+
+long
+iterations(const atf::tests::tc& tc, const char* dflt)
+{
+    return std::strtol(tc.get_config_var("iterations", dflt).c_str(), NULL,
+                       10);
+}
+
+class empty_tc : public atf::tests::tc {
+    void body(void) const {}
+
+public:
+    explicit empty_tc(const std::string& ident) :
+        atf::tests::tc(ident, false)
+    {
+    }
+};
+
+} // anonymous namespace
+
+ATF_TEST_CASE_WITHOUT_HEAD(empty);
+ATF_TEST_CASE_BODY(empty)
+{
+}
+
+ATF_TEST_CASE(check_exec);
+ATF_TEST_CASE_HEAD(check_exec)
+{
+    set_md_var("descr", "Cost of atf::check::exec");
+}
+ATF_TEST_CASE_BODY(check_exec)
+{
+    const atf::process::argv_array argv("true", NULL);
+    const long n = iterations(*this, "200");
+    struct timespec start;
+
+    (void)::clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < n; i++) {
+        std::unique_ptr< atf::check::check_result > r =
+            atf::check::exec(argv);
+        ATF_REQUIRE(r->exited());
+    }
+    std::printf("%.1f\n", nsecs_since(start) / n / 1e3);
+}
+
+ATF_TEST_CASE(macros_require_eq);
+ATF_TEST_CASE_HEAD(macros_require_eq)
+{
+    set_md_var("descr", "Cost of a passing ATF_REQUIRE_EQ");
+}
+ATF_TEST_CASE_BODY(macros_require_eq)
+{
+    const long n = iterations(*this, "10000000");
+    struct timespec start;
+
+    (void)::clock_gettime(CLOCK_MONOTONIC, &start);
+    for (volatile long i = 0; i < n; i++)
+        ATF_REQUIRE_EQ(i, i);
+    std::printf("%.2f\n", nsecs_since(start) / n);
+}
+
+ATF_INIT_TEST_CASES(tcs)
+{
+    ATF_ADD_TEST_CASE(tcs, empty);
+    ATF_ADD_TEST_CASE(tcs, check_exec);
+    ATF_ADD_TEST_CASE(tcs, macros_require_eq);
+
+    const char* count = std::getenv("BENCH_TCS");
+    if (count != NULL) {
+        const long n = std::strtol(count, NULL, 10);
+        for (long i = 0; i < n; i++) {
+            char ident[32];
+            std::snprintf(ident, sizeof(ident), "empty%ld", i);
+            tcs.push_back(new empty_tc(ident));
+        }
+    }
+}
@@ -0,0 +1,75 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Benchmarks for atf-sh.  Besides the test cases below, the program
+# registers as many empty test cases as the BENCH_TCS environment variable
+# says, so that its startup and -l times can be measured as a function of
+# the number of test cases.  The atf_check and plain test cases run the
+# same command, with and without atf_check, as many times as the
+# iterations configuration variable says, so that the overhead of atf-check
+# is the difference between their run times.
+
+atf_test_case empty
+empty_body()
+{
+    :
+}
+
+atf_test_case atf_check
+atf_check_body()
+{
+    i=0
+    while [ ${i} -lt $(atf_config_get iterations 100) ]; do
+        atf_check env true
+        i=$((${i} + 1))
+    done
+}
+
+atf_test_case plain
+plain_body()
+{
+    i=0
+    while [ ${i} -lt $(atf_config_get iterations 100) ]; do
+        env true || atf_fail "env true failed"
+        i=$((${i} + 1))
+    done
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case empty
+    atf_add_test_case atf_check
+    atf_add_test_case plain
+
+    i=0
+    while [ ${i} -lt ${BENCH_TCS:-0} ]; do
+        atf_test_case empty${i}
+        eval "empty${i}_body() { :; }"
+        atf_add_test_case empty${i}
+        i=$((${i} + 1))
+    done
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
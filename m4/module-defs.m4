@@ -101,8 +101,49 @@ function(int a __attribute__((__unused__)))
     AC_SUBST([ATTRIBUTE_UNUSED], [${value}])
 ])
 
+AC_DEFUN([ATF_ATTRIBUTE_COLD], [
+    AC_MSG_CHECKING(
+        [whether __attribute__((__cold__, __noinline__)) is supported])
+    AC_COMPILE_IFELSE(
+        [AC_LANG_PROGRAM([
+static void function(void) __attribute__((__cold__, __noinline__));
+
+static void
+function(void)
+{
+}], [
+    function();
+    return 0;
+])],
+        [AC_MSG_RESULT(yes)
+         value="__attribute__((__cold__, __noinline__))"],
+        [AC_MSG_RESULT(no)
+         value=""]
+    )
+    AC_SUBST([ATTRIBUTE_COLD], [${value}])
+])
+
+AC_DEFUN([ATF_BUILTIN_EXPECT], [
+    AC_MSG_CHECKING(whether __builtin_expect is supported)
+    AC_LINK_IFELSE(
+        [AC_LANG_PROGRAM([], [
+    int a = 3;
+    if (__builtin_expect(!!(a == 3), 0))
+        return 1;
+    return 0;
+])],
+        [AC_MSG_RESULT(yes)
+         value="__builtin_expect(!!(x), 0)"],
+        [AC_MSG_RESULT(no)
+         value="(x)"]
+    )
+    AC_SUBST([BUILTIN_EXPECT_FALSE], [${value}])
+])
+
 AC_DEFUN([ATF_MODULE_DEFS], [
+    ATF_ATTRIBUTE_COLD
     ATF_ATTRIBUTE_FORMAT_PRINTF
     ATF_ATTRIBUTE_NORETURN
     ATF_ATTRIBUTE_UNUSED
+    ATF_BUILTIN_EXPECT
 ])
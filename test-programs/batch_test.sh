@@ -0,0 +1,324 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+atf_test_case parallel_results
+parallel_results_head()
+{
+    atf_set "descr" "Tests that -j runs several test cases and reports one" \
+                    "result line per test case"
+}
+parallel_results_body()
+{
+    for h in $(get_helpers c_helpers); do
+        atf_check -s eq:1 -o match:"msg" -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 2 result_pass result_fail result_skip
+        atf_check -o match:"^result_pass: passed$" \
+            -o match:"^result_fail: failed: Failure reason$" \
+            -o match:"^result_skip: skipped: Skipped reason$" cat resfile
+        atf_check -o inline:"3\n" grep -c . resfile
+
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 0 result_pass result_skip
+    done
+}
+
+atf_test_case parallel_cleanup
+parallel_cleanup_head()
+{
+    atf_set "descr" "Tests that -j runs the cleanup routine of the test" \
+                    "cases in the same work directory as their body"
+}
+parallel_cleanup_body()
+{
+    for h in $(get_helpers c_helpers); do
+        atf_check -s eq:0 -o inline:"cleanup_pass: passed\n" -e ignore \
+            "${h}" -s "$(atf_get_srcdir)" -j 2 -v tmpfile="$(pwd)/tmpfile" \
+            -v cleanup=true cleanup_pass
+        test ! -f tmpfile || atf_fail "Cleanup routine not executed"
+
+        atf_check -s eq:0 -o match:"Old value: 1234" \
+            -o match:"cleanup_curdir: passed" -e ignore \
+            "${h}" -s "$(atf_get_srcdir)" -j 1 cleanup_curdir
+    done
+}
+
+atf_test_case parallel_expect
+parallel_expect_head()
+{
+    atf_set "descr" "Tests that -j interprets the expectations of the" \
+                    "test cases"
+}
+parallel_expect_body()
+{
+    for h in $(get_helpers c_helpers); do
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 3 expect_exit_code_and_exit \
+            expect_signal_any_and_signal expect_death_and_signal
+        atf_check -o match:"^expect_exit_code_and_exit: expected_exit\(123\)" \
+            -o match:"^expect_signal_any_and_signal: expected_signal" \
+            -o match:"^expect_death_and_signal: expected_death" cat resfile
+    done
+}
+
+atf_test_case parallel_history
+parallel_history_head()
+{
+    atf_set "descr" "Tests that -j records the duration of the test cases" \
+                    "and runs the slowest ones first"
+}
+parallel_history_body()
+{
+    for h in $(get_helpers c_helpers); do
+        export ATF_HISTORY_FILE="$(pwd)/history"
+
+        printf '5 result_pass\n500 result_skip\n50 result_fail\n' >history
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 1 result_pass result_fail result_skip
+        atf_check -o inline:"result_skip\nresult_fail\nresult_pass\n" \
+            sed -e 's/:.*//' resfile
+
+        atf_check -o match:"^[0-9]+ result_pass$" \
+            -o match:"^[0-9]+ result_fail$" \
+            -o match:"^[0-9]+ result_skip$" cat history
+        atf_check -o not-match:"^500 " cat history
+
+        export ATF_HISTORY_FILE=
+        rm history
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 1 result_pass
+        test ! -f history || atf_fail "History written when disabled"
+    done
+}
+
+atf_test_case parallel_errors
+parallel_errors_head()
+{
+    atf_set "descr" "Tests that invalid uses of -j are reported"
+}
+parallel_errors_body()
+{
+    for h in $(get_helpers c_helpers); do
+        atf_check -s eq:1 -e match:"ERROR.*non-negative integer" \
+            "${h}" -s "$(atf_get_srcdir)" -j foo
+        atf_check -s eq:1 -e match:"ERROR.*Cannot use -j with -l" \
+            "${h}" -s "$(atf_get_srcdir)" -j 2 -l
+        atf_check -s eq:1 -e match:"ERROR.*Unknown test case .foo'" \
+            "${h}" -s "$(atf_get_srcdir)" -j 2 result_pass foo
+        atf_check -s eq:1 -e match:"ERROR.*test case parts" \
+            "${h}" -s "$(atf_get_srcdir)" -j 2 result_pass:cleanup
+        atf_check -s eq:1 -e match:"ERROR.*-R requires a positive integer" \
+            "${h}" -s "$(atf_get_srcdir)" -j 2 -R 0 result_pass
+        atf_check -s eq:1 -e match:"ERROR.*Cannot use -R without -j" \
+            "${h}" -s "$(atf_get_srcdir)" -R 2 result_pass
+    done
+}
+
+atf_test_case parallel_reruns
+parallel_reruns_head()
+{
+    atf_set "descr" "Tests that -R reruns failing test cases, records" \
+                    "their attempts in the report and only shows the" \
+                    "output of the last attempt"
+}
+parallel_reruns_body()
+{
+    for h in $(get_helpers c_helpers); do
+        export ATF_REPORT_FILE="$(pwd)/report"
+
+        for jobs in 1 2; do
+            rm -f report
+            atf_check -s eq:1 -o save:stdout -e ignore "${h}" \
+                -s "$(atf_get_srcdir)" -r resfile -j "${jobs}" -R 2 \
+                result_pass result_fail
+            atf_check -o inline:"2\n" grep -c "^msg$" stdout
+            atf_check -o match:"^result_pass: passed$" \
+                -o match:"^result_fail: failed: Failure reason$" cat resfile
+            atf_check -o match:'"result_pass", .*"rerun\.failures": 0, ' \
+                -o match:'"result_fail", .*"rerun\.failures": 3, ' \
+                -o match:'"result_fail", .*"rerun\.class": "deterministic"' \
+                cat report
+        done
+    done
+}
+
+atf_test_case parallel_report
+parallel_report_head()
+{
+    atf_set "descr" "Tests that -j adds a record per test case to the" \
+                    "report and that atf-junit converts it to JUnit XML"
+}
+parallel_report_body()
+{
+    for h in $(get_helpers c_helpers); do
+        export ATF_REPORT_FILE="$(pwd)/report"
+        export ATF_RESULTS_FORMAT=extended
+
+        rm -f report junit.xml
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r resfile -j 2 result_pass result_fail expect_exit_code_and_exit
+        atf_check -o inline:"3\n" grep -c . resfile
+        atf_check -o not-match:"time\." cat resfile
+        atf_check -o inline:"3\n" grep -c . report
+        atf_check -o match:'"result_pass", "result": "passed", "time\.init\.' \
+            -o match:'"result_fail", "result": "failed", "reason": "Failure' \
+            -o match:'"result": "expected_exit", "arg": 123,' \
+            -o match:'"rusage\.self\.maxrss": [0-9]+' cat report
+
+        test ! -f junit.xml || atf_fail "JUnit file written by the run"
+        atf_check -s exit:0 -o empty -e empty atf-junit report junit.xml
+        atf_check -o match:'<testsuite name="atf" tests="3" failures="1"' \
+            -o match:'<testcase classname="c_helpers" name="result_pass"' \
+            -o match:'<failure message="Failure reason"/>' cat junit.xml
+    done
+}
+
+atf_test_case sequential_results
+sequential_results_head()
+{
+    atf_set "descr" "Tests that several test cases can be run in a single" \
+                    "invocation, each writing to its own results file"
+}
+sequential_results_body()
+{
+    for h in $(get_helpers); do
+        rm -rf results; mkdir results
+        atf_check -s eq:1 -o match:"msg" -e ignore "${h}" \
+            -s "$(atf_get_srcdir)" -r results/%s.out \
+            result_pass result_fail result_skip
+        atf_check -o inline:"passed\n" cat results/result_pass.out
+        atf_check -o inline:"failed: Failure reason\n" \
+            cat results/result_fail.out
+        atf_check -o inline:"skipped: Skipped reason\n" \
+            cat results/result_skip.out
+
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r results/%s.out result_pass result_skip:body
+    done
+}
+
+atf_test_case sequential_cleanup
+sequential_cleanup_head()
+{
+    atf_set "descr" "Tests that test case parts can be selected when" \
+                    "running several test cases in a single invocation"
+}
+sequential_cleanup_body()
+{
+    for h in $(get_helpers c_helpers sh_helpers); do
+        rm -rf results; mkdir results
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r results/%s -v tmpfile="$(pwd)/tmpfile" -v cleanup=yes \
+            cleanup_pass cleanup_pass:cleanup result_pass
+        test ! -f tmpfile || atf_fail "Cleanup routine not executed"
+        atf_check -o inline:"passed\n" cat results/cleanup_pass
+        atf_check -o inline:"passed\n" cat results/result_pass
+    done
+}
+
+atf_test_case sequential_report
+sequential_report_head()
+{
+    atf_set "descr" "Tests that running several test cases appends a" \
+                    "record per test case to the report"
+}
+sequential_report_body()
+{
+    export ATF_REPORT_FILE="$(pwd)/report"
+    for h in $(get_helpers); do
+        rm -rf results; mkdir results
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r results/%s result_pass result_fail result_skip
+    done
+
+    atf_check -o inline:"9\n" grep -c . report
+    for h in c_helpers cpp_helpers sh_helpers; do
+        tc='^[{]"program": "'${h}'", "ident": '
+        atf_check -o match:"${tc}\"result_pass\", \"result\": \"passed\"[}]$" \
+            -o match:"${tc}\"result_fail\", \"result\": \"failed\", " \
+            -o match:"\"reason\": \"Failure reason\"[}]$" \
+            -o match:"${tc}\"result_skip\", \"result\": \"skipped\", " \
+            cat report
+    done
+
+    atf_check -s eq:0 -o ignore -e ignore "$(atf_get_srcdir)/c_helpers" \
+        -s "$(atf_get_srcdir)" -r results/%s result_pass result_skip
+    atf_check -s exit:0 -o empty -e empty atf-junit report junit.xml
+    atf_check -o match:'tests="11" failures="3" errors="0" skipped="4"' \
+        cat junit.xml
+}
+
+atf_test_case report_escapes
+report_escapes_head()
+{
+    atf_set "descr" "Tests that the C and sh libraries escape the control" \
+                    "characters of the records in the same way"
+}
+report_escapes_body()
+{
+    export ATF_REPORT_FILE="$(pwd)/report"
+    for h in $(get_helpers c_helpers sh_helpers); do
+        rm -rf results; mkdir results
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -r results/%s report_controls result_pass
+    done
+
+    reason='"reason": "Tab\\there, CR\\u000dhere, bell\\u0007end"}$'
+    atf_check -o inline:"2\n" grep -c "${reason}" report
+}
+
+atf_test_case sequential_errors
+sequential_errors_head()
+{
+    atf_set "descr" "Tests that invalid uses of multiple test case names" \
+                    "are reported before running any of them"
+}
+sequential_errors_body()
+{
+    for h in $(get_helpers); do
+        atf_check -s eq:1 -e match:"ERROR.*results file template" \
+            "${h}" -s "$(atf_get_srcdir)" -r resfile result_pass result_fail
+        atf_check -s eq:1 -e match:"ERROR.*Unknown test case .foo'" \
+            "${h}" -s "$(atf_get_srcdir)" -r %s result_pass foo
+        test ! -f result_pass || atf_fail "Test case run despite errors"
+    done
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case parallel_results
+    atf_add_test_case parallel_cleanup
+    atf_add_test_case parallel_expect
+    atf_add_test_case parallel_history
+    atf_add_test_case parallel_errors
+    atf_add_test_case parallel_report
+    atf_add_test_case parallel_reruns
+    atf_add_test_case sequential_results
+    atf_add_test_case sequential_cleanup
+    atf_add_test_case sequential_report
+    atf_add_test_case report_escapes
+    atf_add_test_case sequential_errors
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
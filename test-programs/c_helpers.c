@@ -447,6 +447,46 @@ ATF_TC_BODY(result_newlines_skip, tc)
     atf_tc_skip("First line\nSecond line");
 }
 
+ATF_TC_WITHOUT_HEAD(report_controls);
+ATF_TC_BODY(report_controls, tc)
+{
+    atf_tc_fail("Tab\there, CR\rhere, bell\aend");
+}
+
+/* ---------------------------------------------------------------------
+ * Helper tests for "t_timeout".
+ * --------------------------------------------------------------------- */
+
+ATF_TC(timeout_hang);
+ATF_TC_HEAD(timeout_hang, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Helper test case for the t_timeout test "
+                      "program");
+    atf_tc_set_md_var(tc, "timeout", "1");
+}
+ATF_TC_BODY(timeout_hang, tc)
+{
+    /* Leave a subprocess behind holding our output open. */
+    if (system("sleep 30 &") == -1)
+        atf_tc_fail("Cannot spawn subprocess");
+    sleep(30);
+}
+
+ATF_TC_WITH_CLEANUP(timeout_cleanup_hang);
+ATF_TC_HEAD(timeout_cleanup_hang, tc)
+{
+    atf_tc_set_md_var(tc, "descr", "Helper test case for the t_timeout test "
+                      "program");
+    atf_tc_set_md_var(tc, "timeout", "1");
+}
+ATF_TC_BODY(timeout_cleanup_hang, tc)
+{
+}
+ATF_TC_CLEANUP(timeout_cleanup_hang, tc)
+{
+    sleep(30);
+}
+
 /* ---------------------------------------------------------------------
  * Main.
  * --------------------------------------------------------------------- */
@@ -498,6 +538,11 @@ ATF_TP_ADD_TCS(tp)
     ATF_TP_ADD_TC(tp, result_skip);
     ATF_TP_ADD_TC(tp, result_newlines_fail);
     ATF_TP_ADD_TC(tp, result_newlines_skip);
+    ATF_TP_ADD_TC(tp, report_controls);
+
+    /* Add helper tests for t_timeout. */
+    ATF_TP_ADD_TC(tp, timeout_hang);
+    ATF_TP_ADD_TC(tp, timeout_cleanup_hang);
 
     return atf_no_error();
 }
@@ -36,4 +36,10 @@ get_helpers()
     done
 }
 
+# Prints the sorted names of the test cases listed by a helper.
+list_idents()
+{
+    "${@}" | sed -n 's/^ident: //p' | sort
+}
+
 # vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -307,6 +307,24 @@ ATF_TEST_CASE_BODY(result_exception)
     throw std::runtime_error("This is unhandled");
 }
 
+// ------------------------------------------------------------------------
+// Helper tests for "t_timeout".
+// ------------------------------------------------------------------------
+
+ATF_TEST_CASE(timeout_hang);
+ATF_TEST_CASE_HEAD(timeout_hang)
+{
+    set_md_var("descr", "Helper test case for the t_timeout test program");
+    set_md_var("timeout", "1");
+}
+ATF_TEST_CASE_BODY(timeout_hang)
+{
+    // Leave a subprocess behind holding our output open.
+    if (std::system("sleep 30 &") == -1)
+        ATF_FAIL("Cannot spawn subprocess");
+    ::sleep(30);
+}
+
 // ------------------------------------------------------------------------
 // Main.
 // ------------------------------------------------------------------------
@@ -352,4 +370,7 @@ ATF_INIT_TEST_CASES(tcs)
     ATF_ADD_TEST_CASE(tcs, result_newlines_fail);
     ATF_ADD_TEST_CASE(tcs, result_newlines_skip);
     ATF_ADD_TEST_CASE(tcs, result_exception);
+
+    // Add helper tests for t_timeout.
+    ATF_ADD_TEST_CASE(tcs, timeout_hang);
 }
@@ -0,0 +1,142 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Copies a helper to the work directory so that its list can be stored
+# along it, and prints the path to the copy.
+copy_helper()
+{
+    cp "${1}" . || atf_fail "Cannot copy ${1}"
+    echo "./$(basename "${1}")"
+}
+
+atf_test_case write_read
+write_read_head()
+{
+    atf_set "descr" "Tests that atf-list -w stores the list of a test" \
+                    "program and that atf-list returns it without running" \
+                    "the program"
+    atf_set "require.progs" "objcopy"
+}
+write_read_body()
+{
+    for h in $(get_helpers); do
+        p=$(copy_helper "${h}")
+        atf_check -s exit:0 -o save:expout "${p}" -l
+
+        atf_check -s exit:0 -o empty -e empty atf-list -w "${p}"
+        atf_check -s exit:0 -o file:expout "${p}" -l
+
+        # The list must be available even if the program cannot be run.
+        chmod 444 "${p}"
+        atf_check -s exit:0 -o file:expout -e empty atf-list -n "${p}"
+        atf_check -s exit:0 -o file:expout -e empty atf-list "${p}"
+    done
+    test -f sh_helpers.tcs || atf_fail "The list of sh_helpers was not" \
+        "stored in a sidecar file"
+    test ! -f c_helpers.tcs || atf_fail "The list of c_helpers was" \
+        "stored in a sidecar file instead of the binary"
+}
+
+atf_test_case fallback
+fallback_head()
+{
+    atf_set "descr" "Tests that atf-list runs the programs that carry no" \
+                    "precomputed list unless -n is given"
+}
+fallback_body()
+{
+    for h in $(get_helpers); do
+        p=$(copy_helper "${h}")
+        atf_check -s exit:0 -o save:expout "${p}" -l
+        atf_check -s exit:0 -o file:expout -e empty atf-list "${p}"
+        atf_check -s exit:1 -o empty \
+            -e match:"ERROR: ${p}: No precomputed test case list" \
+            atf-list -n "${p}"
+    done
+}
+
+atf_test_case stale_sidecar
+stale_sidecar_head()
+{
+    atf_set "descr" "Tests that a sidecar file older than its program is" \
+                    "ignored"
+}
+stale_sidecar_body()
+{
+    p=$(copy_helper "$(get_helpers sh_helpers)")
+    atf_check -s exit:0 -o empty -e empty atf-list -w "${p}"
+    atf_check -s exit:0 -o ignore -e empty atf-list -n "${p}"
+
+    touch -t 203001010000 "${p}"
+    atf_check -s exit:1 -o empty -e match:"No precomputed" atf-list -n "${p}"
+}
+
+atf_test_case many
+many_head()
+{
+    atf_set "descr" "Tests that atf-list labels the lists of several" \
+                    "programs"
+}
+many_body()
+{
+    for h in $(get_helpers c_helpers sh_helpers); do
+        p=$(copy_helper "${h}")
+        echo "program: ${p}" >>expout
+        "${p}" -l >>expout
+    done
+    atf_check -s exit:0 -o file:expout -e empty \
+        atf-list ./c_helpers ./sh_helpers
+}
+
+atf_test_case errors
+errors_head()
+{
+    atf_set "descr" "Tests the errors reported by atf-list"
+}
+errors_body()
+{
+    atf_check -s exit:1 -o empty -e match:"Usage" atf-list
+    atf_check -s exit:1 -o empty -e match:"Usage" atf-list -n -w foo
+    atf_check -s exit:1 -o empty -e match:"ERROR: missing: Cannot open" \
+        atf-list missing
+
+    echo "#! /bin/sh" >fail
+    echo "exit 1" >>fail
+    chmod +x fail
+    atf_check -s exit:1 -o empty \
+        -e match:"ERROR: fail: Cannot list the test cases" atf-list -w fail
+    test ! -f fail.tcs || atf_fail "A list was stored for a failing program"
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case write_read
+    atf_add_test_case fallback
+    atf_add_test_case stale_sidecar
+    atf_add_test_case many
+    atf_add_test_case errors
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -0,0 +1,146 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+atf_test_case list_glob
+list_glob_head()
+{
+    atf_set "descr" "Tests that -F selects the test cases to list by glob"
+}
+list_glob_body()
+{
+    for h in $(get_helpers); do
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F 'config_*' >out
+        cat >expout <<EOT
+config_empty
+config_multi_value
+config_unset
+config_value
+EOT
+        atf_check -o file:expout cat out
+
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F 'result_*' \
+            -F '!*_newlines_*' -F '!*_exception' >out
+        atf_check -o inline:"result_fail\nresult_pass\nresult_skip\n" cat out
+    done
+}
+
+atf_test_case list_regex
+list_regex_head()
+{
+    atf_set "descr" "Tests that -F selects the test cases to list by" \
+                    "regular expression"
+}
+list_regex_body()
+{
+    for h in $(get_helpers); do
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l \
+            -F '/^result_(pass|skip)$/' >out
+        atf_check -o inline:"result_pass\nresult_skip\n" cat out
+
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F '/^config_/' \
+            -F '!/value$/' >out
+        atf_check -o inline:"config_empty\nconfig_unset\n" cat out
+    done
+}
+
+atf_test_case list_property
+list_property_head()
+{
+    atf_set "descr" "Tests that -F selects the test cases to list by" \
+                    "meta-data property"
+}
+list_property_body()
+{
+    for h in $(get_helpers); do
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F 'expect_*' \
+            -F timeout=1 >out
+        atf_check \
+            -o inline:"expect_timeout_and_hang\nexpect_timeout_but_pass\n" \
+            cat out
+
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F 'expect_*' \
+            -F '!timeout=1' >out
+        atf_check -o match:"^expect_pass_and_pass\$" \
+            -o not-match:"expect_timeout" cat out
+
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -F 'X-undefined=*' >out
+        atf_check -o empty cat out
+    done
+}
+
+atf_test_case batch
+batch_head()
+{
+    atf_set "descr" "Tests that -F filters the test cases run in a batch"
+}
+batch_body()
+{
+    for h in $(get_helpers); do
+        mkdir results
+        atf_check -s ignore -o ignore -e ignore "${h}" \
+            -s "$(atf_get_srcdir)" -r results/%s -F '!*_fail' \
+            result_pass result_fail result_skip
+        atf_check -o inline:"result_pass\nresult_skip\n" ls results
+        rm -rf results
+
+        mkdir results
+        atf_check -s eq:0 -o ignore -e ignore "${h}" \
+            -s "$(atf_get_srcdir)" -r results/%s -F result_pass result_pass
+        atf_check -o inline:"result_pass\n" ls results
+        rm -rf results
+    done
+}
+
+atf_test_case errors
+errors_head()
+{
+    atf_set "descr" "Tests that invalid uses of -F are rejected"
+}
+errors_body()
+{
+    for h in $(get_helpers); do
+        atf_check -s eq:1 -e match:"ERROR.*Empty filter" "${h}" \
+            -s "$(atf_get_srcdir)" -l -F ''
+        atf_check -s eq:1 -e match:"ERROR.*Empty filter" "${h}" \
+            -s "$(atf_get_srcdir)" -l -F '!'
+        atf_check -s eq:1 -e match:"ERROR.*Invalid regular expression" \
+            "${h}" -s "$(atf_get_srcdir)" -l -F '/(/'
+        atf_check -s eq:1 -e match:"ERROR.*Missing property name" "${h}" \
+            -s "$(atf_get_srcdir)" -l -F '=foo'
+        atf_check -s eq:1 -e match:"ERROR.*results file template" \
+            "${h}" -s "$(atf_get_srcdir)" -F 'result_*' result_pass
+    done
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case list_glob
+    atf_add_test_case list_regex
+    atf_add_test_case list_property
+    atf_add_test_case batch
+    atf_add_test_case errors
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
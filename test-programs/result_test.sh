@@ -123,6 +123,69 @@ result_exception_body()
     done
 }
 
+atf_test_case result_extended
+result_extended_head()
+{
+    atf_set "descr" "Tests that the extended results format follows the" \
+                    "result with the timings of the test case phases and" \
+                    "its resource usage"
+}
+result_extended_body()
+{
+    export ATF_RESULTS_FORMAT=extended
+    srcdir="$(atf_get_srcdir)"
+    for h in $(get_helpers); do
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "${srcdir}" \
+            -r resfile result_fail
+        atf_check -o inline:"failed: Failure reason\n" head -n 1 resfile
+        atf_check -o match:"^time\.init\.start: [0-9]+\.[0-9]{6}$" \
+            -o match:"^time\.init\.duration: [0-9]+\.[0-9]{6}$" \
+            -o match:"^time\.body\.start: [0-9]+\.[0-9]{6}$" \
+            -o match:"^time\.body\.duration: [0-9]+\.[0-9]{6}$" \
+            -o not-match:"^time\.cleanup" cat resfile
+        atf_check -o match:"^rusage\.self\.utime: [0-9]+\.[0-9]{6}$" \
+            -o match:"^rusage\.self\.maxrss: [0-9]+$" \
+            -o match:"^rusage\.self\.minflt: [0-9]+$" \
+            -o match:"^rusage\.children\.stime: [0-9]+\.[0-9]{6}$" \
+            cat resfile
+
+        atf_check -s eq:0 -o match:"^passed$" -o match:"^time\.body\." \
+            -e ignore "${h}" -s "${srcdir}" result_pass
+    done
+
+    unset ATF_RESULTS_FORMAT
+    for h in $(get_helpers); do
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "${srcdir}" \
+            -r resfile result_pass
+        atf_check -o inline:"passed\n" cat resfile
+    done
+}
+
+atf_test_case result_extended_cleanup
+result_extended_cleanup_head()
+{
+    atf_set "descr" "Tests that the cleanup routine appends its timing to" \
+                    "the results file in the extended format"
+}
+result_extended_cleanup_body()
+{
+    export ATF_RESULTS_FORMAT=extended
+    srcdir="$(atf_get_srcdir)"
+    for h in $(get_helpers c_helpers sh_helpers); do
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "${srcdir}" \
+            -r resfile -v tmpfile="$(pwd)/tmpfile" cleanup_pass
+        atf_check -s eq:0 -o ignore -e ignore "${h}" -s "${srcdir}" \
+            -r resfile -v tmpfile="$(pwd)/tmpfile" -v cleanup=yes \
+            cleanup_pass:cleanup
+        atf_check -o inline:"passed\n" head -n 1 resfile
+        atf_check -o match:"^time\.body\.duration: " \
+            -o match:"^time\.cleanup\.start: [0-9]+\.[0-9]{6}$" \
+            -o match:"^time\.cleanup\.duration: [0-9]+\.[0-9]{6}$" \
+            cat resfile
+        test ! -f tmpfile || atf_fail "Cleanup routine not executed"
+    done
+}
+
 atf_init_test_cases()
 {
     atf_add_test_case runtime_warnings
@@ -130,6 +193,8 @@ atf_init_test_cases()
     atf_add_test_case result_to_file
     atf_add_test_case result_to_file_fail
     atf_add_test_case result_exception
+    atf_add_test_case result_extended
+    atf_add_test_case result_extended_cleanup
 }
 
 # vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -336,6 +336,12 @@ result_skip_body()
     atf_skip "Skipped reason"
 }
 
+atf_test_case report_controls
+report_controls_body()
+{
+    atf_fail "$(printf 'Tab\there, CR\rhere, bell\007end')"
+}
+
 # -------------------------------------------------------------------------
 # Main.
 # -------------------------------------------------------------------------
@@ -385,6 +391,7 @@ atf_init_test_cases()
     atf_add_test_case result_pass
     atf_add_test_case result_fail
     atf_add_test_case result_skip
+    atf_add_test_case report_controls
 }
 
 # vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -0,0 +1,147 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+atf_test_case list_partition
+list_partition_head()
+{
+    atf_set "descr" "Tests that the shards selected with -S partition the" \
+                    "test cases of a program"
+}
+list_partition_body()
+{
+    for h in $(get_helpers); do
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l >all
+        for i in 0 1 2; do
+            list_idents "${h}" -s "$(atf_get_srcdir)" -l -S ${i}/3 >shard${i}
+            test -s shard${i} || atf_fail "Shard ${i} of ${h} is empty"
+        done
+        sort shard0 shard1 shard2 >union
+        atf_check -o file:all cat union
+
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -S 0/1 >single
+        atf_check -o file:all cat single
+    done
+}
+
+atf_test_case consistent
+consistent_head()
+{
+    atf_set "descr" "Tests that all language bindings assign a test case" \
+                    "to the same shard"
+}
+consistent_body()
+{
+    for h in $(get_helpers); do
+        name=$(basename "${h}")
+        for i in 0 1 2 3 4; do
+            list_idents "${h}" -s "$(atf_get_srcdir)" -l -S ${i}/5 \
+                | sed -e "s/\$/ ${i}/"
+        done | sort >${name}.shards
+    done
+
+    # Only compare the test cases that exist in all helpers.
+    join c_helpers.shards cpp_helpers.shards >c_cpp
+    join c_cpp sh_helpers.shards >all
+    test -s all || atf_fail "No test cases in common among the helpers"
+    atf_check -o empty awk '$2 != $3 || $3 != $4' all
+}
+
+atf_test_case leading_zeros
+leading_zeros_head()
+{
+    atf_set "descr" "Tests that all language bindings read shard numbers" \
+                    "with leading zeros as decimal"
+}
+leading_zeros_body()
+{
+    for h in $(get_helpers); do
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -S 9/10 >expout
+        test -s expout || atf_fail "Shard 9 of ${h} is empty"
+        list_idents "${h}" -s "$(atf_get_srcdir)" -l -S 09/010 >out
+        atf_check -o file:expout cat out
+    done
+}
+
+atf_test_case batch
+batch_head()
+{
+    atf_set "descr" "Tests that -S filters the test cases run in a batch"
+}
+batch_body()
+{
+    for h in $(get_helpers); do
+        for i in 0 1; do
+            mkdir shard${i}
+            atf_check -s ignore -o ignore -e ignore "${h}" \
+                -s "$(atf_get_srcdir)" -r shard${i}/%s -S ${i}/2 \
+                result_pass result_fail result_skip
+        done
+        atf_check -o inline:"result_fail\nresult_pass\nresult_skip\n" \
+            -x "ls shard0 shard1 | grep ^result | sort"
+        for f in result_pass result_fail result_skip; do
+            if [ -f shard0/${f} -a -f shard1/${f} ]; then
+                atf_fail "${f} was run in both shards"
+            fi
+        done
+        rm -rf shard0 shard1
+    done
+
+    for h in $(get_helpers c_helpers); do
+        for i in 0 1; do
+            atf_check -s ignore -o save:stdout${i} -e ignore "${h}" \
+                -s "$(atf_get_srcdir)" -r /dev/stdout -j 2 -S ${i}/2 \
+                result_pass result_fail result_skip
+        done
+        atf_check -o inline:"3\n" -x "cat stdout0 stdout1 | grep -c ': '"
+    done
+}
+
+atf_test_case errors
+errors_head()
+{
+    atf_set "descr" "Tests that invalid uses of -S are rejected"
+}
+errors_body()
+{
+    for h in $(get_helpers); do
+        for spec in 1 2/2 1/0 a/b /2 1/ 1/2/3; do
+            atf_check -s eq:1 -e match:"ERROR.*-S requires" "${h}" \
+                -s "$(atf_get_srcdir)" -l -S ${spec}
+        done
+        atf_check -s eq:1 -e match:"ERROR.*results file template" \
+            "${h}" -s "$(atf_get_srcdir)" -S 0/2 result_pass
+    done
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case list_partition
+    atf_add_test_case consistent
+    atf_add_test_case leading_zeros
+    atf_add_test_case batch
+    atf_add_test_case errors
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -0,0 +1,109 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+atf_test_case hang
+hang_head()
+{
+    atf_set "descr" "Tests that -T kills test cases that exceed their" \
+                    "timeout, including their subprocesses"
+    atf_set "timeout" "60"
+}
+hang_body()
+{
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        atf_check -s eq:1 -o empty -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -T -r resfile timeout_hang
+        atf_check -o inline:"failed: Test case timed out after 1 seconds\n" \
+            cat resfile
+    done
+}
+
+atf_test_case expected
+expected_head()
+{
+    atf_set "descr" "Tests that -T reports timeouts of test cases that" \
+                    "expect them as such"
+    atf_set "timeout" "60"
+}
+expected_body()
+{
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        atf_check -s eq:0 -o empty -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -T -r resfile expect_timeout_and_hang
+        atf_check -o inline:"expected_timeout: Will overrun\n" cat resfile
+
+        atf_check -s eq:0 -o match:"msg" -e ignore "${h}" \
+            -s "$(atf_get_srcdir)" -T -r resfile result_pass
+        atf_check -o inline:"passed\n" cat resfile
+    done
+}
+
+atf_test_case batch
+batch_head()
+{
+    atf_set "descr" "Tests that -T applies to each test case when running" \
+                    "several of them"
+    atf_set "timeout" "60"
+}
+batch_body()
+{
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        atf_check -s eq:1 -o ignore -e ignore "${h}" -s "$(atf_get_srcdir)" \
+            -T -r %s timeout_hang result_pass
+        atf_check -o match:"timed out" cat timeout_hang
+        atf_check -o inline:"passed\n" cat result_pass
+    done
+
+    atf_check -s eq:1 -o ignore -e ignore "$(atf_get_srcdir)/c_helpers" \
+        -s "$(atf_get_srcdir)" -T -j 2 -r resfile timeout_hang \
+        expect_timeout_and_hang
+    atf_check -o match:"^timeout_hang: failed: Test case timed out" \
+        -o match:"^expect_timeout_and_hang: expected_timeout" cat resfile
+}
+
+atf_test_case cleanup
+cleanup_head()
+{
+    atf_set "descr" "Tests that -T also kills cleanup routines that exceed" \
+                    "the timeout of their test case"
+    atf_set "timeout" "60"
+}
+cleanup_body()
+{
+    atf_check -s eq:1 -o ignore -e ignore "$(atf_get_srcdir)/c_helpers" \
+        -s "$(atf_get_srcdir)" -T -j 2 -r resfile timeout_cleanup_hang
+    atf_check -o match:"^timeout_cleanup_hang: broken: Test case cleanup" \
+        -o match:"timed out after 1 seconds$" cat resfile
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case hang
+    atf_add_test_case expected
+    atf_add_test_case batch
+    atf_add_test_case cleanup
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4
@@ -0,0 +1,132 @@
+/* Copyright (c) 2026 The NetBSD Foundation, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+ * CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  */
+
+/*
+ * Minimal client for the zygote mode of test programs (see the -z flag in
+ * atf-test-program(1)).  Connects to the Unix socket given as its only
+ * argument, sends each request read from stdin and prints the replies to
+ * stdout.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static
+int
+connect_to(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd, tries;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "zygote_client: Socket path too long\n");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        fprintf(stderr, "zygote_client: socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    /* The server may still be starting up; give it some time. */
+    for (tries = 0; connect(fd, (struct sockaddr *)&addr,
+                            sizeof(addr)) == -1; tries++) {
+        if ((errno != ENOENT && errno != ECONNREFUSED) || tries == 100) {
+            fprintf(stderr, "zygote_client: Cannot connect to %s: %s\n",
+                    path, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        usleep(100000);
+    }
+
+    return fd;
+}
+
+int
+main(int argc, char **argv)
+{
+    FILE *in, *out;
+    char *line, *reply;
+    size_t linesize, replysize;
+    ssize_t len;
+    int fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: zygote_client socket < requests\n");
+        return EXIT_FAILURE;
+    }
+
+    fd = connect_to(argv[1]);
+    if (fd == -1)
+        return EXIT_FAILURE;
+    in = fdopen(fd, "r");
+    out = fdopen(dup(fd), "w");
+    if (in == NULL || out == NULL) {
+        fprintf(stderr, "zygote_client: fdopen: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    line = NULL;
+    linesize = 0;
+    reply = NULL;
+    replysize = 0;
+    while ((len = getline(&line, &linesize, stdin)) != -1) {
+        if (len > 0 && line[len - 1] == '\n')
+            line[--len] = '\0';
+        if (len == 0)
+            continue;
+
+        fprintf(out, "%s\n", line);
+        fflush(out);
+        if (strcmp(line, "quit") == 0)
+            break;
+
+        if (getline(&reply, &replysize, in) == -1) {
+            fprintf(stderr, "zygote_client: Connection closed by server\n");
+            break;
+        }
+        printf("%s", reply);
+        fflush(stdout);
+    }
+
+    free(reply);
+    free(line);
+    fclose(out);
+    fclose(in);
+    return EXIT_SUCCESS;
+}
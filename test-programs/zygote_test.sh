@@ -0,0 +1,131 @@
+# Copyright (c) 2026 The NetBSD Foundation, Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND
+# CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES,
+# INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+# IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+atf_test_case pipe
+pipe_head()
+{
+    atf_set "descr" "Tests that -z - serves requests read from stdin and" \
+                    "sends the replies to stdout"
+}
+pipe_body()
+{
+    cat >requests <<EOF2
+run result_pass r1
+run result_fail:body r2
+run unknown r3
+
+run result_pass r4
+quit
+run result_pass r5
+EOF2
+    cat >expout <<EOF2
+exit 0
+exit 1
+error Unknown test case \`unknown'
+exit 0
+EOF2
+
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        rm -f r1 r2 r3 r4 r5
+        atf_check -s eq:0 -o file:expout -e match:"msg" \
+            "${h}" -s "$(atf_get_srcdir)" -z - <requests
+        atf_check -o inline:"passed\n" cat r1
+        atf_check -o inline:"failed: Failure reason\n" cat r2
+        atf_check -o inline:"passed\n" cat r4
+        test ! -f r3 || atf_fail "Unknown test case produced a result"
+        test ! -f r5 || atf_fail "Request after quit was served"
+    done
+}
+
+atf_test_case socket
+socket_head()
+{
+    atf_set "descr" "Tests that -z serves requests sent to a Unix socket" \
+                    "over consecutive connections"
+    atf_set "timeout" "60"
+}
+socket_body()
+{
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        rm -f r1 r2
+        "${h}" -s "$(atf_get_srcdir)" -z "$(pwd)/sock" >server.out 2>&1 &
+        pid=${!}
+
+        echo "run result_pass r1" | atf_check -s eq:0 -o inline:"exit 0\n" \
+            "$(atf_get_srcdir)/zygote_client" "$(pwd)/sock"
+        printf "run result_skip r2\nquit\n" | atf_check -s eq:0 \
+            -o inline:"exit 0\n" \
+            "$(atf_get_srcdir)/zygote_client" "$(pwd)/sock"
+
+        wait ${pid} || atf_fail "Server exited with an error"
+        atf_check -o inline:"passed\n" cat r1
+        atf_check -o inline:"skipped: Skipped reason\n" cat r2
+        test ! -e sock || atf_fail "Socket not removed on exit"
+    done
+}
+
+atf_test_case cleanup
+cleanup_head()
+{
+    atf_set "descr" "Tests that -z runs cleanup routines on request"
+}
+cleanup_body()
+{
+    for h in $(get_helpers c_helpers); do
+        printf "run cleanup_pass r1\nrun cleanup_pass:cleanup\n" | atf_check \
+            -s eq:0 -o inline:"exit 0\nexit 0\n" -e ignore \
+            "${h}" -s "$(atf_get_srcdir)" -v tmpfile="$(pwd)/tmpfile" \
+            -v cleanup=true -z -
+        atf_check -o inline:"passed\n" cat r1
+        test ! -f tmpfile || atf_fail "Cleanup routine not executed"
+    done
+}
+
+atf_test_case errors
+errors_head()
+{
+    atf_set "descr" "Tests that invalid uses of -z are reported"
+}
+errors_body()
+{
+    for h in $(get_helpers c_helpers cpp_helpers); do
+        atf_check -s eq:1 -e match:"ERROR.*Cannot use -z with" \
+            "${h}" -s "$(atf_get_srcdir)" -z - -l
+        atf_check -s eq:1 -e match:"ERROR.*Cannot use -z with" \
+            "${h}" -s "$(atf_get_srcdir)" -z - -T
+        atf_check -s eq:1 -e match:"ERROR.*test case names with -z" \
+            "${h}" -s "$(atf_get_srcdir)" -z - result_pass
+    done
+}
+
+atf_init_test_cases()
+{
+    atf_add_test_case pipe
+    atf_add_test_case socket
+    atf_add_test_case cleanup
+    atf_add_test_case errors
+}
+
+# vim: syntax=sh:expandtab:shiftwidth=4:softtabstop=4